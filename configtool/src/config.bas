@@ -56,7 +56,14 @@ saveOptions: PROCEDURE
         VDP_CONFIG(CONF_SAVE_TO_FLASH) = 1
     END IF
 
-    clockChanged = savedConfigValues(CONF_CLOCK_PRESET_ID) <> tempConfigValues(CONF_CLOCK_PRESET_ID)
+    ' the firmware switches the display live (then asks for confirmation)
+    ' if the new settings run at the same system clock. the rest, and the
+    ' vdp rate, need a reboot
+    displayChanged = savedConfigValues(CONF_CLOCK_PRESET_ID) <> tempConfigValues(CONF_CLOCK_PRESET_ID)
+    IF savedConfigValues(CONF_DISP_DRIVER_PREF) <> tempConfigValues(CONF_DISP_DRIVER_PREF) THEN displayChanged = TRUE
+    IF savedConfigValues(CONF_VGA_MODE) <> tempConfigValues(CONF_VGA_MODE) THEN displayChanged = TRUE
+    IF savedConfigValues(CONF_SCART_MODE) <> tempConfigValues(CONF_SCART_MODE) THEN displayChanged = TRUE
+    rebootRequired = savedConfigValues(CONF_VDP_RATE) <> tempConfigValues(CONF_VDP_RATE)
 
     ' update device values again
     FOR I = 0 TO CONF_COUNT - 1
@@ -47,15 +47,19 @@ CONST CONF_SW_VERSION       = 2
 CONST CONF_SW_PATCH_VERSION = 3
 CONST CONF_CLOCK_TESTED     = 4
 CONST CONF_DISP_DRIVER      = 5
+CONST CONF_CAPABILITIES     = 7         ' CONF_CAP_* flags: the options the firmware acts on
 ' ^^^ read only
 
+CONST CONF_CAP_VDP_RATE     = $01       ' CONF_VDP_RATE (PICO9918 PRO frame buffer builds)
+
 ' now the read/write ones
 CONST CONF_CRT_SCANLINES    = 8         ' 0 (off) or 1 (on)
 CONST CONF_SCANLINE_SPRITES = 9         ' 0 - 3 where value = (1 << (x + 2))
 CONST CONF_CLOCK_PRESET_ID  = 10        ' 0 - 2 see ClockSettings in main.c
-CONST CONF_SCART_MODE       = 11        ' 0 = PAL 576i, 1 = NTSC 480i
+CONST CONF_SCART_MODE       = 11        ' 0 = PAL 576i, 1 = NTSC 480i, 2 = PAL 288p, 3 = NTSC 240p
 CONST CONF_DISP_DRIVER_PREF = 13        ' 0 = AUTO, 1 = force VGA, 2 = force SCART
-CONST CONF_VGA_MODE         = 14        ' 0 = 480p60 (extensible)
+CONST CONF_VGA_MODE         = 14        ' 0 = 480p60, 1 = 400p70, 2 = 768p60, 3 = 1024p60, 4 = 576p50
+CONST CONF_VDP_RATE         = 15        ' 0 = follow display, 1 = 50 Hz, 2 = 60 Hz
 CONST CONF_DIAG             = 16
 CONST CONF_DIAG_REGISTERS   = 17
 CONST CONF_DIAG_PERFORMANCE = 18
@@ -128,6 +132,7 @@ main: PROCEDURE
     g_paletteDirty = FALSE
     g_diagDirty = FALSE
     g_outputDirty = FALSE
+    g_picoCaps = 0                          ' CONF_CAPABILITIES (older firmware: none)
     g_resetPending = FALSE
 
     ' setup the screen
@@ -162,6 +167,8 @@ main: PROCEDURE
             verPatch = VDP_STATUS
             VDP_REG(58) = CONF_PICO_MODEL
             picoModel = VDP_STATUS
+            VDP_REG(58) = CONF_CAPABILITIES
+            g_picoCaps = VDP_STATUS
             VDP_REG(58) = CONF_HW_VERSION
             optValue = VDP_STATUS
             hwMajor = optValue / 16
@@ -5,7 +5,8 @@
 '
 ' Startup gates: checkFirmwareVersion (forced upgrade if device firmware is
 ' too old) and checkPendingDisplayChange (prompt user to confirm or revert
-' an ARMED display change).
+' an ARMED display change). awaitDisplaySwitch runs the same prompt after a
+' save, once the firmware has switched to the new display mode.
 '
 
 ' Halt or force-update if device firmware is older than the embedded firmware.
@@ -67,3 +68,30 @@ checkPendingDisplayChange: PROCEDURE
     END IF
 
     END
+
+
+' The firmware arms a saved display change and switches to it live. Wait for
+' that (two flash writes and a frame), then confirm as at startup. A change
+' that needs another system clock stays pending until a power cycle.
+awaitDisplaySwitch: PROCEDURE
+    IF NOT displayChanged THEN RETURN
+
+    FOR I = 1 TO 120
+        WAIT
+        VDP_DISABLE_INT
+        VDP_STATUS_REG = 12
+        VDP_REG(58) = CONF_PENDING_STATE
+        pendingState = VDP_STATUS
+        VDP_STATUS_REG0
+        VDP_ENABLE_INT
+        IF pendingState = PENDING_STATE_ARMED THEN EXIT FOR
+    NEXT I
+
+    IF pendingState <> PENDING_STATE_ARMED THEN
+        PRINT AT XY(0, MENU_HELP_ROW), " Success! ** Reboot required ** "
+        RETURN
+    END IF
+
+    GOSUB checkPendingDisplayChange
+    GOSUB renderMainMenu
+    END
@@ -17,7 +17,7 @@ CONST MENU_COUNT_POPUP      = 2
 CONST MENU_COUNT_INFO       = 1
 CONST MENU_COUNT_DIAG       = 5
 CONST MENU_COUNT_PALETTE    = 2
-CONST MENU_COUNT_OUTPUT     = 4
+CONST MENU_COUNT_OUTPUT     = 5
 
 CONST MENU_OFFSET_MAIN      = 0
 CONST MENU_OFFSET_POPUP     = MENU_OFFSET_MAIN    + MENU_DATA_COUNT_MAIN
@@ -34,8 +34,9 @@ CONST OPT_COUNT_SPRITES     = 4
 CONST OPT_COUNT_CLOCK       = 3
 CONST OPT_COUNT_PALETTE     = 5
 CONST OPT_COUNT_DRIVER      = 3
-CONST OPT_COUNT_VGA_MODE    = 1
-CONST OPT_COUNT_SCART_MODE  = 2
+CONST OPT_COUNT_VGA_MODE    = 5
+CONST OPT_COUNT_SCART_MODE  = 4
+CONST OPT_COUNT_VDP_RATE    = 3
 
 CONST OPT_OFFSET_ONOFF      = 0
 CONST OPT_OFFSET_SPRITES    = OPT_OFFSET_ONOFF    + OPT_COUNT_ONOFF
@@ -44,6 +45,7 @@ CONST OPT_OFFSET_PALETTE    = OPT_OFFSET_CLOCK    + OPT_COUNT_CLOCK
 CONST OPT_OFFSET_DRIVER     = OPT_OFFSET_PALETTE  + OPT_COUNT_PALETTE
 CONST OPT_OFFSET_VGA_MODE   = OPT_OFFSET_DRIVER   + OPT_COUNT_DRIVER
 CONST OPT_OFFSET_SCART_MODE = OPT_OFFSET_VGA_MODE + OPT_COUNT_VGA_MODE
+CONST OPT_OFFSET_VDP_RATE   = OPT_OFFSET_SCART_MODE + OPT_COUNT_SCART_MODE
 
 ' -----------------------------------------------------------------------------
 ' Pico9918Options index, name[16], values index, num values, help[32]
@@ -85,10 +87,12 @@ configMenuData:
     DATA BYTE CONF_MENU_RESET,       "Preset          ", OPT_OFFSET_PALETTE, OPT_COUNT_PALETTE, "      Select preset palette     "
     DATA BYTE CONF_MENU_CANCEL,      "<<< Main menu   ", 0,                  0,                 "        Back to main menu       "
 
-    ' Output submenu - MENU_OFFSET_OUTPUT, MENU_COUNT_OUTPUT
-    DATA BYTE CONF_DISP_DRIVER_PREF, "Driver          ", OPT_OFFSET_DRIVER,     OPT_COUNT_DRIVER,     "Output driver (requires reboot) "
-    DATA BYTE CONF_VGA_MODE,         "VGA/HDMI mode   ", OPT_OFFSET_VGA_MODE,   OPT_COUNT_VGA_MODE,   "  VGA mode  (requires reboot)   "
-    DATA BYTE CONF_SCART_MODE,       "SCART mode      ", OPT_OFFSET_SCART_MODE, OPT_COUNT_SCART_MODE, " SCART mode  (requires reboot)  "
+    ' Output submenu - MENU_OFFSET_OUTPUT, MENU_COUNT_OUTPUT. VDP rate first:
+    ' firmware without CONF_CAP_VDP_RATE gets the rows after it
+    DATA BYTE CONF_VDP_RATE,         "VDP rate        ", OPT_OFFSET_VDP_RATE,   OPT_COUNT_VDP_RATE,   "VDP frame rate (requires reboot)"
+    DATA BYTE CONF_DISP_DRIVER_PREF, "Driver          ", OPT_OFFSET_DRIVER,     OPT_COUNT_DRIVER,     "Output driver (applied on save) "
+    DATA BYTE CONF_VGA_MODE,         "VGA/HDMI mode   ", OPT_OFFSET_VGA_MODE,   OPT_COUNT_VGA_MODE,   "  VGA mode  (applied on save)   "
+    DATA BYTE CONF_SCART_MODE,       "SCART mode      ", OPT_OFFSET_SCART_MODE, OPT_COUNT_SCART_MODE, " SCART mode  (applied on save)  "
     DATA BYTE CONF_MENU_CANCEL,      "<<< Main menu   ", 0,                     0,                    "        Back to main menu       "
 
 ' -----------------------------------------------------------------------------
@@ -122,9 +126,20 @@ configMenuOptionValueData:
     DATA BYTE "VGA/HD"
     DATA BYTE "SCART "
 
-    ' VGA mode - OPT_OFFSET_VGA_MODE, OPT_COUNT_VGA_MODE
+    ' VGA mode - OPT_OFFSET_VGA_MODE, OPT_COUNT_VGA_MODE  (matches CONF_VGA_MODE: 0=640x480, 1=640x400, 2=1024x768, 3=1280x1024, 4=720x576)
     DATA BYTE "480p60"
+    DATA BYTE "400p70"
+    DATA BYTE "768p60"
+    DATA BYTE "SXGA60"
+    DATA BYTE "576p50"
 
-    ' SCART mode - OPT_OFFSET_SCART_MODE, OPT_COUNT_SCART_MODE  (matches CONF_SCART_MODE: 0=PAL, 1=NTSC)
+    ' SCART mode - OPT_OFFSET_SCART_MODE, OPT_COUNT_SCART_MODE  (matches CONF_SCART_MODE: 0=PAL, 1=NTSC, 2=PAL 288p, 3=NTSC 240p)
     DATA BYTE "576i50"
     DATA BYTE "480i60"
+    DATA BYTE "288p50"
+    DATA BYTE "240p60"
+
+    ' VDP rate - OPT_OFFSET_VDP_RATE, OPT_COUNT_VDP_RATE  (matches CONF_VDP_RATE: 0=follow display)
+    DATA BYTE "Auto  "
+    DATA BYTE "50Hz  "
+    DATA BYTE "60Hz  "
@@ -238,7 +238,7 @@ firmwareWriteAndVerify: PROCEDURE
     'PRINT AT XY(5, a_popupTop), "Firmware write "
     IF STATUS THEN
      '   PRINT "success"
-        clockChanged = TRUE
+        rebootRequired = TRUE
         GOSUB successMessage
     ELSE
       '  PRINT "failed"
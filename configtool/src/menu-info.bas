@@ -72,9 +72,27 @@ deviceInfoMenu: PROCEDURE
     ELSEIF optValue = 2 THEN
         PRINT AT #addr, "RGBs PAL"
         PRINT AT #addr + 32, "576i 50Hz"
+    ELSEIF optValue = 3 THEN
+        PRINT AT #addr, "RGBs NTSC"
+        PRINT AT #addr + 32, "240p 60Hz"
+    ELSEIF optValue = 4 THEN
+        PRINT AT #addr, "RGBs PAL"
+        PRINT AT #addr + 32, "288p 50Hz"
     ELSE
         PRINT AT #addr, "VGA/HDMI"
-        PRINT AT #addr + 32, "480p 60Hz"
+        VDP_REG(58) = CONF_VGA_MODE
+        optValue = VDP_STATUS
+        IF optValue = 1 THEN
+            PRINT AT #addr + 32, "400p 70Hz"
+        ELSEIF optValue = 2 THEN
+            PRINT AT #addr + 32, "768p 60Hz"
+        ELSEIF optValue = 3 THEN
+            PRINT AT #addr + 32, "1024p 60Hz"
+        ELSEIF optValue = 4 THEN
+            PRINT AT #addr + 32, "576p 50Hz"
+        ELSE
+            PRINT AT #addr + 32, "480p 60Hz"
+        END IF
     END IF
 
     VDP_STATUS_REG = 14      ' SR14: Version
@@ -345,9 +345,9 @@ confirmationMenuLoop: PROCEDURE
     END
 
 successMessage: PROCEDURE
-    ' if the clock frequency has changed... inform reboot
+    ' if the vdp rate or firmware has changed... inform reboot
     PRINT AT XY(0, MENU_HELP_ROW), " Success! "
-    IF clockChanged THEN
+    IF rebootRequired THEN
         PRINT "** Reboot required ** "
     ELSE
         PRINT " Configuration saved  "
@@ -395,6 +395,7 @@ saveOptionsMenu: PROCEDURE
     IF confirm THEN
         GOSUB saveOptions
         GOSUB successMessage
+        GOSUB awaitDisplaySwitch
     END IF
 
     END
@@ -8,15 +8,19 @@
 ' https://github.com/visrealm/pico9918
 '
 
-' Output submenu: Driver / VGA mode / SCART mode. All require a reboot.
+' Output submenu: VDP rate / Driver / VGA mode / SCART mode. The firmware
+' switches to a new display mode when saved; the VDP rate requires a reboot.
+' The VDP rate is only offered when the firmware acts on it
+' (CONF_CAP_VDP_RATE: PICO9918 PRO frame buffer builds).
 
 ' Tracked fields for the Output dirty flag. To add a field, append here and
 ' bump OUTPUT_FIELD_COUNT.
-CONST OUTPUT_FIELD_COUNT = 3
+CONST OUTPUT_FIELD_COUNT = 4
 outputFields:
     DATA BYTE CONF_DISP_DRIVER_PREF
     DATA BYTE CONF_VGA_MODE
     DATA BYTE CONF_SCART_MODE
+    DATA BYTE CONF_VDP_RATE
 
 recomputeOutputDirty: PROCEDURE
     g_outputDirty = FALSE
@@ -33,7 +37,11 @@ outputMenu: PROCEDURE
     DRAW_TITLE("OUTPUT")
 
     GOSUB pushMenuCtx
-    SET_MENU_CTX(MENU_OFFSET_OUTPUT, MENU_COUNT_OUTPUT, 1, MENU_TITLE_ROW + 3)
+    IF g_picoCaps AND CONF_CAP_VDP_RATE THEN
+        SET_MENU_CTX(MENU_OFFSET_OUTPUT, MENU_COUNT_OUTPUT, 1, MENU_TITLE_ROW + 3)
+    ELSE
+        SET_MENU_CTX(MENU_OFFSET_OUTPUT + 1, MENU_COUNT_OUTPUT - 1, 1, MENU_TITLE_ROW + 3)
+    END IF
     g_currentMenuIndex = MENU_INDEX_OFFSET
 
     GOSUB renderMenu
@@ -111,16 +111,25 @@ bool isScartConnected()
   return scartConnected;
 }
 
+/*
+ * CONF_DISP_DRIVER for config's CONF_DISP_DRIVER_PREF + dongle detection
+ *   pref: 0=AUTO, 1=VGA, 2=SCART  ->  driver: 0=VGA, 1=NTSC, 2=PAL, 3=NTSC 240p, 4=PAL 288p
+ */
+uint8_t configDispDriver(const uint8_t *config)
+{
+  static const uint8_t scartDrivers[] = {2, 1, 4, 3};  // indexed by CONF_SCART_MODE
+
+  uint8_t pref = config[CONF_DISP_DRIVER_PREF];
+  bool useScart = (pref == 2) || (pref == 0 && isScartConnected());
+  return useScart ? scartDrivers[config[CONF_SCART_MODE] & 0x03] : 0;
+}
+
 /*
  * update CONF_DISP_DRIVER from CONF_DISP_DRIVER_PREF + dongle detection
- *   pref: 0=AUTO, 1=VGA, 2=SCART  ->  driver: 0=VGA, 1=NTSC, 2=PAL
  */
 void updateDispDriver()
 {
-  uint8_t pref = tms9918->config[CONF_DISP_DRIVER_PREF];
-  bool useScart = (pref == 2) || (pref == 0 && isScartConnected());
-  tms9918->config[CONF_DISP_DRIVER] = useScart
-    ? (2 - tms9918->config[CONF_SCART_MODE]) : 0;
+  tms9918->config[CONF_DISP_DRIVER] = configDispDriver(tms9918->config);
 }
 
 /*
@@ -159,29 +168,7 @@ void applyConfig()
 #define PENDING_FLASH_ADDR   (uint8_t*)(XIP_BASE + PENDING_FLASH_OFFSET)
 
 static uint8_t pendingBannerState = PENDING_BANNER_NONE;
-
-/*
- * Pending block takes precedence: a pending driver change must influence the
- * initial clock too. Called before readConfig() / applyPendingDisplay().
- */
-bool shouldUseScartClock()
-{
-  const uint8_t *pendingFlash = PENDING_FLASH_ADDR;
-  uint8_t pendingState = pendingFlash[0];
-  if (pendingState == PENDING_STATE_PENDING || pendingState == PENDING_STATE_ARMED)
-  {
-    uint8_t pref = pendingFlash[1];
-    if (pref == 1) return false;
-    if (pref == 2) return true;
-    // AUTO or invalid: fall through
-  }
-
-  const uint8_t *mainFlash = CONFIG_FLASH_ADDR;
-  uint8_t pref = mainFlash[CONF_DISP_DRIVER_PREF];
-  if (pref == 1) return false;
-  if (pref == 2) return true;
-  return isScartConnected();
-}
+static volatile bool displaySwitchRequested = false;
 
 // erased or unrecognised state byte -> treat as CONFIRMED
 void readPendingDisplay(PendingDisplay *p)
@@ -244,10 +231,11 @@ static const ConfigField configFields[] =
   { CONF_CRT_SCANLINES,    1,                    0,            PENDING_MIRROR_NONE,       0x1000 },
   { CONF_SCANLINE_SPRITES, 3,                    0,            PENDING_MIRROR_NONE,       0x1000 },
   { CONF_CLOCK_PRESET_ID,  2,                    0,            CONF_PENDING_CLOCK_PRESET, 0x1000 },
-  { CONF_SCART_MODE,       1,                    0,            CONF_PENDING_SCART_MODE,   0x1200 },
+  { CONF_SCART_MODE,       3,                    0,            CONF_PENDING_SCART_MODE,   0x1200 },
   { CONF_VDP_DEVICE,       VDP_DEVICE_COUNT - 1, VDP_TMS9918A, PENDING_MIRROR_NONE,       0x1101 },
   { CONF_DISP_DRIVER_PREF, 2,                    0,            CONF_PENDING_DRIVER_PREF,  0x1200 },  // 1.2.0
-  { CONF_VGA_MODE,         0,                    0,            CONF_PENDING_VGA_MODE,     0x1200 },  // 0=480p60 (only)
+  { CONF_VGA_MODE,         4,                    0,            CONF_PENDING_VGA_MODE,     0x1200 },  // 0=480p60, 1=400p70, 2=768p60, 3=1024p60, 4=576p50
+  { CONF_VDP_RATE,         2,                    0,            PENDING_MIRROR_NONE,       0x1200 },  // 0=follow display
   { CONF_DIAG_REGISTERS,   1,                    0,            PENDING_MIRROR_NONE,       0x1000 },
   { CONF_DIAG_PERFORMANCE, 1,                    0,            PENDING_MIRROR_NONE,       0x1000 },
   { CONF_DIAG_PALETTE,     1,                    0,            PENDING_MIRROR_NONE,       0x1000 },
@@ -266,7 +254,15 @@ void refreshPendingMirror(uint8_t config[CONFIG_BYTES], uint8_t state)
   }
 }
 
-// call after readConfig(): PENDING -> apply + ARMED, ARMED -> revert + erase
+// the flash update applyPendingDisplay() leaves to commitPendingDisplay()
+#define PENDING_COMMIT_NONE   0
+#define PENDING_COMMIT_ARM    1
+#define PENDING_COMMIT_ERASE  2
+static uint8_t pendingCommit = PENDING_COMMIT_NONE;
+static PendingDisplay pendingCommitBlock;
+
+// call after readConfig(): PENDING -> apply + ARMED, ARMED -> revert + erase.
+// config only: the flash block changes in commitPendingDisplay()
 void applyPendingDisplay(uint8_t config[CONFIG_BYTES])
 {
   PendingDisplay p;
@@ -280,14 +276,15 @@ void applyPendingDisplay(uint8_t config[CONFIG_BYTES])
     config[CONF_CLOCK_PRESET_ID]  = p.clockPresetId;
 
     p.state = PENDING_STATE_ARMED;
-    writePendingDisplay(&p);
+    pendingCommitBlock = p;
+    pendingCommit = PENDING_COMMIT_ARM;
 
     pendingBannerState = PENDING_BANNER_AWAIT_OK;
     refreshPendingMirror(config, PENDING_STATE_ARMED);
   }
   else if (p.state == PENDING_STATE_ARMED)
   {
-    erasePendingDisplay();
+    pendingCommit = PENDING_COMMIT_ERASE;
     pendingBannerState = PENDING_BANNER_NONE;
     refreshPendingMirror(config, PENDING_STATE_CONFIRMED);
   }
@@ -298,6 +295,44 @@ void applyPendingDisplay(uint8_t config[CONFIG_BYTES])
   }
 }
 
+// write what applyPendingDisplay() decided. boot does this once the tms bus
+// is up: the flash erase takes tens of milliseconds
+void commitPendingDisplay()
+{
+  if (pendingCommit == PENDING_COMMIT_ARM)
+    writePendingDisplay(&pendingCommitBlock);
+  else if (pendingCommit == PENDING_COMMIT_ERASE)
+    erasePendingDisplay();
+
+  pendingCommit = PENDING_COMMIT_NONE;
+}
+
+// live switch: advance a just-saved PENDING block to ARMED as if we had
+// rebooted into it. the display switches at the end of the next frame
+// (takeDisplaySwitchRequest). rebooting before confirming still reverts
+bool armPendingDisplay(uint8_t config[CONFIG_BYTES])
+{
+  PendingDisplay p;
+  readPendingDisplay(&p);
+
+  if (p.state != PENDING_STATE_PENDING) return false;
+
+  p.state = PENDING_STATE_ARMED;
+  if (!writePendingDisplay(&p)) return false;
+
+  pendingBannerState = PENDING_BANNER_AWAIT_OK;
+  refreshPendingMirror(config, PENDING_STATE_ARMED);
+  displaySwitchRequested = true;
+  return true;
+}
+
+bool takeDisplaySwitchRequest()
+{
+  if (!displaySwitchRequested) return false;
+  displaySwitchRequested = false;
+  return true;
+}
+
 static inline uint16_t configStoredVersion(const uint8_t *config)
 {
   return ((uint16_t)config[CONF_SW_VERSION] << 8) | config[CONF_SW_PATCH_VERSION];
@@ -367,11 +402,15 @@ void readConfig(uint8_t config[CONFIG_BYTES])
   }
 
   // writeConfig() persists all 256 bytes; clear command bytes read from flash
+  config[CONF_GPU_PROFILE]     = 0;
   config[CONF_SAVE_FORCED]     = 0;
   config[CONF_PENDING_CANCEL]  = 0;
   config[CONF_PENDING_CONFIRM] = 0;
   config[CONF_SAVE_TO_FLASH]   = 0;
 
+  // this build's, whatever an older one saved there
+  config[CONF_CAPABILITIES] = CONF_CAPS;
+
   if (storedVer != PICO9918_SW_VERSION_FULL)
   {
     migrateNewFields(config, storedVer);
@@ -32,15 +32,17 @@ typedef enum
   CONF_CLOCK_TESTED     = 4,
   CONF_DISP_DRIVER      = 5,
   CONF_FLASH_STATUS     = 6,
+  CONF_CAPABILITIES     = 7,   // CONF_CAP_* flags: the options this build acts on
 
   // settable via registers
   CONF_CRT_SCANLINES    = 8,
   CONF_SCANLINE_SPRITES = 9,
   CONF_CLOCK_PRESET_ID  = 10,
-  CONF_SCART_MODE       = 11,  // 0 = PAL 576i (default), 1 = NTSC 480i
+  CONF_SCART_MODE       = 11,  // 0 = PAL 576i (default), 1 = NTSC 480i, 2 = PAL 288p, 3 = NTSC 240p
   CONF_VDP_DEVICE       = 12,
   CONF_DISP_DRIVER_PREF = 13,  // 0 = AUTO (detect dongle), 1 = force VGA, 2 = force SCART
-  CONF_VGA_MODE         = 14,  // 0 = 480p60 (extensible)
+  CONF_VGA_MODE         = 14,  // 0 = 480p60, 1 = 400p70, 2 = 768p60, 3 = 1024p60, 4 = 576p50
+  CONF_VDP_RATE         = 15,  // 0 = follow display, 1 = 50 Hz, 2 = 60 Hz (RP2350 PICO9918_FRAME_BUFFER builds)
 
   CONF_DIAG             = 16,
   CONF_DIAG_REGISTERS   = 17,
@@ -59,6 +61,7 @@ typedef enum
   CONF_PENDING_CLOCK_PRESET = 204,
 
   // commands (configurator writes 1 to trigger)
+  CONF_GPU_PROFILE      = 251, // PICO9918_GPU_PROFILE builds: 0x80|page = dump page to VRAM >3C00 (overwrites >3C00->3FFF), 0x40 = reset
   CONF_SAVE_FORCED      = 252,
   CONF_PENDING_CANCEL   = 253,
   CONF_PENDING_CONFIRM  = 254,
@@ -83,6 +86,15 @@ typedef enum
 
 #define CONFIG_BYTES 256
 
+/* CONF_CAPABILITIES flags */
+#define CONF_CAP_VDP_RATE 0x01   // CONF_VDP_RATE (RP2350 PICO9918_FRAME_BUFFER builds)
+
+#if PICO_RP2350 && PICO9918_FRAME_BUFFER
+#define CONF_CAPS CONF_CAP_VDP_RATE
+#else
+#define CONF_CAPS 0
+#endif
+
 /* get the (cached) hardware version; detects on first call. */
 Pico9918HardwareVersion currentHwVersion();
 
@@ -92,11 +104,12 @@ bool detectScartDongle();
 /* true if a SCART dongle was detected at boot */
 bool isScartConnected();
 
+/* CONF_DISP_DRIVER for a config's driver preference and SCART detection */
+uint8_t configDispDriver(const uint8_t *config);
+
 /* update CONF_DISP_DRIVER at runtime based on SCART detection */
 void updateDispDriver();
 
-/* true if boot-time clock should be SCART (270 MHz). Call after detectScartDongle(). */
-bool shouldUseScartClock();
 
 /* read configuration data from flash */
 void readConfig(uint8_t config[CONFIG_BYTES]);
@@ -140,9 +153,19 @@ void readPendingDisplay(PendingDisplay *p);
 bool writePendingDisplay(const PendingDisplay *p);
 bool erasePendingDisplay();
 
-/* PENDING -> apply to config + advance to ARMED. ARMED -> revert + erase. */
+/* PENDING -> apply to config + advance to ARMED. ARMED -> revert + erase.
+ * changes config only: commitPendingDisplay() updates the flash block */
 void applyPendingDisplay(uint8_t config[CONFIG_BYTES]);
 
+/* write the pending block change applyPendingDisplay() made */
+void commitPendingDisplay();
+
+/* PENDING -> ARMED without a reboot: requests a live display switch */
+bool armPendingDisplay(uint8_t config[CONFIG_BYTES]);
+
+/* true (once) when the display should switch to the armed settings */
+bool takeDisplaySwitchRequest();
+
 /* OSD banner state:
  *   0 = none
  *   1 = saved-pending (awaiting power cycle to test)
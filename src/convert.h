@@ -0,0 +1,34 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * scanline conversion kernels
+ *
+ * implemented per-core in convert_m0.c (RP2040) and convert_m33.c (RP2350),
+ * selected at build time in src/CMakeLists.txt. both must produce
+ * bit-identical output.
+ */
+
+/* convert count (multiple of 8) colour indices to packed BGR pixel pairs */
+void convertScanline(const uint8_t *src, uint32_t *dst, const uint32_t *pal, int count);
+
+/* convertScanline, also writing the CRT-dimmed pairs (as vgaDimPixels()) to dstDim */
+void convertScanlineDim(const uint8_t *src, uint32_t *dst, uint32_t *dstDim, const uint32_t *pal, int count);
+
+/* expand count (multiple of 8) F18A palette entries to doubled BGR pixel pairs */
+void expandPalette(const uint16_t *f18aPal, uint32_t *pal, int count);
+
+/* expand the first 16 F18A palette entries to 256 (lo, hi) nibble pairs for 80-column mode */
+void expandPalettePairs(const uint16_t *f18aPal, uint32_t *pal);
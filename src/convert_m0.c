@@ -0,0 +1,106 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#include "convert.h"
+
+#include "pico.h"
+
+/* F18A palette entries are big-endian 0x0RGB which looks like
+   0xGB0R to our RP2040. our vga code is expecting 0x0BGR
+   so we've got B and R correct by pure chance. just need to shift G
+   over. */
+#define BIG_RGB_2_LITTLE_BGR(v) (((v) & 0xFF0F) | ((((v) & 0xFF0F) >> 12) << 4))
+
+/*
+ * convert colour indices to BGR pixel pairs (Cortex-M0+)
+ *
+ * byte loads are as cheap as word loads on the M0+, so just unroll
+ */
+void __time_critical_func(convertScanline)(const uint8_t *src, uint32_t *dst, const uint32_t *pal, int count)
+{
+  const uint8_t *end = src + count;
+
+  while (src < end)
+  {
+    dst [0] = pal[src[0]];
+    dst [1] = pal[src[1]];
+    dst [2] = pal[src[2]];
+    dst [3] = pal[src[3]];
+    dst [4] = pal[src[4]];
+    dst [5] = pal[src[5]];
+    dst [6] = pal[src[6]];
+    dst [7] = pal[src[7]];
+    dst += 8;
+    src += 8;
+  }
+}
+
+/*
+ * convert colour indices to BGR pixel pairs and their CRT-dimmed twins
+ * (Cortex-M0+). the dimmed pair is a plain shift: the RP2040 masks the
+ * bits carried into each colour's msb with its pin directions
+ */
+void __time_critical_func(convertScanlineDim)(const uint8_t *src, uint32_t *dst, uint32_t *dstDim, const uint32_t *pal, int count)
+{
+  const uint8_t *end = src + count;
+
+  while (src < end)
+  {
+    uint32_t p;
+    p = pal[src[0]]; dst [0] = p; dstDim [0] = p >> 1;
+    p = pal[src[1]]; dst [1] = p; dstDim [1] = p >> 1;
+    p = pal[src[2]]; dst [2] = p; dstDim [2] = p >> 1;
+    p = pal[src[3]]; dst [3] = p; dstDim [3] = p >> 1;
+    p = pal[src[4]]; dst [4] = p; dstDim [4] = p >> 1;
+    p = pal[src[5]]; dst [5] = p; dstDim [5] = p >> 1;
+    p = pal[src[6]]; dst [6] = p; dstDim [6] = p >> 1;
+    p = pal[src[7]]; dst [7] = p; dstDim [7] = p >> 1;
+    dst += 8;
+    dstDim += 8;
+    src += 8;
+  }
+}
+
+/*
+ * expand palette entries to doubled pixel pairs (Cortex-M0+)
+ */
+void __time_critical_func(expandPalette)(const uint16_t *f18aPal, uint32_t *pal, int count)
+{
+  uint32_t data;
+  for (int i = 0; i < count; i += 8)
+  {
+    data = f18aPal [i + 0]; pal [i + 0] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 1]; pal [i + 1] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 2]; pal [i + 2] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 3]; pal [i + 3] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 4]; pal [i + 4] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 5]; pal [i + 5] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 6]; pal [i + 6] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+    data = f18aPal [i + 7]; pal [i + 7] = BIG_RGB_2_LITTLE_BGR(data) * 0x10001;
+  }
+}
+
+/*
+ * expand palette entries to 80-column nibble pairs (Cortex-M0+)
+ */
+void __time_critical_func(expandPalettePairs)(const uint16_t *f18aPal, uint32_t *pal)
+{
+  uint16_t tmpPal[16];
+  for (int i = 0; i < 16; ++i)
+  {
+    tmpPal[i] = BIG_RGB_2_LITTLE_BGR(f18aPal [i]);
+    pal[i] = tmpPal[i] * 0x10001;
+  }
+  for (int j = 16; j < 256; ++j)
+  {
+    pal[j] = (tmpPal[j & 0xf] << 16) | (tmpPal[j >> 4] & 0xffff);
+  }
+}
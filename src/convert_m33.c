@@ -0,0 +1,159 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#include "convert.h"
+
+#include "pico.h"
+
+/*
+ * Cortex-M33 (RP2350) kernels
+ *
+ * the M33 has single-cycle UBFX and the DSP pack instructions, so these
+ * fetch four colour indices (or two palette entries) per load and build
+ * pixel pairs with PKHBT/PKHTB rather than a multiply.
+ */
+
+/* pack bottom halfwords: lo[15:0] | hi[15:0] << 16 */
+static inline __attribute__((always_inline)) uint32_t pkhbt16(uint32_t lo, uint32_t hi)
+{
+#if defined(__arm__)
+  uint32_t out;
+  __asm__ ("pkhbt %0, %1, %2, lsl #16" : "=r" (out) : "r" (lo), "r" (hi));
+  return out;
+#else
+  return (lo & 0xffff) | (hi << 16);   // host builds (test/sim)
+#endif
+}
+
+/* pack top halfwords: lo[31:16] | hi[31:16] << 16 */
+static inline __attribute__((always_inline)) uint32_t pkhtb16(uint32_t lo, uint32_t hi)
+{
+#if defined(__arm__)
+  uint32_t out;
+  __asm__ ("pkhtb %0, %1, %2, asr #16" : "=r" (out) : "r" (hi), "r" (lo));
+  return out;
+#else
+  return (lo >> 16) | (hi & 0xffff0000);
+#endif
+}
+
+/* two F18A 0x0RGB entries (as read little-endian) to two 0x0BGR entries */
+static inline __attribute__((always_inline)) uint32_t bigRgb2LittleBgrx2(uint32_t v)
+{
+  v &= 0xFF0FFF0F;
+  return v | (((v >> 12) & 0x000F000F) << 4);
+}
+
+/*
+ * convert colour indices to BGR pixel pairs (Cortex-M33)
+ *
+ * src must be word aligned (tmsScanlineBuffer is)
+ */
+void __time_critical_func(convertScanline)(const uint8_t *src, uint32_t *dst, const uint32_t *pal, int count)
+{
+  const uint32_t *src4 = (const uint32_t *)src;
+  const uint32_t *end = src4 + (count >> 2);
+
+  while (src4 < end)
+  {
+    uint32_t idx = src4[0];
+    dst [0] = pal[idx & 0xff];
+    dst [1] = pal[(idx >> 8) & 0xff];
+    dst [2] = pal[(idx >> 16) & 0xff];
+    dst [3] = pal[idx >> 24];
+    idx = src4[1];
+    dst [4] = pal[idx & 0xff];
+    dst [5] = pal[(idx >> 8) & 0xff];
+    dst [6] = pal[(idx >> 16) & 0xff];
+    dst [7] = pal[idx >> 24];
+    dst += 8;
+    src4 += 2;
+  }
+}
+
+/*
+ * convert colour indices to BGR pixel pairs and their CRT-dimmed twins
+ * (Cortex-M33). each colour is halved within its nibble
+ */
+void __time_critical_func(convertScanlineDim)(const uint8_t *src, uint32_t *dst, uint32_t *dstDim, const uint32_t *pal, int count)
+{
+  const uint32_t *src4 = (const uint32_t *)src;
+  const uint32_t *end = src4 + (count >> 2);
+  const uint32_t mask = 0x07770777;
+
+  while (src4 < end)
+  {
+    uint32_t idx = src4[0];
+    uint32_t p0 = pal[idx & 0xff];
+    uint32_t p1 = pal[(idx >> 8) & 0xff];
+    uint32_t p2 = pal[(idx >> 16) & 0xff];
+    uint32_t p3 = pal[idx >> 24];
+    dst [0] = p0; dstDim [0] = (p0 >> 1) & mask;
+    dst [1] = p1; dstDim [1] = (p1 >> 1) & mask;
+    dst [2] = p2; dstDim [2] = (p2 >> 1) & mask;
+    dst [3] = p3; dstDim [3] = (p3 >> 1) & mask;
+    dst += 4;
+    dstDim += 4;
+    src4 += 1;
+  }
+}
+
+/*
+ * expand palette entries to doubled pixel pairs (Cortex-M33)
+ */
+void __time_critical_func(expandPalette)(const uint16_t *f18aPal, uint32_t *pal, int count)
+{
+  for (int i = 0; i < count; i += 4)
+  {
+    uint32_t data;
+    __builtin_memcpy(&data, f18aPal + i, sizeof(data));  // M33 allows unaligned ldr
+    data = bigRgb2LittleBgrx2(data);
+    pal [i + 0] = pkhbt16(data, data);
+    pal [i + 1] = pkhtb16(data, data);
+
+    __builtin_memcpy(&data, f18aPal + i + 2, sizeof(data));
+    data = bigRgb2LittleBgrx2(data);
+    pal [i + 2] = pkhbt16(data, data);
+    pal [i + 3] = pkhtb16(data, data);
+  }
+}
+
+/*
+ * expand palette entries to 80-column nibble pairs (Cortex-M33)
+ */
+void __time_critical_func(expandPalettePairs)(const uint16_t *f18aPal, uint32_t *pal)
+{
+  uint32_t tmpPal[16];
+  for (int i = 0; i < 16; i += 2)
+  {
+    uint32_t data;
+    __builtin_memcpy(&data, f18aPal + i, sizeof(data));
+    data = bigRgb2LittleBgrx2(data);
+    tmpPal[i + 0] = data & 0xffff;
+    tmpPal[i + 1] = data >> 16;
+    pal[i + 0] = pkhbt16(data, data);
+    pal[i + 1] = pkhtb16(data, data);
+  }
+
+  // pal[hi << 4 | lo] = tmpPal[lo] << 16 | tmpPal[hi]
+  for (int hi = 1; hi < 16; ++hi)
+  {
+    const uint32_t left = tmpPal[hi];
+    uint32_t *out = pal + (hi << 4);
+    for (int lo = 0; lo < 16; lo += 4)
+    {
+      out[lo + 0] = pkhbt16(left, tmpPal[lo + 0]);
+      out[lo + 1] = pkhbt16(left, tmpPal[lo + 1]);
+      out[lo + 2] = pkhbt16(left, tmpPal[lo + 2]);
+      out[lo + 3] = pkhbt16(left, tmpPal[lo + 3]);
+    }
+  }
+}
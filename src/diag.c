@@ -55,15 +55,24 @@ IntString gpuPctStr = {0};
 IntString clockMhzStr = {0};
 IntString modeStr = {0};
 IntString fpsStr = {0};
+IntString lateLinesStr = {0};
 #if PICO9918_GPU_FRAME_COUNTER
 IntString gpuFrameStr = {0};
 #endif
 IntString hwVerStr = {0};
 IntString fwVerStr = {0};
 IntString outputStr = {0};
+IntString bootPhaseStr[DIAG_BOOT_PHASES] = {0};
 
-static const char *outputValues[] = {"480P ", "480I ", "576I "};
-static const char *outputUnits[]  = {"@60", "@60", "@50"};
+static const char *outputValues[] = {"480P ", "480I ", "576I ", "240P ", "288P "};
+static const char *outputUnits[]  = {"@60", "@60", "@50", "@60", "@50"};
+static const char *outputUnit = "@60";
+static bool modeFallback = false;
+
+// vga output names, matched on the running mode's active lines
+static const struct { uint16_t lines; const char *value; const char *units; } vgaOutputs[] = {
+  { 480, "480P ", "@60" }, { 400, "400P ", "@70" }, { 768, "768P ", "@60" }, { 1024, "1024P", "@60" }, { 576, "576P ", "@50" }
+};
 
 IntString nameTabStr = {0};
 IntString colorTabStr = {0};
@@ -169,6 +178,7 @@ void initDiagnostics()
   clear(&gpuPctStr);
   clear(&modeStr);
   clear(&fpsStr);
+  clear(&lateLinesStr);
   clear(&hwVerStr);
   clear(&fwVerStr);
 
@@ -180,8 +190,24 @@ void initDiagnostics()
   clear(&outputStr);
 
   uint8_t driver = tms9918->config[CONF_DISP_DRIVER];
-  if (driver > 2) driver = 0;
+  if (driver > 4) driver = 0;
   strcpy(outputStr.digits, outputValues[driver]);
+  outputUnit = outputUnits[driver];
+
+  if (driver == 0)
+  {
+    for (int i = 0; i < sizeof(vgaOutputs) / sizeof(vgaOutputs[0]); ++i)
+    {
+      if (vgaOutputs[i].lines == vgaCurrentParams()->params.vSyncParams.displayPixels)
+      {
+        strcpy(outputStr.digits, vgaOutputs[i].value);
+        outputUnit = vgaOutputs[i].units;
+      }
+    }
+
+    if (modeFallback)
+      outputUnit = "@60 FALLBACK";
+  }
 
   Pico9918HardwareVersion hwVersion = currentHwVersion();
 #if PICO_RP2350
@@ -214,6 +240,17 @@ void diagSetClockHz(float clockHz)
   flt2Str(clockHz / 1000000.0f, 1, &clockMhzStr);
 }
 
+void diagSetModeFallback(bool fallback)
+{
+  modeFallback = fallback;
+}
+
+/* record the end of a boot phase in milliseconds since reset */
+void diagBootPhase(DiagBootPhase phase)
+{
+  flt2Str(time_us_32() / 1000.0f, 1, &bootPhaseStr[phase]);
+}
+
 extern int droppedFramesCount;
 #if PICO9918_GPU_FRAME_COUNTER
 extern uint32_t gpuFrameCount;
@@ -253,6 +290,7 @@ void updateDiagnostics(uint32_t frameCount)
     if ((++frameCount & (framesPerUpdate - 1)) == 0)
     {
       flt2Str((16.0f - droppedFramesCount) * (vgaCurrentParams()->params.frameRateHz / 16.0f), 2, &fpsStr);
+      uint2Str(vgaDeadlineStats()->missedLines, 1, &lateLinesStr);
     }
   }
 
@@ -399,6 +437,12 @@ static void diagFPS(uint16_t row, uint16_t* pixels)
   renderLeft("FPS   : ", &fpsStr, "FPS", row, pixels);
 }
 
+static void diagLateLines(uint16_t row, uint16_t* pixels)
+{
+  static const char *levelUnits[VGA_DEGRADE_LEVELS] = {" L0", " L1", " L2", " L3"};
+  renderLeft("LATE  : ", &lateLinesStr, levelUnits[vgaDegradeLevel()], row, pixels);
+}
+
 static void diagTemp(uint16_t row, uint16_t* pixels)
 {
   renderLeft("TEMP  : ", &temperatureStr, "^C", row, pixels);
@@ -406,9 +450,7 @@ static void diagTemp(uint16_t row, uint16_t* pixels)
 
 static void diagOutput(uint16_t row, uint16_t* pixels)
 {
-  uint8_t driver = tms9918->config[CONF_DISP_DRIVER];
-  if (driver > 2) driver = 0;
-  renderLeft("OUTPUT: ", &outputStr, outputUnits[driver], row, pixels);
+  renderLeft("OUTPUT: ", &outputStr, outputUnit, row, pixels);
 }
 
 static void diagClock(uint16_t row, uint16_t* pixels)
@@ -416,6 +458,36 @@ static void diagClock(uint16_t row, uint16_t* pixels)
   renderLeft("CLOCK : ", &clockMhzStr, "MHZ", row, pixels);
 }
 
+static void diagBootConfig(uint16_t row, uint16_t* pixels)
+{
+  renderLeft("BT CFG: ", &bootPhaseStr[DIAG_BOOT_CONFIG], "MS", row, pixels);
+}
+
+static void diagBootClock(uint16_t row, uint16_t* pixels)
+{
+  renderLeft("BT CLK: ", &bootPhaseStr[DIAG_BOOT_CLOCK], "MS", row, pixels);
+}
+
+static void diagBootLaunch(uint16_t row, uint16_t* pixels)
+{
+  renderLeft("BT CPU: ", &bootPhaseStr[DIAG_BOOT_LAUNCH], "MS", row, pixels);
+}
+
+static void diagBootBus(uint16_t row, uint16_t* pixels)
+{
+  renderLeft("BT BUS: ", &bootPhaseStr[DIAG_BOOT_BUS], "MS", row, pixels);
+}
+
+static void diagBootVga(uint16_t row, uint16_t* pixels)
+{
+  renderLeft("BT VGA: ", &bootPhaseStr[DIAG_BOOT_VGA], "MS", row, pixels);
+}
+
+static void diagBootFrame(uint16_t row, uint16_t* pixels)
+{
+  renderLeft("BT FRM: ", &bootPhaseStr[DIAG_BOOT_FRAME], "MS", row, pixels);
+}
+
 static void diagNameTab(uint16_t row, uint16_t* pixels)
 {
   renderLeft("NAME  : >", &nameTabStr, "", row, pixels);
@@ -530,11 +602,18 @@ DiagPtr performanceDiags[] = {
   &diagOutput,
   &diagRenderTime,
   &diagFPS,
+  &diagLateLines,
   &diagGpuTime,
 #if PICO9918_GPU_FRAME_COUNTER
   &diagGpuFrames,
 #endif
-  &diagTemp};
+  &diagTemp,
+  &diagBootConfig,
+  &diagBootClock,
+  &diagBootLaunch,
+  &diagBootBus,
+  &diagBootVga,
+  &diagBootFrame};
 
 DiagPtr addressDiags[] = {
   &diagMode,
@@ -702,7 +781,7 @@ void renderDiagnostics(uint16_t y, uint16_t* pixels)
     }
 
     dmResult = divmod_u32u32(diagRow, 10);
-    int xPos = 636 - (CHAR_WIDTH * 13);
+    int xPos = vgaCurrentParams()->params.hVirtualPixels - 4 - (CHAR_WIDTH * 13);
     char buf[] = "R00:"; buf[1] = '0' + to_quotient_u32(dmResult); buf[2] = '0' + to_remainder_u32(dmResult);
     xPos = renderText(row, buf, xPos, 0, labelColor, 0, pixels);
     xPos = backgroundPixels(xPos, 2, pixels);
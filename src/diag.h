@@ -12,6 +12,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #define CHAR_WIDTH  6
 #define CHAR_HEIGHT 6
@@ -22,6 +23,24 @@ void diagSetTemperature(float tempC);
 
 void diagSetClockHz(float clockHz);
 
+/* the configured vga mode couldn't be clocked and 640x480 is running instead */
+void diagSetModeFallback(bool fallback);
+
+/* boot phases, timed from reset. shown with the performance diagnostics */
+typedef enum
+{
+  DIAG_BOOT_CONFIG,   // config read and display planned
+  DIAG_BOOT_CLOCK,    // system clock set (once)
+  DIAG_BOOT_LAUNCH,   // proc1 launched
+  DIAG_BOOT_BUS,      // tms bus pios live (proc1)
+  DIAG_BOOT_VGA,      // vga output started
+  DIAG_BOOT_FRAME,    // first frame (splash) rendered
+  DIAG_BOOT_PHASES
+} DiagBootPhase;
+
+/* record the end of a boot phase (either core, once per phase) */
+void diagBootPhase(DiagBootPhase phase);
+
 void diagnosticsConfigUpdated();
 
 void updateDiagnostics(uint32_t frameCount);
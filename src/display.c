@@ -0,0 +1,142 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#include "display.h"
+
+#include "vga-clock.h"
+
+#define CLOCK_PRESET(VCO,PD1,PD2,MV) {VCO, PD1, PD2, MV, VCO / PD1 / PD2}
+
+#if PICO9918_ENABLE_SCART
+// SCART: clocks must be multiples of 54 MHz for exact integer pioClocksPerPixel
+// (pioFreq must be a multiple of 13.5 MHz, minimum 54 MHz)
+// 270/5=54MHz(4), 324/6=54MHz(4) clocks per pixel
+static const DisplayClock scartClockPresets[DISPLAY_CLOCK_PRESETS] = {
+  CLOCK_PRESET(1080000, 4, 1, 1150),    // 270 MHz
+  CLOCK_PRESET(1296000, 4, 1, 1200),    // 324 MHz
+  CLOCK_PRESET(1296000, 4, 1, 1200)     // 324 MHz (no safe higher option)
+};
+
+// indexed by CONF_SCART_MODE
+static const VgaMode scartModes[DISPLAY_SCART_MODES] = {
+  RGBS_PAL_720_576i_50HZ, RGBS_NTSC_720_480i_60HZ,
+  RGBS_PAL_720_288p_50HZ, RGBS_NTSC_720_240p_60HZ
+};
+#endif
+
+// VGA: clocks for 25.175 MHz pixel clock
+static const DisplayClock vgaClockPresets[DISPLAY_CLOCK_PRESETS] = {
+  CLOCK_PRESET(1512000, 6, 1, 1150),    // 252 MHz
+  CLOCK_PRESET(1512000, 5, 1, 1200),    // 302.4 MHz
+  CLOCK_PRESET(1056000, 3, 1, 1300)     // 352 MHz
+};
+
+/*
+ * vga output modes, indexed by CONF_VGA_MODE. modes with a pixel clock other
+ * than 25.175 MHz have their system clock planned (see vga-clock.h)
+ */
+typedef struct
+{
+  VgaMode mode;
+  uint8_t hScale;
+  uint8_t yScale;
+} VgaModeOption;
+
+static const VgaModeOption vgaModeOptions[DISPLAY_VGA_MODES] = {
+  { VGA_640_480_60HZ,   1, 2 },   // 640x240 virtual
+  { VGA_640_400_70HZ,   1, 2 },   // 640x200 virtual
+  { VGA_1024_768_60HZ,  2, 4 },   // 512x192 virtual
+  { VGA_1280_1024_60HZ, 2, 4 },   // 640x256 virtual
+  { VGA_720_576_50HZ,   1, 2 },   // 640x288 virtual. 50 Hz vdp interrupt for PAL software
+};
+
+/*
+ * clock preset (CONF_CLOCK_PRESET_ID) for vga or scart output
+ */
+DisplayClock displayPresetClock(bool scart, uint8_t preset)
+{
+  if (preset >= DISPLAY_CLOCK_PRESETS) preset = 0;
+
+#if PICO9918_ENABLE_SCART
+  if (scart) return scartClockPresets[preset];
+#endif
+  return vgaClockPresets[preset];
+}
+
+/*
+ * plan a display configuration. driver is CONF_DISP_DRIVER (0 = vga, else
+ * scart). vga modes the presets can't drive get a planned clock within the
+ * preset's voltage, or fall back to 640x480 if no clock fits
+ */
+DisplayPlan displayPlan(uint8_t driver, uint8_t vgaMode, uint8_t scartMode, uint8_t preset)
+{
+  DisplayPlan plan = { 0 };
+
+#if PICO9918_ENABLE_SCART
+  if (driver != 0)
+  {
+    plan.params = vgaGetParams(scartModes[scartMode % DISPLAY_SCART_MODES]);
+    plan.yScale = 1;   // 15 kHz: one line per row
+    plan.rows30 = plan.params.vVirtualPixels >= 240;
+    plan.clock = displayPresetClock(true, preset);
+    return plan;
+  }
+#endif
+
+  plan.clock = displayPresetClock(false, preset);
+
+  const VgaModeOption *option = &vgaModeOptions[vgaMode < DISPLAY_VGA_MODES ? vgaMode : 0];
+  plan.params = vgaGetParams(option->mode);
+
+  if (plan.params.pixelClockKHz != vgaGetParams(VGA_640_480_60HZ).pixelClockKHz)
+  {
+    const VgaClockRequest request = {
+      .pixelClockKHz  = plan.params.pixelClockKHz,
+      .hPixelScale    = option->hScale,
+      .minSysClockKHz = DISPLAY_PLAN_MIN_SYS_KHZ,
+      .maxSysClockKHz = DISPLAY_PLAN_MAX_SYS_KHZ,
+      .maxVoltageMv   = plan.clock.voltageMv,
+      .maxErrorPpm    = DISPLAY_PLAN_MAX_ERROR_PPM
+    };
+
+    VgaClockPlan clockPlan;
+    if (vgaPlanClock(&request, &clockPlan))
+    {
+      const DisplayClock planned = {
+        clockPlan.vcoKHz, clockPlan.postDiv1, clockPlan.postDiv2,
+        clockPlan.voltageMv, clockPlan.sysClockKHz
+      };
+      plan.clock = planned;
+    }
+    else
+    {
+      option = &vgaModeOptions[0];
+      plan.params = vgaGetParams(option->mode);
+      plan.fallback = true;
+    }
+  }
+
+  setVgaParamsScaleX(&plan.params, option->hScale);
+  plan.yScale = option->yScale;
+
+  // 1024x768 (192 virtual lines) has no room for row 30 mode: it stays at 24
+  plan.rows30 = plan.params.vVirtualPixels / plan.yScale >= 240;
+  return plan;
+}
+
+/*
+ * true if two clocks are the same pll and voltage settings
+ */
+bool displayClockEqual(const DisplayClock *a, const DisplayClock *b)
+{
+  return a->vcoKHz == b->vcoKHz && a->postDiv1 == b->postDiv1 &&
+         a->postDiv2 == b->postDiv2 && a->voltageMv == b->voltageMv;
+}
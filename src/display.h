@@ -1,21 +1,81 @@
-/*
- * Project: pico9918
- *
- * Copyright (c) 2024 Troy Schrapel
- *
- * This code is licensed under the MIT license
- *
- * https://github.com/visrealm/pico9918
- *
- */
-
-#pragma once
-
-#if PICO9918_ENABLE_SCART
-  // SCART autodetect: allocate worst-case buffer width, defer mode selection to runtime.
-  #define RGB_PIXELS_X 642    // 640 + 2 guard pixels for PIO autopull
-#else // VGA-only
-  #define DISPLAY_MODE VGA_640_480_60HZ
-  #define DISPLAY_YSCALE 2
-  #define RGB_PIXELS_X 642    // 640 + 2 guard pixels for PIO autopull
-#endif
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+#include "vga-modes.h"
+
+// display modes are selected at runtime (see displayPlan in display.c), so
+// allocate the worst-case virtual line width.
+#define RGB_PIXELS_X 642    // 640 + 2 guard pixels for PIO autopull
+
+/*
+ * display configuration planning
+ *
+ * resolves the output settings in config to an output mode and the system
+ * clock it runs at. pure (no SDK calls) so test/sim can check every
+ * combination off-target
+ */
+
+#define DISPLAY_CLOCK_PRESETS   3     // CONF_CLOCK_PRESET_ID values
+#define DISPLAY_VGA_MODES       5     // CONF_VGA_MODE values
+#define DISPLAY_SCART_MODES     4     // CONF_SCART_MODE values
+
+#define DISPLAY_PLAN_MIN_SYS_KHZ    252000    // lowest preset. the tms bus timing is tuned for at least this
+#define DISPLAY_PLAN_MAX_SYS_KHZ    352000    // flash clkdiv 4 limit
+#define DISPLAY_PLAN_MAX_ERROR_PPM  5000      // vesa pixel clock tolerance is 0.5%
+
+/*
+ * a system clock: pll settings and the core voltage it needs
+ */
+typedef struct
+{
+  uint32_t vcoKHz;
+  uint8_t  postDiv1;
+  uint8_t  postDiv2;
+  uint16_t voltageMv;
+  uint32_t sysClockKHz;
+} DisplayClock;
+
+/*
+ * a display configuration resolved to an output mode and system clock
+ */
+typedef struct
+{
+  VgaParams params;         // output mode, horizontal pixel scale applied
+  uint8_t yScale;           // display lines per tms row
+  bool rows30;              // room for the 30 row (240 line) display. otherwise 24 rows
+  DisplayClock clock;       // system clock to run at
+  bool fallback;            // the vga mode can't be clocked: 640x480 instead
+} DisplayPlan;
+
+/*
+ * clock preset (CONF_CLOCK_PRESET_ID) for vga or scart output
+ */
+DisplayClock displayPresetClock(bool scart, uint8_t preset);
+
+/*
+ * plan a display configuration. driver is CONF_DISP_DRIVER (0 = vga, else
+ * scart). vga modes the presets can't drive get a planned clock within the
+ * preset's voltage, or fall back to 640x480 if no clock fits
+ */
+DisplayPlan displayPlan(uint8_t driver, uint8_t vgaMode, uint8_t scartMode, uint8_t preset);
+
+/*
+ * true if two clocks are the same pll and voltage settings
+ */
+bool displayClockEqual(const DisplayClock *a, const DisplayClock *b);
+
+/*
+ * true if the output settings in config can be switched to live: they run
+ * at the system clock already applied. implemented in main.c
+ */
+bool displayModeSwitchable(const uint8_t *config);
@@ -0,0 +1,315 @@
+/*
+ * Project: pico9918 - gpu
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ * Purpose: TMS9900 GPU dma jobs
+ *
+ */
+
+#include "gpu-dma.h"
+
+#include "impl/vrEmuTms9918Priv.h"
+
+#include "pico/stdlib.h"
+#include "hardware/structs/mpu.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico.h" // For PICO_RP2040
+
+#define GPU_DMA_IRQ_INDEX   1       // DMA_IRQ_0 is the vga's
+#define GPU_DMA_MAX_ROWS    256
+#define GPU_DMA_STATUS      0x8008  // non-zero while a job runs
+
+/* MPU regions guarding a running job. region 0 is gpu.c's >8000 guard */
+#define GPU_DMA_SRC_REGION  1
+#define GPU_DMA_DST_REGION  2       // and 3 on the RP2350
+
+#if PICO_RP2040 // Old memory protection unit
+#define GUARD_READ_ONLY     6       // AP: read only
+#define GUARD_NO_ACCESS     0       // AP: no access
+#else
+#define GUARD_READ_ONLY     2       // AP: read only (privileged)
+#define GUARD_NO_ACCESS     2       // no such AP: read only, in two regions (see guardGpuDma)
+#endif
+
+static int gpuDmaChan = -1;       // gpu dma rows
+static int gpuDmaCtrlChan = -1;   // gpu dma control blocks (one per row)
+
+/* a gpu dma row, written to the row channel's READ_ADDR, WRITE_ADDR, TRANS_COUNT, CTRL_TRIG */
+typedef struct
+{
+  const volatile void *read;
+  volatile void *write;
+  uint32_t count;
+  uint32_t ctrl;
+} GpuDmaBlock;
+
+static GpuDmaBlock gpuDmaBlocks[GPU_DMA_MAX_ROWS];
+static uint32_t gpuDmaFill = 0;
+
+static volatile bool gpuDmaBusy = false;
+
+/* an MPU region's base and attribute (RASR on the RP2040, RLAR on the RP2350) words */
+typedef struct
+{
+  uint32_t rbar;
+  uint32_t attr;
+} GuardRegion;
+
+/*
+ * the MPU region over [lo, end) with the given access. false if it would
+ * take in memory outside [vramLo, vramEnd). RP2040 regions are a power of
+ * two in size, aligned to it, and switched on an eighth at a time
+ */
+static bool guardRegion(uint32_t lo, uint32_t end, uint32_t access, uint32_t vramLo, uint32_t vramEnd, GuardRegion *region)
+{
+#if PICO_RP2040 // Old memory protection unit
+  uint32_t sizeBits = 8; // 256 bytes, the smallest with subregions
+  while (end - (lo & ~((1u << sizeBits) - 1)) > (1u << sizeBits))
+    ++sizeBits;
+
+  uint32_t base = lo & ~((1u << sizeBits) - 1);
+  uint32_t subSize = 1u << (sizeBits - 3);
+  uint32_t first = (lo - base) / subSize;
+  uint32_t last = (end - 1 - base) / subSize;
+  if (base + first * subSize < vramLo || base + (last + 1) * subSize > vramEnd)
+    return false;
+
+  uint32_t disabled = ~((0xffu << first) & (0xffu >> (7 - last))) & 0xff;
+  region->rbar = base;
+  region->attr = M0PLUS_MPU_RASR_ENABLE_BITS | ((sizeBits - 1) << M0PLUS_MPU_RASR_SIZE_LSB) |
+                 (disabled << M0PLUS_MPU_RASR_SRD_LSB) | (access << 24) | 0x10000000; // AP, XN
+#else
+  uint32_t base = lo & ~31u;
+  uint32_t limit = (end - 1) & ~31u;
+  if (base < vramLo || limit + 32 > vramEnd)
+    return false;
+
+  region->rbar = base | (access << M33_MPU_RBAR_AP_LSB) | M33_MPU_RBAR_XN_BITS;
+  region->attr = limit | M33_MPU_RLAR_EN_BITS;
+#endif
+  return true;
+}
+
+/*
+ * load an MPU region ({0, 0} disables it)
+ */
+static void setGuardRegion(uint32_t number, const GuardRegion *region)
+{
+#if PICO_RP2040 // Old memory protection unit
+  mpu_hw->rbar = region->rbar | M0PLUS_MPU_RBAR_VALID_BITS | number;
+  mpu_hw->rasr = region->attr;
+#else
+  mpu_hw->rnr = number;
+  mpu_hw->rbar = region->rbar;
+  mpu_hw->rlar = region->attr;
+#endif
+}
+
+/*
+ * guard a job's source and destination, given as VRAM offsets [min, end).
+ * false if the MPU can't do that without taking in memory outside the VRAM
+ */
+static bool guardGpuDma(int32_t srcMin, int32_t srcEnd, int32_t dstMin, int32_t dstEnd)
+{
+  uint32_t vram = (uint32_t)(uintptr_t)tms9918->vram.bytes;
+  GuardRegion src, dst;
+  if (!guardRegion(vram + srcMin, vram + srcEnd, GUARD_READ_ONLY, vram, vram + 0x10000, &src) ||
+      !guardRegion(vram + dstMin, vram + dstEnd, GUARD_NO_ACCESS, vram, vram + 0x10000, &dst))
+    return false;
+
+  setGuardRegion(GPU_DMA_SRC_REGION, &src);
+  setGuardRegion(GPU_DMA_DST_REGION, &dst);
+#if !PICO_RP2040
+  // the v8-M MPU has no permission that stops privileged reads, but any
+  // access to an address in more than one region faults
+  setGuardRegion(GPU_DMA_DST_REGION + 1, &dst);
+#endif
+  __dsb();
+  __isb();
+  return true;
+}
+
+/*
+ * drop the MPU guard of a job that has completed
+ */
+void unguardGpuDma()
+{
+  const GuardRegion off = { 0, 0 };
+  setGuardRegion(GPU_DMA_SRC_REGION, &off);
+  setGuardRegion(GPU_DMA_DST_REGION, &off);
+#if !PICO_RP2040
+  setGuardRegion(GPU_DMA_DST_REGION + 1, &off);
+#endif
+  __dsb();
+  __isb();
+}
+
+/*
+ * gpu dma job complete
+ */
+static void gpuDmaIrqHandler()
+{
+  if (!dma_irqn_get_channel_status(GPU_DMA_IRQ_INDEX, gpuDmaChan))
+    return;
+  dma_irqn_acknowledge_channel(GPU_DMA_IRQ_INDEX, gpuDmaChan);
+
+  unguardGpuDma();
+
+  // the GPU can't have stored to >8008 since the job started (that waits
+  // for it), so clearing it can't lose a new trigger
+  uint32_t mpuCtrl = mpu_hw->ctrl; // the GPU may be running with >8000 guarded
+  mpu_hw->ctrl = 0;
+  __dsb();
+  __isb();
+  *(uint16_t*)(tms9918->vram.bytes + GPU_DMA_STATUS) = 0;
+  mpu_hw->ctrl = mpuCtrl;
+
+  gpuDmaBusy = false;
+}
+
+/*
+ * is a job running?
+ */
+bool gpuDmaRunning()
+{
+  return gpuDmaBusy;
+}
+
+/*
+ * wait for a running gpu dma job
+ */
+void waitGpuDma()
+{
+  while (gpuDmaBusy)
+    tight_loop_contents();
+}
+
+/*
+ * start a gpu dma job on the dma hardware. each row is a control block.
+ * returns false if the result depends on the byte order the cpu loop uses
+ */
+static bool startGpuDma(uint32_t src, uint32_t dst, uint32_t width, uint32_t height, uint32_t stride, uint32_t params)
+{
+  if (width == 0 || height == 0)
+    return false;
+
+  bool fill = params & 0x01;
+  bool reverse = params & 0x02;
+
+  // rows in job order, each transferred upward from its lowest address
+  int32_t rowStep = reverse ? -(int32_t)stride : (int32_t)stride;
+  int32_t dstLo = (int32_t)dst - (reverse ? (int32_t)width - 1 : 0);
+  int32_t srcLo = (int32_t)src - (reverse && !fill ? (int32_t)width - 1 : 0);
+  int32_t rowsSpan = (int32_t)(height - 1) * rowStep;
+
+  int32_t dstMin = dstLo + (rowsSpan < 0 ? rowsSpan : 0);
+  int32_t dstEnd = dstLo + (rowsSpan > 0 ? rowsSpan : 0) + (int32_t)width;
+  int32_t srcMin = fill ? (int32_t)src : srcLo + (rowsSpan < 0 ? rowsSpan : 0);
+  int32_t srcEnd = fill ? (int32_t)src + 1 : srcLo + (rowsSpan > 0 ? rowsSpan : 0) + (int32_t)width;
+
+  if (dstMin < 0 || dstEnd > 0x10000 || srcMin < 0 || srcEnd > 0x10000)
+    return false;
+
+  if (!fill)
+  {
+    if (height > 1 && stride < width) // rows overlap each other
+      return false;
+
+    // overlapping copies are only order independent moving forward to a lower address
+    if (dstMin < srcEnd && srcMin < dstEnd && (reverse || dst > src))
+      return false;
+  }
+
+  bool words = ((dstLo | width | (height > 1 ? stride : 0) | (fill ? 0 : srcLo)) & 3) == 0;
+
+  uint8_t *vram = tms9918->vram.bytes;
+  gpuDmaFill = vram[src] * 0x01010101u;
+
+  dma_channel_config cfg = dma_channel_get_default_config(gpuDmaChan);
+  channel_config_set_transfer_data_size(&cfg, words ? DMA_SIZE_32 : DMA_SIZE_8);
+  channel_config_set_read_increment(&cfg, !fill);
+  channel_config_set_write_increment(&cfg, true);
+  channel_config_set_chain_to(&cfg, gpuDmaCtrlChan);
+  channel_config_set_irq_quiet(&cfg, true);
+  uint32_t rowCtrl = channel_config_get_ctrl_value(&cfg);
+
+  channel_config_set_chain_to(&cfg, gpuDmaChan); // last row ends the chain
+  channel_config_set_irq_quiet(&cfg, false);
+  uint32_t lastCtrl = channel_config_get_ctrl_value(&cfg);
+
+  for (uint32_t y = 0; y < height; ++y)
+  {
+    GpuDmaBlock *block = &gpuDmaBlocks[y];
+    block->read = fill ? (words ? (void*)&gpuDmaFill : vram + src) : vram + srcLo + (int32_t)y * rowStep;
+    block->write = vram + dstLo + (int32_t)y * rowStep;
+    block->count = words ? width / 4 : width;
+    block->ctrl = (y == height - 1) ? lastCtrl : rowCtrl;
+  }
+
+  bool guarded = guardGpuDma(srcMin, srcEnd, dstMin, dstEnd);
+
+  gpuDmaBusy = true;
+  dma_channel_set_read_addr(gpuDmaCtrlChan, gpuDmaBlocks, true);
+
+  if (!guarded) // the GPU can't be kept off it, so it waits
+    waitGpuDma();
+  return true;
+}
+
+/*
+ * claim and set up the gpu dma channels and irq (core 0). the other dma
+ * users claim theirs first
+ */
+void initGpuDma()
+{
+  gpuDmaChan = dma_claim_unused_channel(true);
+  gpuDmaCtrlChan = dma_claim_unused_channel(true);
+
+  dma_channel_config cfg = dma_channel_get_default_config(gpuDmaCtrlChan);
+  channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+  channel_config_set_read_increment(&cfg, true);
+  channel_config_set_write_increment(&cfg, true);
+  channel_config_set_ring(&cfg, true, 4); // wrap over the row channel's 4 registers
+  dma_channel_configure(gpuDmaCtrlChan, &cfg, &dma_hw->ch[gpuDmaChan].read_addr, gpuDmaBlocks, 4, false);
+
+  dma_irqn_set_channel_enabled(GPU_DMA_IRQ_INDEX, gpuDmaChan, true);
+  irq_add_shared_handler(dma_get_irq_num(GPU_DMA_IRQ_INDEX), gpuDmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(dma_get_irq_num(GPU_DMA_IRQ_INDEX), true);
+}
+
+/*
+ * run a gpu dma job. on the dma hardware >8008 stays non-zero until it
+ * completes and the gpu carries on meanwhile
+ */
+void triggerGpuDma()
+{
+  uint32_t srcVramAddr = __builtin_bswap16(*(uint16_t*)(tms9918->vram.bytes + 0x8000));
+  uint32_t dstVramAddr = __builtin_bswap16(*(uint16_t*)(tms9918->vram.bytes + 0x8002));
+  uint32_t width = tms9918->vram.bytes[0x8004];
+  uint32_t height = tms9918->vram.bytes[0x8005];
+  uint32_t stride = tms9918->vram.bytes[0x8006];
+  uint32_t params = tms9918->vram.bytes[0x8007];
+
+  if (startGpuDma(srcVramAddr, dstVramAddr, width, height, stride, params))
+    return;
+
+  int32_t dstInc = params & 0x02 ? -1 : 1;
+  int32_t srcInc = params & 0x01 ? 0 : dstInc;
+
+  uint8_t *srcPtr = tms9918->vram.bytes + srcVramAddr;
+  uint8_t *dstPtr = tms9918->vram.bytes + dstVramAddr;
+  for (uint32_t y = 0; y < height; ++y)
+  {
+    for (uint32_t x = 0; x < width; ++x, srcPtr += srcInc, dstPtr += dstInc)
+      *dstPtr = *srcPtr;
+    srcPtr += ((int32_t)stride - (int32_t)width) * srcInc;
+    dstPtr += ((int32_t)stride - (int32_t)width) * dstInc;
+  }
+
+  *(uint16_t*)(tms9918->vram.bytes + GPU_DMA_STATUS) = 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * Project: pico9918 - gpu
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ * Purpose: TMS9900 GPU dma jobs
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * the GPU's dma (>8000-8009) on the dma hardware
+ *
+ * a job runs while the GPU carries on. >8008 reads non-zero until it
+ * completes, and meanwhile the MPU guards the job's source (read only) and
+ * destination (no access) in the VRAM. a GPU access there faults: gpu.c's
+ * hardfault handler then has the GPU wait for the job (waitGpuDma()) and
+ * drop the guard (unguardGpuDma()) before it retries the access
+ */
+
+/* claim and set up the dma channels and irq (core 0) */
+void initGpuDma();
+
+/* run the job set up in >8000-8007 (on the dma hardware, or the cpu) */
+void triggerGpuDma();
+
+/* is a job running? */
+bool gpuDmaRunning();
+
+/* wait for a running job */
+void waitGpuDma();
+
+/* drop the MPU guard of a job that has completed */
+void unguardGpuDma();
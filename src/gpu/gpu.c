@@ -12,8 +12,11 @@
  */
 
 #include "gpu.h"
+#include "gpu-dma.h"
 #include "pico/stdlib.h"
 #include "hardware/structs/mpu.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
 #include <hardware/flash.h>
 #include "pico.h" // For PICO_RP2040
 
@@ -21,6 +24,11 @@
 
 #include "../flash.h"
 #include "../config.h"
+#include "../display.h"
+
+#if PICO9918_GPU_PROFILE
+#include "hardware/timer.h"
+#endif
 
 
 /* run9900() implemented in Thumb9900.S */
@@ -62,44 +70,207 @@ static uint8_t preload [] = {
 };
 
 
+#if PICO9918_GPU_PROFILE
+
+#define GPU_PROFILE_PERIOD_US     100     // 10kHz sampling
+#define GPU_PROFILE_BUCKET_SHIFT  3       // 8 bytes (4 words) per histogram bucket
+#define GPU_PROFILE_BUCKETS       (0x10000 >> GPU_PROFILE_BUCKET_SHIFT)
+#define GPU_PROFILE_OPCODES       2048    // instruction >> 5, as dispatched by run9900
+
+#define GPU_PROFILE_WINDOW        0x3C00  // VRAM window a dump page is copied to
+#define GPU_PROFILE_PAGE_BYTES    0x400
+#define GPU_PROFILE_HIST_PAGES    (sizeof(profileHist) / GPU_PROFILE_PAGE_BYTES)
+#define GPU_PROFILE_PAGES         (GPU_PROFILE_HIST_PAGES + sizeof(gpuOpCounts) / GPU_PROFILE_PAGE_BYTES)
+
+#define GPU_PROFILE_CMD_DUMP      0x80
+#define GPU_PROFILE_CMD_RESET     0x40
+#define GPU_PROFILE_CMD_PAGE_MASK 0x1f
+
+/* interpreter bounds from thumb9900_*.S. R3 holds the 9900 PC from gpuProfPcValid on,
+ * except after the first instruction of the PIX BL code (gpuProfXop) where it's in R10 */
+extern const uint8_t gpuProfBegin[], gpuProfPcValid[], gpuProfEnd[];
+extern const uint8_t gpuProfXop[], gpuProfXopEnd[];
+
+/* per-opcode counters, incremented by run9900 */
+uint32_t gpuOpCounts[GPU_PROFILE_OPCODES];
+
+static uint16_t profileHist[GPU_PROFILE_BUCKETS];
+static uint profileAlarm;
+
+/*
+ * profiler timer sample. frame is the hardware stacked r0-r3, r12, lr, pc, xpsr.
+ * r10 isn't stacked, so the irq passes it through as it was in thread mode
+ *
+ * the interpreter advances the 9900 PC past the instruction word as it fetches
+ * it, so 2 is taken off to get the instruction's address. operand words move it
+ * on by up to 4 more, so a sample can still land in the following bucket
+ */
+static void __attribute__((used)) profileSample(const uint32_t *frame, uint32_t excReturn, uint32_t r10)
+{
+  timer_hw->intr = 1u << profileAlarm;
+  timer_hw->alarm[profileAlarm] = timer_hw->timerawl + GPU_PROFILE_PERIOD_US;
+
+  if ((excReturn & 0x0c) != 0x08) // only sample thread mode (main stack)
+    return;
+
+  uintptr_t pc = frame[6];
+  if (pc < ((uintptr_t)gpuProfBegin & ~1u) || pc >= ((uintptr_t)gpuProfEnd & ~1u))
+    return;
+  if (pc >= ((uintptr_t)run9900 & ~1u) && pc < ((uintptr_t)gpuProfPcValid & ~1u))
+    return;
+
+  uint32_t gpuPc = frame[3];
+  if (pc > ((uintptr_t)gpuProfXop & ~1u) && pc < ((uintptr_t)gpuProfXopEnd & ~1u))
+    gpuPc = r10;
+
+  uint16_t *bucket = &profileHist[((gpuPc - 2) & 0xffff) >> GPU_PROFILE_BUCKET_SHIFT];
+  if (*bucket != 0xffff) ++*bucket;
+}
+
+/*
+ * profiler timer irq. hands the exception frame to profileSample
+ */
+static void __attribute__((naked)) profileIrqHandler()
+{
+  __asm volatile (
+    "mrs  r0, msp\n"
+    "mov  r1, lr\n"
+    "mov  r2, r10\n"
+    "push {r0, lr}\n"
+    "bl   profileSample\n"
+    "pop  {r0, pc}\n");
+}
+
+/*
+ * start sampling the 9900 PC (core 0)
+ */
+static void profileInit()
+{
+  profileAlarm = hardware_alarm_claim_unused(true);
+  uint irq = hardware_alarm_get_irq_num(profileAlarm);
+  irq_set_exclusive_handler(irq, profileIrqHandler);
+  irq_set_priority(irq, PICO_LOWEST_IRQ_PRIORITY);
+  hw_set_bits(&timer_hw->inte, 1u << profileAlarm);
+  irq_set_enabled(irq, true);
+  timer_hw->alarm[profileAlarm] = timer_hw->timerawl + GPU_PROFILE_PERIOD_US;
+}
+
+/*
+ * handle a CONF_GPU_PROFILE command. a dump copies one 1KB page to the VRAM
+ * window (big endian): pages 0-15 are the 16-bit PC histogram, pages 16-23
+ * the 32-bit opcode counters. reset happens after any dump
+ */
+static void profileCommand(uint8_t cmd)
+{
+  if (cmd & GPU_PROFILE_CMD_DUMP)
+  {
+    uint32_t page = cmd & GPU_PROFILE_CMD_PAGE_MASK;
+    uint8_t *dst = tms9918->vram.bytes + GPU_PROFILE_WINDOW;
+
+    if (page < GPU_PROFILE_HIST_PAGES)
+    {
+      const uint16_t *src = profileHist + page * (GPU_PROFILE_PAGE_BYTES / 2);
+      for (int i = 0; i < GPU_PROFILE_PAGE_BYTES / 2; ++i, dst += 2)
+        *(uint16_t*)dst = __builtin_bswap16(src[i]);
+    }
+    else if (page < GPU_PROFILE_PAGES)
+    {
+      const uint32_t *src = gpuOpCounts + (page - GPU_PROFILE_HIST_PAGES) * (GPU_PROFILE_PAGE_BYTES / 4);
+      for (int i = 0; i < GPU_PROFILE_PAGE_BYTES / 4; ++i, dst += 4)
+        *(uint32_t*)dst = __builtin_bswap32(src[i]);
+    }
+    else
+    {
+      memset(dst, 0, GPU_PROFILE_PAGE_BYTES);
+    }
+  }
+
+  if (cmd & GPU_PROFILE_CMD_RESET)
+  {
+    memset(profileHist, 0, sizeof(profileHist));
+    memset(gpuOpCounts, 0, sizeof(gpuOpCounts));
+  }
+}
+
+#endif
+
+
 static int didFault = 0;
+static uint32_t dmaFaultPc = 0;  // where the GPU touched a running dma job
+
+#define XPSR_IT_BITS 0x0600fc00u  // IT/ICI state of the stacked xPSR
 
 /*
- * hardfault handler (triggered by MPU for GPU DMA requests)
+ * the GPU touched a running dma job's source or destination (or the >8000
+ * page). in thread mode, by way of dmaFaultTrampoline: wait for the job and
+ * drop its guard. returns the faulting address for the retry
  */
-void isr_hardfault ()
+static uint32_t __attribute__((used)) dmaFaultWait()
 {
-  didFault = 1;
-  TMS_REGISTER(tms9918, 0x38) = 0; // Stop the GPU
-  mpu_hw->ctrl = 0; // Turn off memory protection - all models
+  waitGpuDma();
+  unguardGpuDma();
+  return dmaFaultPc;
 }
 
 /*
- * run a gpu dma job
+ * resume point for a GPU access to a running dma job. saves what the
+ * interrupted code may hold (r0-r3, r12, lr, flags), waits, then retries
+ * the access. the retry faults again if it's to the >8000 page
  */
-static void triggerGpuDma()
+static void __attribute__((naked, used)) dmaFaultTrampoline()
 {
-  uint32_t srcVramAddr = __builtin_bswap16(*(uint16_t*)(tms9918->vram.bytes + 0x8000));
-  uint32_t dstVramAddr = __builtin_bswap16(*(uint16_t*)(tms9918->vram.bytes + 0x8002));
-  uint32_t width = tms9918->vram.bytes[0x8004];
-  uint32_t height = tms9918->vram.bytes[0x8005];
-  uint32_t stride = tms9918->vram.bytes[0x8006];
-  uint32_t params = tms9918->vram.bytes[0x8007];
-
-  int32_t dstInc = params & 0x02 ? -1 : 1;
-  int32_t srcInc = params & 0x01 ? 0 : dstInc;
-
-  uint8_t *srcPtr = tms9918->vram.bytes + srcVramAddr;
-  uint8_t *dstPtr = tms9918->vram.bytes + dstVramAddr;
-  for (int y = 0; y < height; ++y)
+  __asm volatile (
+    "push {r0}\n"              // return address, filled in below
+    "push {r0-r3, lr}\n"
+    "mov  r0, r12\n"
+    "mrs  r1, apsr\n"
+    "push {r0, r1}\n"
+    "bl   dmaFaultWait\n"
+    "str  r0, [sp, #28]\n"
+    "pop  {r0, r1}\n"
+    "mov  r12, r0\n"
+    "msr  apsr_nzcvq, r1\n"
+    "ldr  r0, [sp, #16]\n"
+    "mov  lr, r0\n"
+    "pop  {r0-r3}\n"
+    "add  sp, #4\n"
+    "pop  {pc}\n");
+}
+
+/*
+ * hardfault (triggered by the MPU for GPU dma requests, and for GPU
+ * accesses to a running dma job). frame is the hardware stacked r0-r3,
+ * r12, lr, pc, xpsr
+ */
+static void __attribute__((used)) hardFault(uint32_t *frame, uint32_t excReturn)
+{
+  // a dma job is running: the GPU (core 0, thread mode) resumes in the
+  // trampoline. run9900 has no IT blocks, so there's no IT state to carry
+  // over. anything else, core 1 included, takes the path below
+  if (get_core_num() == 0 && gpuDmaRunning() && (excReturn & 0x0c) == 0x08)
   {
-    for (int x = 0; x < width; ++x, srcPtr += srcInc, dstPtr += dstInc)
-      *dstPtr = *srcPtr;
-    srcPtr += (stride - width) * srcInc;
-    dstPtr += (stride - width) * dstInc;
+    dmaFaultPc = frame[6] | 1;
+    frame[6] = (uint32_t)dmaFaultTrampoline & ~1u;
+    frame[7] &= ~XPSR_IT_BITS;
+    return;
   }
 
-  *(uint16_t*)(tms9918->vram.bytes + 0x8008) = 0;
+  didFault = 1;
+  TMS_REGISTER(tms9918, 0x38) = 0; // Stop the GPU
+  mpu_hw->ctrl = 0; // Turn off memory protection - all models
+}
+
+/*
+ * hardfault handler. hands the exception frame to hardFault
+ */
+void __attribute__((naked)) isr_hardfault()
+{
+  __asm volatile (
+    "mrs  r0, msp\n"
+    "mov  r1, lr\n"
+    "push {r0, lr}\n"
+    "bl   hardFault\n"
+    "pop  {r0, pc}\n");
 }
 
 
@@ -146,6 +317,7 @@ restart:
       tms9918->gpuAddress = lastAddress;
       tms9918->restart = 0;
     }
+    waitGpuDma(); // let a running job settle >8008 first
     if (tms9918->vram.bytes[0x8008])
     {
       triggerGpuDma();
@@ -172,6 +344,12 @@ void gpuInit()
   tms9918->gpuAddress = 0x4000;
 
   guard(&(tms9918->vram.bytes [0x8000]));
+
+  initGpuDma();
+
+#if PICO9918_GPU_PROFILE
+  profileInit();
+#endif
 }
 
 bool reportedBack = 1;
@@ -193,7 +371,10 @@ void resetGpuTime()
 
 
 /*
- * TMS9900 GPU main loop 
+ * TMS9900 GPU main loop. sleeps between requests: core 1 signals an event
+ * for a trigger or a register write (flash and config commands), and any
+ * core 0 interrupt (every scanline) also wakes it. idle, it reads its
+ * request flags once per wake rather than continuously
  */
 void gpuLoop()
 {
@@ -213,10 +394,23 @@ void gpuLoop()
       flashSector();
     }
 
+#if PICO9918_GPU_PROFILE
+    if (tms9918->config[CONF_GPU_PROFILE])
+    {
+      profileCommand(tms9918->config[CONF_GPU_PROFILE]);
+      tms9918->config[CONF_GPU_PROFILE] = 0;
+    }
+#endif
+
     if (tms9918->config[CONF_SAVE_TO_FLASH])
     {
       tms9918->config[CONF_SAVE_TO_FLASH] = 0;
       saveConfigSplitPending(tms9918->config);
+
+      // switch to the new display settings now rather than on a power cycle,
+      // unless they need another system clock. those wait for the power cycle
+      if (displayModeSwitchable(tms9918->config))
+        armPendingDisplay(tms9918->config);
     }
 
     // factory reset: write everything to main, skip the pending split
@@ -244,5 +438,7 @@ void gpuLoop()
       erasePendingDisplay();
       tms9918->config[CONF_PENDING_STATE] = PENDING_STATE_CONFIRMED;
     }
+
+    __wfe();
   }
 }
\ No newline at end of file
@@ -15,6 +15,8 @@
 
 #include "impl/vrEmuTms9918Priv.h"
 
+#include "hardware/sync.h"
+
 /* initialize the TMS9900 GPU */
 void gpuInit();
 
@@ -25,6 +27,8 @@ void gpuLoop();
 inline void gpuTrigger()
 {
   tms9918->restart = 1;
+  __dmb(); // the flag visible before the event (the M33's store buffer)
+  __sev(); // wake gpuLoop()
 }
 
 /* GPU runtime in microseconds */
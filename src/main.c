@@ -10,6 +10,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "vga.h"
 #include "vga-modes.h"
 
@@ -32,6 +33,7 @@
 #include "gpio.h"
 #include "gpu.h"
 #include "config.h"
+#include "convert.h"
 #include "splash.h"
 #include "temperature.h"
 
@@ -91,15 +93,49 @@ static bool validWrites = false;  // has the VDP display been enabled at all?
 static bool doneInt = false;      // interrupt raised this frame?
 
 static int vPixels = 192;         // active TMS display lines (updated each frame)
+static int displayYScale = 2;     // display lines per TMS line (set by the output mode)
+static bool displayRows30 = true; // the output mode has lines for row 30 mode
 static uint32_t vBorder = 0;      // top border offset in VGA lines (updated each frame)
 
+// bg value currently held in each line buffer's side borders, or
+// NO_SIDE_BORDER when overlays (splash, banner, diagnostics) may have drawn there
+#define NO_SIDE_BORDER 0xffffffff
+static uint32_t sideBorder[2] = {NO_SIDE_BORDER, NO_SIDE_BORDER};
+
 static bool droppedFrames[16] = {0};
 int droppedFramesCount = 0;
 
 #define R0_DOUBLE_ROWS 0x08
+#define R1_DISP_ACTIVE 0x40
 
 static const uint32_t dma32 = 2;  // memset 32bit
 
+#if PICO_RP2350 && PICO9918_FRAME_BUFFER
+/*
+ * full-frame buffers (RP2350, PICO9918_FRAME_BUFFER builds) for
+ * CONF_VDP_RATE != display rate. ~184KB, so opt-in.
+ * the vdp raster is emulated at its own rate (tmsEmuIdle) into one buffer
+ * while the display scans out another, repeating or dropping whole frames.
+ * three buffers: one scanning out, one ready, one being drawn
+ */
+#define FRAME_BUFFER_COUNT 3
+#define FRAME_BUFFER_LINES 240
+static uint8_t __aligned(4) frameBuffer[FRAME_BUFFER_COUNT][FRAME_BUFFER_LINES * TMS9918_PIXELS_X + 8];
+static uint8_t fbScanout = 0;     // buffer the display is reading
+static uint8_t fbReady = 0;       // most recently completed vdp frame
+static uint8_t fbDraw = 1;        // buffer the emulated raster is drawing
+
+static uint32_t emuFrameUs = 0;   // emulated frame period. 0 = display drives the vdp
+static uint32_t emuTotalLines = 0;
+static uint32_t emuFrameStart = 0;
+static uint32_t emuLine = 0;
+
+#define frameBufferMode() (emuFrameUs != 0)
+#define frameBufferLine(fb, y) (frameBuffer[fb] + (y) * TMS9918_PIXELS_X)
+#else
+#define frameBufferMode() false
+#endif
+
 /*
  * drive the /INT pin to match currentInt. Default is active-low; define
  * PICO9918_INT_ACTIVE_HIGH (via pico9918_config.cmake) to drive active-high.
@@ -188,6 +224,8 @@ void __not_in_flash_func(tmsWriteIrqHandler)()
   if (writeVal & 0x01) // write reg/addr
   {
     vrEmuTms9918WriteAddrImpl(dataVal);
+    __dmb(); // its flags visible before the event
+    __sev(); // may be a gpu flash or config command. wake gpuLoop()
     
     bool newInt = vrEmuTms9918InterruptStatusImpl();
     if (newInt != currentInt)
@@ -260,38 +298,7 @@ void __not_in_flash_func(gpioIrqHandler)()
   enableTmsPioInterrupts();
 }
 
-typedef struct
-{
-  int pll;
-  int pllDiv1;
-  int pllDiv2;
-  int voltage;
-  int clockHz;
-} ClockSettings;
-
-#define CLOCK_PRESET(PLL,PD1,PD2,VOL) {PLL, PD1, PD2, VOL, PLL / PD1 / PD2}
-
-#if PICO9918_ENABLE_SCART
-// SCART: clocks must be multiples of 54 MHz for exact integer pioClocksPerPixel
-// (pioFreq must be a multiple of 13.5 MHz, minimum 54 MHz)
-// 270/5=54MHz(4), 324/6=54MHz(4) clocks per pixel
-static const ClockSettings scartClockPresets[] = {
-  CLOCK_PRESET(1080000000, 4, 1, VREG_VOLTAGE_1_15),    // 270 MHz
-  CLOCK_PRESET(1296000000, 4, 1, VREG_VOLTAGE_1_20),    // 324 MHz
-  CLOCK_PRESET(1296000000, 4, 1, VREG_VOLTAGE_1_20)     // 324 MHz (no safe higher option)
-};
-#endif
-
-// VGA: clocks for 25.175 MHz pixel clock
-static const ClockSettings vgaClockPresets[] = {
-  CLOCK_PRESET(1512000000, 6, 1, VREG_VOLTAGE_1_15),    // 252 MHz
-  CLOCK_PRESET(1512000000, 5, 1, VREG_VOLTAGE_1_20),    // 302.4 MHz
-  CLOCK_PRESET(1056000000, 3, 1, VREG_VOLTAGE_1_30)     // 352 MHz
-};
-
-static const ClockSettings *clockPresets = vgaClockPresets;
-
-static int clockPresetIndex = 0;
+static DisplayClock currentClock;  // the system clock actually applied (preset or planned)
 
 typedef struct
 {
@@ -306,6 +313,8 @@ static const VdpClockConfig vdpClockConfigs[] = {
   { TMS_CPUCLK_FREQ_HZ,  TMS_CLK_OFF         },  // VDP_TMS912x:  CPUCLK freq on pin 37
 };
 
+static void switchDisplayMode(void);
+
 static void eofInterrupt()
 {
   doneInt = true;
@@ -375,10 +384,10 @@ inline uint32_t bigRgb2LittleBgr(uint32_t val)
 #ifndef PICO9918_NO_CLOCKS
 void updateClock(uint pioSm, float freqHz)
 {
-  float clockDiv = ((float)clockPresets[clockPresetIndex].clockHz) / (freqHz * 2.0f);
+  float clockDiv = ((float)currentClock.sysClockKHz * 1000.0f) / (freqHz * 2.0f);
   pio_sm_set_clkdiv(CLOCK_PIO, pioSm, clockDiv);
   pio_sm_set_enabled(CLOCK_PIO, pioSm, true);
-  diagSetClockHz(clockPresets[clockPresetIndex].clockHz);
+  diagSetClockHz(currentClock.sysClockKHz * 1000.0f);
 }
 
 /*
@@ -445,7 +454,10 @@ static void tmsEndOfScanline(uint32_t displayLine)
 
 static void tmsEndOfFrame(uint32_t frameNumber)
 {
-  ++frameCount;
+  if (++frameCount == 1)
+  {
+    diagBootPhase(DIAG_BOOT_FRAME);
+  }
 #if PICO9918_GPU_FRAME_COUNTER
   gpuFrameCount += (TMS_STATUS(tms9918, 2) & 0x80) != 0;
 #endif
@@ -466,7 +478,7 @@ static void tmsEndOfFrame(uint32_t frameNumber)
   if (!validWrites)
   {
     // has the display been enabled?
-    if (validWrites = (TMS_REGISTER(tms9918, 1) & 0x40))
+    if (validWrites = (TMS_REGISTER(tms9918, 1) & R1_DISP_ACTIVE))
     {
       allowSplashHide();
       if (frameCount > SHOW_DIAGNOSTICS_FRAMES)
@@ -483,29 +495,33 @@ static void tmsEndOfFrame(uint32_t frameNumber)
 
   // here, we catch the case where the last row(s) were
   // missed and we never raised an interrupt. do it now  
-  if (!doneInt)
+  if (!doneInt && !frameBufferMode())
   {
     eofInterrupt();
     updateInterrupts(STATUS_INT);
   }
 
-#if PICO9918_ENABLE_SCART
-  const int yScale = vgaCurrentParams()->params.interlaced ? 1 : 2;
-#else
-  const int yScale = DISPLAY_YSCALE;
-#endif
+  // a saved display change is switched to now. unless confirmed, the next
+  // boot reverts it
+  if (takeDisplaySwitchRequest())
+    switchDisplayMode();
+
+  const int yScale = displayYScale;
+
+  // the frame buffer holds single rows only
+  const bool doubleRows = !frameBufferMode() && (TMS_REGISTER(tms9918, 0) & R0_DOUBLE_ROWS);
 
   if (yScale > 1) {
-    bool doubleRows = TMS_REGISTER(tms9918, 0) & R0_DOUBLE_ROWS;
-    vgaCurrentParams()->params.vPixelScale = yScale - (bool)doubleRows;
+    vgaCurrentParams()->params.vPixelScale = yScale >> (bool)doubleRows;
     vgaCurrentParams()->params.vVirtualPixels = (vgaCurrentParams()->params.vSyncParams.displayPixels / yScale) << (bool)doubleRows;
   }
 
-  int baseRows = (TMS_REGISTER(tms9918, 0x31) & 0x40) ? 30 : 24;
+  int baseRows = (displayRows30 && (TMS_REGISTER(tms9918, 0x31) & 0x40)) ? 30 : 24;
   vPixels = baseRows << 3;
-  if (yScale > 1 && (TMS_REGISTER(tms9918, 0) & R0_DOUBLE_ROWS))
+  if (yScale > 1 && doubleRows)
     vPixels <<= 1;
-  vBorder = (vgaCurrentParams()->params.vVirtualPixels - vPixels) / 2;
+  // modes with fewer virtual lines than the vdp lose the bottom rows
+  vBorder = ((int)vgaCurrentParams()->params.vVirtualPixels > vPixels) ? (vgaCurrentParams()->params.vVirtualPixels - vPixels) / 2 : 0;
   vgaSetTriggerScanline(vBorder + vPixels);
 }
 
@@ -528,7 +544,6 @@ uint32_t __aligned(4) pram [256];
 static __attribute__((noinline))  void generateRgbCache()
 {
   /* convert from  palette to bgr12 */
-  uint32_t data;
   tms9918->palDirty = 0;
 
 #if PALCONV
@@ -538,35 +553,166 @@ static __attribute__((noinline))  void generateRgbCache()
   const bool pixelsDoubled = vrEmuTms9918DisplayMode(tms9918) != TMS_MODE_TEXT80;
   if (pixelsDoubled)
   {
-    for (int i = 0; i < 64; i += 8)
+    expandPalette(tms9918->vram.map.pram, pram, 64);
+  }
+  else // 80-col mode doesn't have doubled pixels
+  {
+    expandPalettePairs(tms9918->vram.map.pram, pram);
+  }
+#endif
+}
+
+/*
+ * status, interrupt and GPU trigger updates for an active display line
+ */
+static inline void activeLineStatus(uint8_t tempStatus)
+{
+  /*** F18A status register updates ***/
+  TMS_STATUS(tms9918, 0x01) &= ~0x03;
+
+  if (tms9918->vram.map.scanline && (TMS_REGISTER(tms9918, 0x13) == tms9918->vram.map.scanline))
+  {
+    TMS_STATUS(tms9918, 0x01) |= 0x01;
+    tempStatus |= STATUS_INT;
+  }
+
+  if (TMS_REGISTER(tms9918, 0x32) & 0x40)
+  {
+    gpuTrigger();
+  }
+
+  updateInterrupts(tempStatus);
+}
+
+/*
+ * vdp state at the start of active display line y
+ */
+static inline void activeLineStart(uint32_t y)
+{
+  tms9918->vram.map.blanking = 0;
+  tms9918->vram.map.scanline = y;
+  TMS_STATUS(tms9918, 0x03) = y;
+}
+
+/*
+ * vdp state at the end of an active display line (into horizontal blanking)
+ */
+static inline void activeLineEnd(uint8_t tempStatus)
+{
+  activeLineStatus(tempStatus);
+  tms9918->vram.map.blanking = 1; // H
+}
+
+/*
+ * vdp state for border line y (a vga virtual line): vertical blanking,
+ * the line count below the display, the palette cache ahead of the first
+ * display line and the GPU trigger. in frame buffer mode the emulated
+ * raster owns the vdp state, so only the palette cache is kept
+ */
+static inline void borderLineState(uint32_t y)
+{
+  if (!frameBufferMode())
+  {
+    tms9918->vram.map.blanking = 1; // V
+    if (y >= vBorder + vPixels)
     {
-      data = tms9918->vram.map.pram [i + 0] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 0] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 1] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 1] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 2] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 2] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 3] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 3] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 4] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 4] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 5] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 5] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 6] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 6] = data * 0x10001;
-      data = tms9918->vram.map.pram [i + 7] & 0xFF0F; data = data | ((data >> 12) << 4); pram [i + 7] = data * 0x10001;
+      tms9918->vram.map.scanline = y - vBorder;
+      TMS_STATUS(tms9918, 0x03) = tms9918->vram.map.scanline;
     }
   }
-  else // 80-col mode doesn't have doubled pixels
+
+  if (y == vBorder - 1)
+  {
+    generateRgbCache();
+  }
+
+  if ((TMS_REGISTER(tms9918, 0x32) & 0x40) && !frameBufferMode())
+  {
+    gpuTrigger();
+  }
+}
+
+#if PICO_RP2350 && PICO9918_FRAME_BUFFER
+/*
+ * emulated vdp raster line y into the draw frame buffer (frame buffer mode)
+ */
+static void __time_critical_func(emuScanline)(uint32_t y)
+{
+  if (y == 0)
+  {
+    // anything but the buffers being scanned out or waiting to be
+    fbDraw = 0;
+    while (fbDraw == fbScanout || fbDraw == fbReady) ++fbDraw;
+    doneInt = false;
+  }
+
+  if (y < vPixels)
+  {
+    activeLineStart(y);
+
+    uint8_t *fbLine = frameBufferLine(fbDraw, y);
+    uint8_t tempStatus = 0;
+    if (TMS_REGISTER(tms9918, 1) & R1_DISP_ACTIVE)
+    {
+      tempStatus = vrEmuTms9918ScanLine(y, fbLine);
+    }
+    else
+    {
+      // 80-column lines hold pixel pairs
+      uint8_t bgIndex = vrEmuTms9918RegValue(TMS_REG_FG_BG_COLOR) & 0x0f;
+      if (vrEmuTms9918DisplayMode(tms9918) == TMS_MODE_TEXT80)
+        bgIndex *= 0x11;
+      memset(fbLine, bgIndex, TMS9918_PIXELS_X);
+    }
+
+    activeLineEnd(tempStatus);
+  }
+  else
   {
-    uint16_t tmpPal[16];
-    for (int i = 0; i < 16; ++i)
+    tms9918->vram.map.blanking = 1; // V
+    tms9918->vram.map.scanline = y < 255 ? y : 255;
+    TMS_STATUS(tms9918, 0x03) = tms9918->vram.map.scanline;
+
+    if (y == vPixels)
     {
-      data = tms9918->vram.map.pram [i] & 0xFF0F;
-      tmpPal[i] = data | ((data >> 12) << 4);
-      pram[i] = tmpPal[i] * 0x10001;
+      fbReady = fbDraw;
+      tmsEndOfScanline(y);
     }
-    for (int j = 16; j < 256; ++j)
+
+    if (TMS_REGISTER(tms9918, 0x32) & 0x40)
     {
-      pram[j] = (tmpPal[j & 0xf] << 16) | (tmpPal[j >> 4] & 0xffff);
+      gpuTrigger();
     }
   }
-#endif
 }
 
+/*
+ * run the emulated vdp raster when its next line is due (vgaLoop idle, runs on proc1)
+ */
+static void __time_critical_func(tmsEmuIdle)()
+{
+  const uint32_t now = time_us_32();
+
+  // fell too far behind (flash write, etc.)? start a fresh frame
+  if (now - emuFrameStart > emuFrameUs * 2)
+  {
+    emuFrameStart = now;
+    emuLine = 0;
+  }
+
+  if (now - emuFrameStart < (emuLine * emuFrameUs) / emuTotalLines)
+    return;
+
+  emuScanline(emuLine);
+
+  if (++emuLine == emuTotalLines)
+  {
+    emuLine = 0;
+    emuFrameStart += emuFrameUs;  // stays locked to the emulated rate
+  }
+}
+#endif
+
 /*
  * generate a single VGA scanline (called by vgaLoop(), runs on proc1)
  */
@@ -580,10 +726,17 @@ static void __time_critical_func(tmsScanline)(uint16_t y, VgaParams* params, uin
 
   uint32_t* dPixels = (uint32_t*)pixels;
   bg = pram[vrEmuTms9918RegValue(TMS_REG_FG_BG_COLOR) & 0x0f];
+  vgaSetBorderColor(bg);
+
+  const uint8_t buffer = vgaLineBufferIndex(pixels);
 
   if (y == 0)
   {
-    doneInt = false;
+#if PICO_RP2350 && PICO9918_FRAME_BUFFER
+    fbScanout = fbReady;
+#endif
+    if (!frameBufferMode())
+      doneInt = false;
   }
 
   dma_channel_wait_for_finish_blocking(dma32);
@@ -591,16 +744,24 @@ static void __time_critical_func(tmsScanline)(uint16_t y, VgaParams* params, uin
   /*** top and bottom borders ***/
   if (y < vBorder || y >= (vBorder + vPixels))  // TODO: None of this runs in ROW30 mode
   {
-    dma_channel_set_write_addr(dma32, dPixels, false);
-    dma_channel_set_trans_count(dma32, params->hVirtualPixels / 2, true);
-    tms9918->vram.map.blanking = 1; // V
-    if ((y >= vBorder + vPixels))
+    uint8_t banner = pendingDisplayBanner();
+    const bool splash = !validWrites || (frameCount < 600);
+
+    // nothing drawn over the border? scan out the shared border line instead
+    if (!splash && banner == PENDING_BANNER_NONE && !tms9918->config[CONF_DIAG])
     {
-      tms9918->vram.map.scanline = y - vBorder;
-      TMS_STATUS(tms9918, 0x03) = tms9918->vram.map.scanline;
+      vgaUseBorderLine(y);
     }
+    else
+    {
+      dma_channel_set_write_addr(dma32, dPixels, false);
+      dma_channel_set_trans_count(dma32, params->hVirtualPixels / 2, true);
+      sideBorder[buffer] = NO_SIDE_BORDER;
+    }
+
+    borderLineState(y);
 
-    if (!validWrites || (frameCount < 600))
+    if (splash)
     {
       dma_channel_wait_for_finish_blocking(dma32);
 
@@ -620,9 +781,8 @@ static void __time_critical_func(tmsScanline)(uint16_t y, VgaParams* params, uin
     // cycles (PENDING) or confirms in the configurator (ARMED)
     #define RENDER_CENTERED(scanline, text, ypos, fg, bg, pixels) \
       renderText((scanline), (text), \
-                 (RGB_PIXELS_X - (sizeof(text) - 1) * CHAR_WIDTH) / 2, \
+                 (params->hVirtualPixels - (sizeof(text) - 1) * CHAR_WIDTH) / 2, \
                  (ypos), (fg), (bg), (pixels))
-    uint8_t banner = pendingDisplayBanner();
     if (banner == PENDING_BANNER_AWAIT_PC)
     {
       dma_channel_wait_for_finish_blocking(dma32);
@@ -634,84 +794,116 @@ static void __time_critical_func(tmsScanline)(uint16_t y, VgaParams* params, uin
       RENDER_CENTERED(y, "OPEN CONFIGURATOR TO CONFIRM NEW SETTINGS", 8, 0x0fff, 0x044f, pixels);
     }
 
-    if (y == vBorder - 1)
-    {
+    y -= vBorder;
+  }
+  else if (!frameBufferMode() && !(TMS_REGISTER(tms9918, 1) & R1_DISP_ACTIVE))
+  {
+    /*** display blanked: the whole line is backdrop ***/
+    uint32_t frameStart = time_us_32();
+
+    y -= vBorder;
+    activeLineStart(y);
+
+    if (tms9918->palDirty)
       generateRgbCache();
-    }
 
-    if (TMS_REGISTER(tms9918, 0x32) & 0x40)
+    if (tms9918->config[CONF_DIAG])
     {
-      gpuTrigger();
+      dma_channel_set_write_addr(dma32, dPixels, false);
+      dma_channel_set_trans_count(dma32, params->hVirtualPixels / 2, true);
+      sideBorder[buffer] = NO_SIDE_BORDER;
+    }
+    else
+    {
+      vgaUseBorderLine(y + vBorder);
     }
 
-    y -= vBorder;
+    // no patterns or sprites are processed while blanked, so no 5S or COL.
+    // line interrupts and the GPU trigger still apply
+    activeLineEnd(0);
+
+    if (tms9918->config[CONF_DIAG_PERFORMANCE] || 1)
+      updateRenderTime(0,  time_us_32() - frameStart);
   }
   else
   {
     uint32_t frameStart = time_us_32();
 
     y -= vBorder;
-    tms9918->vram.map.blanking = 0;
-    tms9918->vram.map.scanline = y;
-    TMS_STATUS(tms9918, 0x03) = y;
+    if (!frameBufferMode())
+      activeLineStart(y);
 
-    /*** left border ***/
-    dma_channel_set_write_addr(dma32, dPixels, false);
-    dma_channel_set_trans_count(dma32, halfHBorder, true);
+    /*** left border (only if this buffer doesn't already hold it) ***/
+    const bool fillSides = (sideBorder[buffer] != bg);
+    if (fillSides)
+    {
+      dma_channel_set_write_addr(dma32, dPixels, false);
+      dma_channel_set_trans_count(dma32, halfHBorder, true);
+    }
 
     /*** main display region ***/
-    if (tms9918->palDirty || (TMS_STATUS(tms9918, 2) & 0x80))
+    /* while the gpu is running, the palette is refreshed every line unless we're falling behind */
+    if (tms9918->palDirty ||
+        ((TMS_STATUS(tms9918, 2) & 0x80) && vgaDegradeLevel() < VGA_DEGRADE_NO_PAL_REFRESH))
       generateRgbCache();
 
     /* generate the scanline */
-    uint16_t tmsY = y;
-    if (params->interlaced && (TMS_REGISTER(tms9918, 0) & R0_DOUBLE_ROWS))
-      tmsY = y * 2 + (field ^ params->interlacedFieldOrder);
-    uint32_t renderTime  = time_us_32();
-    uint8_t tempStatus = vrEmuTms9918ScanLine(tmsY, tmsScanlineBuffer);
-    renderTime = time_us_32() - renderTime;
-
-    /*** F18A status register updates ***/
-    TMS_STATUS(tms9918, 0x01) &= ~0x03;
-
-    if (tms9918->vram.map.scanline && (TMS_REGISTER(tms9918, 0x13) == tms9918->vram.map.scanline))
+    const uint8_t *tmsPixels = tmsScanlineBuffer;
+    uint32_t renderTime = 0;
+#if PICO_RP2350 && PICO9918_FRAME_BUFFER
+    if (frameBufferMode())
     {
-      TMS_STATUS(tms9918, 0x01) |= 0x01;
-      tempStatus |= STATUS_INT;
+      // already rendered by the emulated raster
+      tmsPixels = frameBufferLine(fbScanout, y);
     }
-
-    if (TMS_REGISTER(tms9918, 0x32) & 0x40)
+    else
+#endif
     {
-      gpuTrigger();
+      uint16_t tmsY = y;
+      if (params->interlaced && (TMS_REGISTER(tms9918, 0) & R0_DOUBLE_ROWS))
+        tmsY = y * 2 + (field ^ params->interlacedFieldOrder);
+      renderTime  = time_us_32();
+      uint8_t tempStatus = vrEmuTms9918ScanLine(tmsY, tmsScanlineBuffer);
+      renderTime = time_us_32() - renderTime;
+
+      activeLineEnd(tempStatus);
     }
 
-    updateInterrupts(tempStatus);
-
     dma_channel_wait_for_finish_blocking(dma32);
 
-    uint8_t* src = tmsScanlineBuffer;
-    uint8_t* end = tmsScanlineBuffer + TMS9918_PIXELS_X;
-    uint32_t* dP = (uint32_t*)(pixels) + halfHBorder;
-
-    tms9918->vram.map.blanking = 1; // H
+    // the crt effect's dimmed repeat is written alongside, unless diagnostics
+    // are drawn over the line afterwards (the vga loop dims those lines)
+    uint32_t* dDimPixels = tms9918->config[CONF_DIAG] ? NULL : (uint32_t*)vgaClaimDimLine(pixels);
 
     // convert all pixel data from color index to BGR16
-    while (src < end)
+    if (dDimPixels)
+    {
+      convertScanlineDim(tmsPixels, dPixels + halfHBorder, dDimPixels + halfHBorder, pram, TMS9918_PIXELS_X);
+
+      // the dimmed sides aren't tracked like sideBorder, but they're short
+      const uint32_t bgDim = vgaDimPixels(bg);
+      uint32_t* dDimRight = dDimPixels + halfHBorder + TMS9918_PIXELS_X;
+      for (uint32_t i = 0; i < halfHBorder; ++i)
+      {
+        dDimPixels[i] = bgDim;
+        dDimRight[i] = bgDim;
+      }
+    }
+    else
     {
-      dP [0] = pram[src[0]];
-      dP [1] = pram[src[1]];
-      dP [2] = pram[src[2]];
-      dP [3] = pram[src[3]];
-      dP [4] = pram[src[4]];
-      dP [5] = pram[src[5]];
-      dP [6] = pram[src[6]];
-      dP [7] = pram[src[7]];
-      dP += 8;
-      src += 8;
+      convertScanline(tmsPixels, dPixels + halfHBorder, pram, TMS9918_PIXELS_X);
     }
 
     // right border
-    dma_channel_set_write_addr(dma32, dPixels + halfHBorder + TMS9918_PIXELS_X, true);    
+    if (fillSides)
+    {
+      dma_channel_set_write_addr(dma32, dPixels + halfHBorder + TMS9918_PIXELS_X, true);
+      sideBorder[buffer] = tms9918->config[CONF_DIAG] ? NO_SIDE_BORDER : bg;
+
+      // otherwise the vga loop copies the line for the crt effect as soon as we return
+      if (vgaCurrentParams()->scanlines && !dDimPixels)
+        dma_channel_wait_for_finish_blocking(dma32);
+    }
 
     if (tms9918->config[CONF_DIAG_PERFORMANCE] || 1)
       updateRenderTime(renderTime,  time_us_32() - frameStart);    
@@ -720,6 +912,26 @@ static void __time_critical_func(tmsScanline)(uint16_t y, VgaParams* params, uin
   renderDiag(y + vBorder, pixels);
 }
 
+/*
+ * state-only update for a line vga is repeating from the line above
+ * (vga deadline degradation, runs on proc1)
+ */
+static void __time_critical_func(tmsRepeatScanline)(uint16_t y, VgaParams* params)
+{
+  y = y & 0x0fff;
+
+  if (y < vBorder || y >= (vBorder + vPixels))
+  {
+    borderLineState(y);
+  }
+  else if (!frameBufferMode())   // the emulated raster owns the vdp state
+  {
+    // the line isn't rendered, so no 5S or COL
+    activeLineStart(y - vBorder);
+    activeLineEnd(0);
+  }
+}
+
 /*
  * Set up PIOs for TMS9918 <-> CPU interface
  */
@@ -774,12 +986,14 @@ void proc1Entry()
 {
   tmsPioInit();
 
+  diagBootPhase(DIAG_BOOT_BUS);
+
   // ok, we can release (deassert) /INT now. active-low => drive high (mask set),
-  // active-high => drive low (mask clear).
+  // active-high => drive low (mask clear). only touch /INT
 #ifdef PICO9918_INT_ACTIVE_HIGH
-  gpio_put_all(0);
+  gpio_clr_mask(GPIO_INT_MASK);
 #else
-  gpio_put_all(GPIO_INT_MASK);
+  gpio_set_mask(GPIO_INT_MASK);
 #endif
 
   Pico9918HardwareVersion hwVersion = currentHwVersion();
@@ -799,15 +1013,131 @@ void proc1Entry()
   vgaLoop();
 }
 
+/*
+ * vreg voltage for millivolts (only the preset voltages)
+ */
+static int vregVoltageFromMv(uint16_t mv)
+{
+  return (mv <= 1150) ? VREG_VOLTAGE_1_15 : (mv <= 1200) ? VREG_VOLTAGE_1_20 : VREG_VOLTAGE_1_30;
+}
+
+/*
+ * set the system clock. raise the voltage before the clock, lower it after
+ */
+static void applyClock(DisplayClock clock)
+{
+  const bool raiseVoltage = clock.voltageMv >= currentClock.voltageMv;
+
+  if (raiseVoltage)
+  {
+    vreg_set_voltage(vregVoltageFromMv(clock.voltageMv));
+    sleep_ms(1);
+  }
+
+  set_sys_clock_pll(clock.vcoKHz * 1000, clock.postDiv1, clock.postDiv2);
+
+  if (!raiseVoltage)
+  {
+    vreg_set_voltage(vregVoltageFromMv(clock.voltageMv));
+  }
+
+  currentClock = clock;
+}
+
+/*
+ * the display plan (output mode and system clock) for the settings in config
+ */
+static DisplayPlan configDisplayPlan(const uint8_t *config)
+{
+  return displayPlan(configDispDriver(config),
+                     config[CONF_VGA_MODE],
+                     config[CONF_SCART_MODE],
+                     config[CONF_CLOCK_PRESET_ID]);
+}
+
+/*
+ * a live switch keeps the system clock: the tms bus, the GROMCLK/CPUCLK
+ * outputs and the gpu all run from it
+ */
+bool displayModeSwitchable(const uint8_t *config)
+{
+  const DisplayPlan plan = configDisplayPlan(config);
+  return displayClockEqual(&plan.clock, &currentClock);
+}
+
+/*
+ * set up the vga callbacks. a vdp rate other than the display's decouples
+ * the vdp via the frame buffers (RP2350 only)
+ */
+static void initVgaCallbacks(VgaInitParams *params)
+{
+  params->scanlineFn = tmsScanline;
+  params->endOfFrameFn = tmsEndOfFrame;
+  params->endOfScanlineFn = tmsEndOfScanline;
+  params->porchFn = tmsPorch;
+  params->repeatScanlineFn = tmsRepeatScanline;
+  params->idleFn = NULL;
+  params->triggerScanline = UINT32_MAX;  // will be set dynamically once vBorder/vPixels are known
+
+#if PICO_RP2350 && PICO9918_FRAME_BUFFER
+  /* vdp at a different rate to the display? decouple them via the frame buffers */
+  const uint32_t vdpRateHz = (tms9918->config[CONF_VDP_RATE] == 1) ? 50 :
+                             (tms9918->config[CONF_VDP_RATE] == 2) ? 60 : 0;
+  emuFrameUs = 0;
+  if (vdpRateHz && vdpRateHz != (uint32_t)(params->params.frameRateHz + 0.5f))
+  {
+    emuFrameUs = 1000000 / vdpRateHz;
+    emuTotalLines = (vdpRateHz == 50) ? 313 : 262;
+    emuFrameStart = time_us_32();
+
+    params->idleFn = tmsEmuIdle;
+    params->endOfScanlineFn = NULL;  // the emulated raster raises the interrupt
+    params->porchFn = NULL;
+  }
+#endif
+}
+
+/*
+ * switch to the display settings in config without a reboot. called on
+ * proc1 between frames. the tms bus, vram, vdp state and the system clock
+ * are untouched: only the vga output restarts. only settings that pass
+ * displayModeSwitchable() are armed for a switch
+ */
+static void switchDisplayMode(void)
+{
+  updateDispDriver();
+
+  const DisplayPlan plan = configDisplayPlan(tms9918->config);
+  if (!displayClockEqual(&plan.clock, &currentClock))
+    return;
+
+  vgaStop();
+
+  VgaInitParams params = { 0 };
+  params.params = plan.params;
+  params.scanlines = vgaCurrentParams()->scanlines;
+  initVgaCallbacks(&params);
+
+  displayYScale = plan.yScale;
+  displayRows30 = plan.rows30;
+  diagSetModeFallback(plan.fallback);
+
+  // the line buffers change width
+  sideBorder[0] = sideBorder[1] = NO_SIDE_BORDER;
+
+  vgaRestart(params);
+
+  initDiagnostics();
+}
+
 /*
  * main entry point
  */
 int main(void)
 {
-  /* currently, VGA hard-coded to 640x480@60Hz. We want a high clock frequency
-   * that comes close to being divisible by 25.175MHz. 252.0 is close... enough :)
-   * I do have code which sets the best clock baased on the chosen VGA mode,
-   * but this'll do for now. */
+  /* the clock presets suit 640x480@60Hz: a high clock frequency that comes
+   * close to being divisible by 25.175MHz. 252.0 is close... enough :)
+   * other VGA modes get a clock from the planner (displayPlan) */
 
 
   // set up gpio pins. keep /INT asserted for now: active-low => low (0),
@@ -823,42 +1153,38 @@ int main(void)
   // detect on core 0 before core 1 is launched (proc1 also reads it)
   (void)currentHwVersion();
 
-  // shouldUseScartClock() peeks flash for a user-forced SCART preference
-  detectScartDongle();
-
-#if PICO9918_ENABLE_SCART
-  if (shouldUseScartClock())
-    clockPresets = scartClockPresets;
-#endif
-
-  /* the initial "safe" clock speed */
-  ClockSettings clockSettings = clockPresets[clockPresetIndex];
-  vreg_set_voltage(clockSettings.voltage);
-  sleep_ms(1);
-  set_sys_clock_pll(clockSettings.pll, clockSettings.pllDiv1, clockSettings.pllDiv2);
-
   /* we need one of these. it's the main guy */
   vrEmuTms9918Init();
 
-  /* launch core 1 which handles TMS9918<->CPU and rendering scanlines */
-  multicore_launch_core1(proc1Entry);
+  /* the display settings decide the system clock. nothing here writes
+   * flash: that waits until the tms bus is up */
+  detectScartDongle();
 
-  /* we could set clock freq here from options */
   readConfig(tms9918->config);
 
   applyPendingDisplay(tms9918->config);
 
   updateDispDriver();
 
-  if (tms9918->config[CONF_CLOCK_PRESET_ID] != clockPresetIndex)
-  {
-    clockPresetIndex = tms9918->config[CONF_CLOCK_PRESET_ID];
-    clockSettings = clockPresets[clockPresetIndex];
+  /* the configured preset, or a planned clock for the mode */
+  const DisplayPlan plan = configDisplayPlan(tms9918->config);
+  diagBootPhase(DIAG_BOOT_CONFIG);
 
-    vreg_set_voltage(clockSettings.voltage);
-    sleep_ms(1);
-    set_sys_clock_pll(clockSettings.pll, clockSettings.pllDiv1, clockSettings.pllDiv2);
-  }
+  /* hosts read the vdp very early: one clock change, then the tms bus */
+  applyClock(plan.clock);
+  diagBootPhase(DIAG_BOOT_CLOCK);
+
+  /* launch core 1 which handles TMS9918<->CPU and rendering scanlines */
+  multicore_launch_core1(proc1Entry);
+  diagBootPhase(DIAG_BOOT_LAUNCH);
+
+  commitPendingDisplay();
+
+  VgaInitParams params = { 0 };
+  params.params = plan.params;
+  displayYScale = plan.yScale;
+  displayRows30 = plan.rows30;
+  diagSetModeFallback(plan.fallback);
 
 #ifndef PICO9918_NO_CLOCKS
   // set up the GROMCLK and CPUCLK outputs (frequencies depend on the VDP device)
@@ -873,6 +1199,13 @@ int main(void)
   initClockOrPullLow(cpuClkGpio, tmsCpuClkSm, clkCfg->pin38freq);
 #endif
 
+  // fixed channels, claimed so the GPU's dma (gpuInit) claims others
+  dma_channel_claim(dma32);
+#if PALCONV
+  dma_channel_claim(dmapalOut);
+  dma_channel_claim(dmapalIn);
+#endif
+
   dma_channel_config cfg = dma_channel_get_default_config(dma32);
   channel_config_set_read_increment(&cfg, false);
   channel_config_set_write_increment(&cfg, true);
@@ -916,31 +1249,13 @@ int main(void)
   tms9918->palDirty = 1;
 
   /* then set up VGA output */
-  VgaInitParams params = { 0 };
-#if PICO9918_ENABLE_SCART
-  // CONF_DISP_DRIVER: 0=VGA, 1=NTSC, 2=PAL (resolved by updateDispDriver)
-  if (tms9918->config[CONF_DISP_DRIVER] == 0)
-  {
-    params.params = vgaGetParams(VGA_640_480_60HZ);
-  }
-  else
-  {
-    params.params = vgaGetParams(tms9918->config[CONF_SCART_MODE]
-      ? RGBS_NTSC_720_480i_60HZ : RGBS_PAL_720_576i_50HZ);
-  }
-#else
-  params.params = vgaGetParams(DISPLAY_MODE);
-#endif
   /* set vga scanline callback to generate tms9918 scanlines */
-  params.scanlineFn = tmsScanline;
-  params.endOfFrameFn = tmsEndOfFrame;
-  params.endOfScanlineFn = tmsEndOfScanline;
-  params.porchFn = tmsPorch;
-  params.triggerScanline = UINT32_MAX;  // will be set dynamically once vBorder/vPixels are known
+  initVgaCallbacks(&params);
 
   const char *version = PICO9918_VERSION;
 
   vgaInit(params);
+  diagBootPhase(DIAG_BOOT_VGA);
 
   initTemperature();
 
@@ -0,0 +1,119 @@
+/*
+ * Project: pico9918 - vga
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#include "vga-clock.h"
+
+#define VGA_CLOCK_LOOP_TICKS    2         // vga_rgb_LOOP_TICKS (vga.pio)
+#define VGA_CLOCK_MIN_PIO_KHZ   50000     // below this, buildSyncData doubles the pio clock
+
+/*
+ * core voltage needed to run at sysClockKHz (matches the fixed clock presets)
+ */
+uint16_t vgaClockVoltageMv(uint32_t sysClockKHz)
+{
+  if (sysClockKHz <= 280000) return 1150;
+  if (sysClockKHz <= 330000) return 1200;
+  return 1300;
+}
+
+/*
+ * evaluate a system clock for the request. mirrors buildSyncData()
+ */
+static bool evaluateSysClock(const VgaClockRequest *request, uint32_t sysClockKHz, VgaClockPlan *plan)
+{
+  uint32_t minPioKHz = request->pixelClockKHz * VGA_CLOCK_LOOP_TICKS / request->hPixelScale;
+  if (minPioKHz < VGA_CLOCK_MIN_PIO_KHZ) minPioKHz *= 2;
+
+  if (sysClockKHz < minPioKHz)
+    return false;
+
+  const uint32_t divider = (sysClockKHz + minPioKHz / 2) / minPioKHz;
+  const uint64_t pioKHz1000 = (uint64_t)sysClockKHz * 1000 / divider;   // pio clock in Hz
+
+  // pio clocks per scaled pixel, rounded
+  const uint64_t scaledPixelHz = (uint64_t)request->pixelClockKHz * 1000 / request->hPixelScale;
+  const uint32_t clocksPerPixel = (uint32_t)((pioKHz1000 + scaledPixelHz / 2) / scaledPixelHz);
+  if (clocksPerPixel < VGA_CLOCK_LOOP_TICKS)
+    return false;
+
+  // achieved vs nominal pixel clock
+  const int64_t achievedHz = (int64_t)(pioKHz1000 * request->hPixelScale / clocksPerPixel);
+  const int64_t nominalHz = (int64_t)request->pixelClockKHz * 1000;
+  int32_t errorPpm = (int32_t)((achievedHz - nominalHz) * 1000000 / nominalHz);
+
+  if ((uint32_t)(errorPpm < 0 ? -errorPpm : errorPpm) > request->maxErrorPpm)
+    return false;
+
+  plan->sysClockKHz = sysClockKHz;
+  plan->pioDivider = divider;
+  plan->pioClocksPerPixel = clocksPerPixel;
+  plan->errorPpm = errorPpm;
+  return true;
+}
+
+/*
+ * find the highest multiple of the pixel clock within the request's budget
+ * that gives a pixel clock within tolerance. ties go to the smaller error.
+ * returns false if nothing fits
+ */
+bool vgaPlanClock(const VgaClockRequest *request, VgaClockPlan *plan)
+{
+  if (!request || !plan || !request->pixelClockKHz || !request->hPixelScale)
+    return false;
+
+  bool found = false;
+
+  for (uint32_t fbDiv = VGA_CLOCK_VCO_MIN_KHZ / VGA_CLOCK_XOSC_KHZ;
+       fbDiv <= VGA_CLOCK_VCO_MAX_KHZ / VGA_CLOCK_XOSC_KHZ; ++fbDiv)
+  {
+    const uint32_t vcoKHz = fbDiv * VGA_CLOCK_XOSC_KHZ;
+    if (vcoKHz < VGA_CLOCK_VCO_MIN_KHZ) continue;
+
+    for (uint32_t postDiv1 = 1; postDiv1 <= VGA_CLOCK_POSTDIV_MAX; ++postDiv1)
+    {
+      for (uint32_t postDiv2 = 1; postDiv2 <= postDiv1; ++postDiv2)
+      {
+        const uint32_t div = postDiv1 * postDiv2;
+        if (vcoKHz % div) continue;   // whole kHz only
+
+        const uint32_t sysClockKHz = vcoKHz / div;
+        if (sysClockKHz < request->minSysClockKHz || sysClockKHz > request->maxSysClockKHz) continue;
+
+        const uint16_t voltageMv = vgaClockVoltageMv(sysClockKHz);
+        if (voltageMv > request->maxVoltageMv) continue;
+
+        VgaClockPlan candidate;
+        if (!evaluateSysClock(request, sysClockKHz, &candidate)) continue;
+
+        // prefer the highest multiple of the pixel clock, then the smallest error
+        if (found)
+        {
+          const uint32_t multiple = candidate.pioDivider * candidate.pioClocksPerPixel;
+          const uint32_t bestMultiple = plan->pioDivider * plan->pioClocksPerPixel;
+          const int32_t absError = candidate.errorPpm < 0 ? -candidate.errorPpm : candidate.errorPpm;
+          const int32_t bestAbsError = plan->errorPpm < 0 ? -plan->errorPpm : plan->errorPpm;
+
+          if (multiple < bestMultiple) continue;
+          if (multiple == bestMultiple && absError >= bestAbsError) continue;
+        }
+
+        candidate.vcoKHz = vcoKHz;
+        candidate.postDiv1 = postDiv1;
+        candidate.postDiv2 = postDiv2;
+        candidate.voltageMv = voltageMv;
+        *plan = candidate;
+        found = true;
+      }
+    }
+  }
+
+  return found;
+}
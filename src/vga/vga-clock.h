@@ -0,0 +1,61 @@
+/*
+ * Project: pico9918 - vga
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+ * system clock planner for vga modes
+ *
+ * pure functions (no SDK calls) so the search can be exercised off-target.
+ * the pio divider and clocks per pixel follow the same rules as buildSyncData()
+ */
+
+#define VGA_CLOCK_XOSC_KHZ      12000     // crystal (PLL reference, refdiv 1)
+#define VGA_CLOCK_VCO_MIN_KHZ   750000    // PLL VCO limits
+#define VGA_CLOCK_VCO_MAX_KHZ   1600000
+#define VGA_CLOCK_POSTDIV_MAX   7
+
+typedef struct
+{
+  uint32_t pixelClockKHz;     // nominal pixel clock
+  uint8_t  hPixelScale;       // horizontal pixel scale the mode will run at
+  uint32_t minSysClockKHz;    // cpu budget floor
+  uint32_t maxSysClockKHz;    // cpu/flash ceiling
+  uint16_t maxVoltageMv;      // core voltage ceiling
+  uint32_t maxErrorPpm;       // pixel clock tolerance
+} VgaClockRequest;
+
+typedef struct
+{
+  uint32_t vcoKHz;            // PLL VCO frequency
+  uint8_t  postDiv1;
+  uint8_t  postDiv2;
+  uint32_t sysClockKHz;       // resulting system clock
+  uint16_t voltageMv;         // core voltage needed for sysClockKHz
+  uint16_t pioDivider;        // integer pio divider (as buildSyncData)
+  uint16_t pioClocksPerPixel; // pio clocks per scaled pixel
+  int32_t  errorPpm;          // achieved pixel clock error
+} VgaClockPlan;
+
+/*
+ * core voltage needed to run at sysClockKHz (matches the fixed clock presets)
+ */
+uint16_t vgaClockVoltageMv(uint32_t sysClockKHz);
+
+/*
+ * find the highest multiple of the pixel clock within the request's budget
+ * that gives a pixel clock within tolerance. ties go to the smaller error.
+ * returns false if nothing fits
+ */
+bool vgaPlanClock(const VgaClockRequest *request, VgaClockPlan *plan);
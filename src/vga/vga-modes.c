@@ -29,15 +29,17 @@ typedef struct {
 
 /*
  * Interlaced extension parameters (PAL/NTSC only)
+ * Also used by the progressive 15 kHz modes, which have a single field.
  */
 typedef struct {
+  uint8_t numFields;
   uint8_t interlacedFieldOrder;
   uint8_t shortPulsePixels;
   VgaFieldParams fields[VGA_MAX_FIELDS];
 } VgaModeInterlaced;
 
-#define VGA_MODE_COUNT (RGBS_NTSC_720_480i_60HZ + 1)
-#define INTERLACED_MODE_COUNT (RGBS_NTSC_720_480i_60HZ - RGBS_PAL_720_576i_50HZ + 1)
+#define VGA_MODE_COUNT (RGBS_NTSC_720_240p_60HZ + 1)
+#define INTERLACED_MODE_COUNT (RGBS_NTSC_720_240p_60HZ - RGBS_PAL_720_576i_50HZ + 1)
 #define FIRST_INTERLACED_MODE RGBS_PAL_720_576i_50HZ
 
 // References:
@@ -46,6 +48,7 @@ typedef struct {
 // http://tinyvga.com/vga-timing/800x600@60Hz
 // http://tinyvga.com/vga-timing/1024x768@60Hz
 // http://tinyvga.com/vga-timing/1280x1024@60Hz
+// CEA-861 576p (VIC 17) for 720x576@50Hz
 
 static const VgaModeBase vgaModeBase[VGA_MODE_COUNT] = {
   [VGA_640_480_60HZ] = {
@@ -67,7 +70,6 @@ static const VgaModeBase vgaModeBase[VGA_MODE_COUNT] = {
     .frameRateHz = 60.0f
   },
 
-#if VGA_MODE_ADDITIONAL
   [VGA_640_400_70HZ] = {
     .pixelClockKHz = 25175,
     .hSyncParams = {
@@ -117,9 +119,9 @@ static const VgaModeBase vgaModeBase[VGA_MODE_COUNT] = {
     },
     .vSyncParams = {
       .displayPixels    = 768,
-      .frontPorchPixels = 5,
+      .frontPorchPixels = 3,
       .syncPixels       = 6,
-      .backPorchPixels  = 27,
+      .backPorchPixels  = 29,
       .syncHigh         = false
     },
     .frameRateHz = 60.0f
@@ -143,7 +145,33 @@ static const VgaModeBase vgaModeBase[VGA_MODE_COUNT] = {
     },
     .frameRateHz = 60.0f
   },
-#endif
+
+  // 50 Hz progressive for PAL software: CEA-861 VIC 17 (27 MHz, 720/12/64/68
+  // x 576/5/5/39, negative syncs). only 640 of the 720 active pixels carry the
+  // picture (the tms display doubled, with 640x480's borders), so the mode
+  // reports 640 displayPixels. the other 80 are blank active video, baked
+  // into the porches as VGA_576P_H_BORDER each side. the sync pulse and the
+  // line and frame totals are unchanged, so a display sees VIC 17
+  #define VGA_576P_H_BORDER 40
+
+  [VGA_720_576_50HZ] = {
+    .pixelClockKHz = 27000,
+    .hSyncParams = {
+      .displayPixels    = 720 - VGA_576P_H_BORDER * 2,  // 640
+      .frontPorchPixels = 12  + VGA_576P_H_BORDER,      // 52
+      .syncPixels       = 64,
+      .backPorchPixels  = 68  + VGA_576P_H_BORDER,      // 108  (total = 864)
+      .syncHigh         = false
+    },
+    .vSyncParams = {
+      .displayPixels    = 576,
+      .frontPorchPixels = 5,
+      .syncPixels       = 5,
+      .backPorchPixels  = 39,                           // total = 625
+      .syncHigh         = false
+    },
+    .frameRateHz = 50.0f
+  },
 
   // Overscan borders baked into timing: 42px horizontal, 10 lines vertical per side
   // Display area reduced, porches grown by same amount. Totals unchanged.
@@ -185,6 +213,42 @@ static const VgaModeBase vgaModeBase[VGA_MODE_COUNT] = {
     },
     .frameRateHz = 60.0f
   },
+
+  // Progressive 15 kHz ("240p"): the same lines as each interlaced field,
+  // with no half-line offset so every frame lands on the same raster lines
+  [RGBS_PAL_720_288p_50HZ] = {
+    .pixelClockKHz = 13500,
+    .hSyncParams = {
+      .displayPixels    = 720 - SCART_H_BORDER * 2,  // 636
+      .frontPorchPixels = 12  + SCART_H_BORDER,      // 54
+      .syncPixels       = 64,
+      .backPorchPixels  = 68  + SCART_H_BORDER,      // 110  (total = 864)
+      .syncHigh         = false
+    },
+    // Progressive: 312 lines/frame, 50.08Hz
+    .vSyncParams = {
+      .displayPixels    = 576 / 2 - SCART_V_BORDER * 2,  // 268
+      .syncHigh         = false
+    },
+    .frameRateHz = 50.0f
+  },
+
+  [RGBS_NTSC_720_240p_60HZ] = {
+    .pixelClockKHz = 13500,
+    .hSyncParams = {
+      .displayPixels    = 720 - SCART_H_BORDER * 2,  // 636
+      .frontPorchPixels = 16  + SCART_H_BORDER,      // 58
+      .syncPixels       = 64,
+      .backPorchPixels  = 58  + SCART_H_BORDER,      // 100  (total = 858)
+      .syncHigh         = false
+    },
+    // Progressive: 262 lines/frame, 60.05Hz
+    .vSyncParams = {
+      .displayPixels    = 480 / 2 - SCART_V_BORDER * 2,  // 220
+      .syncHigh         = false
+    },
+    .frameRateHz = 60.0f
+  },
 };
 
 /*
@@ -192,15 +256,16 @@ static const VgaModeBase vgaModeBase[VGA_MODE_COUNT] = {
  * Indexed by (mode - FIRST_INTERLACED_MODE)
  *
  * All DMA transfers are 4 words (one full line = 2 half-lines).
- * EQ (short sync) pulse: ~2us
- * LS (long sync) pulse: halfLine - EQ (derived automatically)
+ * EQ (short sync) pulse: shortPulsePixels (2.35us PAL, 2.3us NTSC)
+ * LS (broad) pulse: halfLine - hsync, leaving a 4.7us serration (derived automatically)
  */
 static const VgaModeInterlaced vgaModeInterlaced[INTERLACED_MODE_COUNT] = {
   [RGBS_PAL_720_576i_50HZ - FIRST_INTERLACED_MODE] = {
+    .numFields = 2,
     // PAL: field 0 is lower raster position
     .interlacedFieldOrder = 1,
-    // EQ pulse: 2us = 27 pixels at 13.5MHz
-    .shortPulsePixels = 27,
+    // EQ pulse: 2.35us = 32 pixels at 13.5MHz
+    .shortPulsePixels = 32,
     .fields = {
       // Field 1 (313 lines): starts at whole-line boundary
       //   Vsync:    LsLs LsLs LsEq EqEq EqEq  (5 lines)
@@ -217,13 +282,13 @@ static const VgaModeInterlaced vgaModeInterlaced[INTERLACED_MODE_COUNT] = {
         .totalLines     = 313
       },
       // Field 2 (312 lines): starts at half-line boundary (after F1's EqLs)
-      //   Vsync:    LsLs LsLs LsEq EqEq        (4 lines)
+      //   Vsync:    LsLs LsLs EqEq EqEq        (4 lines, 5 broad pulses with F1's Ls)
       //   Porch:    31 lines (back porch + top border, normal hsync)
       //   Active:   268 lines
       //   Trailing: 9 lines (bottom border, all normal porch)
       [1] = {
         .vsyncLines     = 4,
-        .vsyncPattern   = { VSYNC_LSLS, VSYNC_LSLS, VSYNC_LSEQ, VSYNC_EQEQ },
+        .vsyncPattern   = { VSYNC_LSLS, VSYNC_LSLS, VSYNC_EQEQ, VSYNC_EQEQ },
         .porchLines     = 31,
         .activeLines    = 268,
         .trailingLines  = 9,
@@ -234,6 +299,7 @@ static const VgaModeInterlaced vgaModeInterlaced[INTERLACED_MODE_COUNT] = {
   },
 
   [RGBS_NTSC_720_480i_60HZ - FIRST_INTERLACED_MODE] = {
+    .numFields = 2,
     .interlacedFieldOrder = 0,
     // EQ pulse: 2.3us = 31 pixels at 13.5MHz
     .shortPulsePixels = 31,
@@ -253,11 +319,53 @@ static const VgaModeInterlaced vgaModeInterlaced[INTERLACED_MODE_COUNT] = {
         .totalLines     = 263
       },
       // Field 2 (262 lines): starts at half-line boundary (after F1's EqLs)
-      //   Vsync:    LsLs LsLs LsLs EqEq EqEq EqEq  (6 lines)
+      //   Vsync:    LsLs LsLs LsEq EqEq EqEq EqEq  (6 lines, 6 broad pulses with F1's Ls)
       //   Porch:    25 lines (back porch + top border)
       //   Active:   220 lines
       //   Trailing: 11 lines (bottom border, all normal porch)
       [1] = {
+        .vsyncLines     = 6,
+        .vsyncPattern   = { VSYNC_LSLS, VSYNC_LSLS, VSYNC_LSEQ, VSYNC_EQEQ, VSYNC_EQEQ, VSYNC_EQEQ },
+        .porchLines     = 25,
+        .activeLines    = 220,
+        .trailingLines  = 11,
+        .trailingPattern = { VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH },
+        .totalLines     = 262
+      },
+    }
+  },
+
+  [RGBS_PAL_720_288p_50HZ - FIRST_INTERLACED_MODE] = {
+    .numFields = 1,
+    .shortPulsePixels = 32,
+    .fields = {
+      // Single field (312 lines): PAL field 1 sync, no half-line offset
+      //   Vsync:    LsLs LsLs LsEq EqEq        (4 lines)
+      //   Porch:    31 lines
+      //   Active:   268 lines
+      //   Trailing: 9 lines (bottom border)
+      [0] = {
+        .vsyncLines     = 4,
+        .vsyncPattern   = { VSYNC_LSLS, VSYNC_LSLS, VSYNC_LSEQ, VSYNC_EQEQ },
+        .porchLines     = 31,
+        .activeLines    = 268,
+        .trailingLines  = 9,
+        .trailingPattern = { VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH, VSYNC_PORCH },
+        .totalLines     = 312
+      },
+    }
+  },
+
+  [RGBS_NTSC_720_240p_60HZ - FIRST_INTERLACED_MODE] = {
+    .numFields = 1,
+    .shortPulsePixels = 31,
+    .fields = {
+      // Single field (262 lines): NTSC field 1 sync, no half-line offset
+      //   Vsync:    LsLs LsLs LsLs EqEq EqEq EqEq  (6 lines)
+      //   Porch:    25 lines
+      //   Active:   220 lines
+      //   Trailing: 11 lines (bottom border)
+      [0] = {
         .vsyncLines     = 6,
         .vsyncPattern   = { VSYNC_LSLS, VSYNC_LSLS, VSYNC_LSLS, VSYNC_EQEQ, VSYNC_EQEQ, VSYNC_EQEQ },
         .porchLines     = 25,
@@ -289,8 +397,9 @@ VgaParams vgaGetParams(VgaMode mode)
   if (mode >= FIRST_INTERLACED_MODE)
   {
     const VgaModeInterlaced* ilc = &vgaModeInterlaced[mode - FIRST_INTERLACED_MODE];
-    params.interlaced          = true;
-    params.numFields           = 2;
+    params.interlaced          = ilc->numFields > 1;
+    params.fieldSync           = true;
+    params.numFields           = ilc->numFields;
     params.interlacedFieldOrder = ilc->interlacedFieldOrder;
     params.shortPulsePixels    = ilc->shortPulsePixels;
     memcpy(params.fields, ilc->fields, sizeof(ilc->fields));
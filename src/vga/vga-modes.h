@@ -16,14 +16,15 @@
 typedef enum
 {
   VGA_640_480_60HZ,
-#if VGA_MODE_ADDITIONAL
   VGA_640_400_70HZ,
   VGA_800_600_60HZ,
   VGA_1024_768_60HZ,
   VGA_1280_1024_60HZ,
-#endif
+  VGA_720_576_50HZ,
   RGBS_PAL_720_576i_50HZ,
   RGBS_NTSC_720_480i_60HZ,
+  RGBS_PAL_720_288p_50HZ,
+  RGBS_NTSC_720_240p_60HZ,
 } VgaMode;
 
 
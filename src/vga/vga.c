@@ -21,6 +21,7 @@
 #include "hardware/dma.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
+#include "hardware/sync.h"
 
 
 #define VGA_NO_MALLOC 1
@@ -45,6 +46,10 @@ int roundflt(float x)
 #define SYNC_SM         0        // vga sync state machine index
 #define RGB_SM          1        // vga rgb state machine index
 
+#define SYNC_DMA_CHAN      0     // sync line dma channel
+#define RGB_DMA_CHAN       1     // rgb pixel dma channel
+#define SYNC_CTRL_DMA_CHAN 3     // sync list control dma channel
+
 #define FRONT_PORCH_MSG 0x20000000
 #define END_OF_SCANLINE_MSG 0x40000000
 #define END_OF_FRAME_MSG    0x80000000
@@ -97,18 +102,118 @@ __attribute__((section(".scratch_y.lookup"))) uint16_t __aligned(4) rgbDataBuffe
 uint16_t* __aligned(8) rgbDataBuffer[2 + VGA_SCANLINE_TIME_DEBUG] = { 0 };                          // two scanline buffers (odd and even)
 #endif
 
+// shared solid border line (and its CRT-dimmed twin). full-border lines are
+// scanned out directly from here, so their rgbDataBuffer is never written.
+// double-buffered: a colour change fills the inactive set, since the dma
+// may still be scanning the previous line out of the active one
+uint16_t __aligned(4) vgaBorderLine[2][2][RGB_PIXELS_X] = { 0 };
+static uint32_t borderSet = 0;
+
+// CRT-dimmed copies of the two line buffers. scanlineFn fills these as it
+// writes the line (vgaClaimDimLine), or proc1 copies the line once it's
+// rendered, so the dma irq only has to choose where to read from
+static uint16_t __aligned(4) rgbDimBuffer[2][RGB_PIXELS_X] = { 0 };
+static bool dimLineClaimed = false;
+
+// where the rgb dma reads each buffered line from (rgbDataBuffer or vgaBorderLine[set][0])
+// and its dimmed repeat from (rgbDimBuffer or vgaBorderLine[set][1])
+static uint32_t* rgbLineSource[2] = { 0 };
+static uint32_t* rgbLineDimSource[2] = { 0 };
+static uint32_t borderColor = 0xffffffff;
+
+// deadline tracking: virtual line the rgb dma is currently sending (-1 = none yet this frame)
+static volatile int32_t outputLine = -1;
+static volatile uint8_t degradeLevel = VGA_DEGRADE_NONE;
+static uint32_t missedThisFrame = 0;
+static uint32_t cleanFrames = 0;
+static VgaDeadlineStats deadlineStats = { 0 };
+
+#define VGA_DEGRADE_RECOVER_FRAMES 120  // clean frames before stepping back up a level
+
+// vgaStop() handshake: proc1 raises stopRequest, the dma irq on proc0 turns
+// its own interrupts off on the way out and raises stopAck
+static volatile bool stopRequest = false;
+static volatile bool stopAck = false;
+
+// line request ring from the dma irq (proc0) to vgaLoop (proc1). single
+// producer, single consumer: only the irq advances requestHead and only
+// vgaLoop advances requestTail. both are free-running sequence numbers, so
+// head - tail is the number of queued requests. proc1 sleeps on WFE and the
+// irq wakes it with SEV
+#define VGA_REQUEST_RING_SIZE 16  // power of two
+static uint32_t requestRing[VGA_REQUEST_RING_SIZE];
+static volatile uint32_t requestHead = 0;
+static volatile uint32_t requestTail = 0;
+
 
 /*
  * file scope
  */
 static int syncDmaChan = 0;
+static int syncCtrlDmaChan = 0;
 static int rgbDmaChan = 0;
 static uint syncDmaChanMask = 0;
 static uint rgbDmaChanMask = 0;
 static VgaInitParams vgaParams = { 0 };
 static pio_sm_config rgbConfig;
+static uint syncProgOffset;
 uint rgbProgOffset;
 
+/*
+ * queue a message for vgaLoop (dma irq only). a full ring drops the message
+ * rather than stalling the irq, same as the old zero-timeout fifo push
+ */
+static inline void __time_critical_func(pushRequest)(uint32_t message)
+{
+  const uint32_t head = requestHead;
+  if (head - requestTail >= VGA_REQUEST_RING_SIZE)
+  {
+    ++deadlineStats.droppedRequests;
+    return;
+  }
+
+  requestRing[head & (VGA_REQUEST_RING_SIZE - 1)] = message;
+  __dmb();  // message visible before the new head
+  requestHead = head + 1;
+  __sev();
+}
+
+static inline bool requestPending()
+{
+  return requestTail != requestHead;
+}
+
+/*
+ * take the next message (vgaLoop only). sleeps until one arrives
+ */
+static inline uint32_t __time_critical_func(popRequest)()
+{
+  while (!requestPending())
+  {
+    __wfe();
+  }
+  __dmb();  // head read before the message
+
+  const uint32_t tail = requestTail;
+  const uint32_t queued = requestHead - tail;
+  if (queued > deadlineStats.maxQueuedRequests)
+    deadlineStats.maxQueuedRequests = queued;
+
+  const uint32_t message = requestRing[tail & (VGA_REQUEST_RING_SIZE - 1)];
+  __dmb();  // message read before the slot is released
+  requestTail = tail + 1;
+  return message;
+}
+
+/*
+ * the next message, left queued (vgaLoop only). call only if requestPending()
+ */
+static inline uint32_t __time_critical_func(peekRequest)()
+{
+  __dmb();  // head read before the message
+  return requestRing[requestTail & (VGA_REQUEST_RING_SIZE - 1)];
+}
+
 uint32_t vgaMinimumPioClockKHz(VgaParams* params)
 {
   if (params)
@@ -123,9 +228,36 @@ uint32_t vgaMinimumPioClockKHz(VgaParams* params)
 
 
 // Map VgaVsyncLineType enum to sync data buffer pointers.
-// Populated by buildSyncData() when interlaced is true.
+// Populated by buildSyncData() when fieldSync is true.
 static const uint32_t* vsyncTypeBuffers[VSYNC_TYPE_COUNT];
 
+// sync dma chain: the sync buffer for every line of the frame (both fields
+// for interlaced modes). the control channel writes one entry per line to
+// the sync channel's read trigger. a NULL entry stops the chain and raises
+// the sync irq (IRQ_QUIET), so the irq only runs at these milestones. the
+// sync pio fifo holds two lines, which is the irq's time to restart it
+#define VGA_SYNC_LIST_SIZE 1088   // 1280x1024 is 1066 lines, plus milestone NULLs
+#define VGA_SYNC_MILESTONES_PER_FIELD 3
+
+typedef enum
+{
+  SYNC_MILESTONE_ACTIVE,        // two lines before the first active line
+  SYNC_MILESTONE_FRONT_PORCH,   // start of the bottom porch
+  SYNC_MILESTONE_END            // end of the field
+} VgaSyncMilestoneType;
+
+typedef struct
+{
+  const uint32_t** resume;      // list entry to restart the chain from
+  uint8_t type;
+  uint8_t field;
+} VgaSyncMilestone;
+
+static const uint32_t* syncList[VGA_SYNC_LIST_SIZE];
+static VgaSyncMilestone syncMilestones[VGA_SYNC_MILESTONES_PER_FIELD * VGA_MAX_FIELDS];
+static uint32_t syncMilestoneCount = 0;
+static volatile uint32_t nextSyncMilestone = 0;
+
 /*
  * build the sync data buffers
  */
@@ -166,7 +298,7 @@ static bool buildSyncData()
   const uint32_t vSyncOn = vgaParams.params.vSyncParams.syncHigh << vga_sync_WORD_VSYNC_OFFSET;
 
 #if PICO9918_ENABLE_SCART
-  const bool combinedSync = vgaParams.params.interlaced;
+  const bool combinedSync = vgaParams.params.fieldSync;
 #else
   const bool combinedSync = false;
 #endif
@@ -211,44 +343,46 @@ static bool buildSyncData()
   syncDataSync[SYNC_LINE_HSYNC] = instNop | HonVon | syncTicks;
   syncDataSync[SYNC_LINE_BPORCH] = instNop | HoffVon | bPorchTicks;
 
-  // Interlaced: full-line vsync buffers (4 words = 2 half-lines = 64us).
+  // SCART: full-line vsync buffers (4 words = 2 half-lines = 64us).
   // Pulse widths from halfLineSync config; guard period fills the remainder of each half-line.
-  if (vgaParams.params.interlaced)
+  if (vgaParams.params.fieldSync)
   {
     const uint32_t cLow  = HonVoff;   // csync asserted (low)
     const uint32_t cHigh = HoffVoff;  // csync idle (high)
 
     const float ppc = vgaParams.params.pioClocksPerPixel;
-    const uint32_t shortPx = vgaParams.params.shortPulsePixels;  // EQ pulse (e.g. 27)
+    const uint32_t shortPx = vgaParams.params.shortPulsePixels;  // EQ pulse (e.g. 32)
+    const uint32_t serrationPx = vgaParams.params.hSyncParams.syncPixels;     // LS serration, as wide as hsync (e.g. 64)
     const uint32_t halfLinePx = vgaParams.params.hSyncParams.totalPixels / 2; // half-line (e.g. 432)
-    const uint32_t longPx  = halfLinePx - shortPx;                            // LS pulse / EQ guard
-    const uint32_t eqLow  = roundflt(ppc * (float)shortPx) - vga_sync_SETUP_OVERHEAD;  // EQ pulse ticks
-    const uint32_t eqHigh = roundflt(ppc * (float)longPx)  - vga_sync_SETUP_OVERHEAD;  // EQ guard / LS pulse ticks
-
-    // LS+LS: [405px LOW][27px HIGH][405px LOW][27px HIGH] = 864px
-    syncDataLsLs[0] = instNop | cLow  | eqHigh;
-    syncDataLsLs[1] = instNop | cHigh | eqLow;
-    syncDataLsLs[2] = instNop | cLow  | eqHigh;
-    syncDataLsLs[3] = instNop | cHigh | eqLow;
-
-    // LS+EQ: [405px LOW][27px HIGH][27px LOW][405px HIGH] = 864px
-    syncDataLsEq[0] = instNop | cLow  | eqHigh;
-    syncDataLsEq[1] = instNop | cHigh | eqLow;
+    const uint32_t eqLow  = roundflt(ppc * (float)shortPx) - vga_sync_SETUP_OVERHEAD;                  // EQ pulse ticks
+    const uint32_t eqHigh = roundflt(ppc * (float)(halfLinePx - shortPx)) - vga_sync_SETUP_OVERHEAD;   // EQ guard ticks
+    const uint32_t lsLow  = roundflt(ppc * (float)(halfLinePx - serrationPx)) - vga_sync_SETUP_OVERHEAD; // LS pulse ticks
+    const uint32_t lsHigh = roundflt(ppc * (float)serrationPx) - vga_sync_SETUP_OVERHEAD;              // LS serration ticks
+
+    // LS+LS: [368px LOW][64px HIGH][368px LOW][64px HIGH] = 864px
+    syncDataLsLs[0] = instNop | cLow  | lsLow;
+    syncDataLsLs[1] = instNop | cHigh | lsHigh;
+    syncDataLsLs[2] = instNop | cLow  | lsLow;
+    syncDataLsLs[3] = instNop | cHigh | lsHigh;
+
+    // LS+EQ: [368px LOW][64px HIGH][32px LOW][400px HIGH] = 864px
+    syncDataLsEq[0] = instNop | cLow  | lsLow;
+    syncDataLsEq[1] = instNop | cHigh | lsHigh;
     syncDataLsEq[2] = instNop | cLow  | eqLow;
     syncDataLsEq[3] = instNop | cHigh | eqHigh;
 
-    // EQ+EQ: [27px LOW][405px HIGH][27px LOW][405px HIGH] = 864px
+    // EQ+EQ: [32px LOW][400px HIGH][32px LOW][400px HIGH] = 864px
     syncDataEqEq[0] = instNop | cLow  | eqLow;
     syncDataEqEq[1] = instNop | cHigh | eqHigh;
     syncDataEqEq[2] = instNop | cLow  | eqLow;
     syncDataEqEq[3] = instNop | cHigh | eqHigh;
 
-    // EQ+LS: [27px LOW][405px HIGH][405px LOW][27px HIGH] = 864px
+    // EQ+LS: [32px LOW][400px HIGH][368px LOW][64px HIGH] = 864px
     // This is the interlace transition line (F1 line 312).
     syncDataEqLs[0] = instNop | cLow  | eqLow;
     syncDataEqLs[1] = instNop | cHigh | eqHigh;
-    syncDataEqLs[2] = instNop | cLow  | eqHigh;
-    syncDataEqLs[3] = instNop | cHigh | eqLow;
+    syncDataEqLs[2] = instNop | cLow  | lsLow;
+    syncDataEqLs[3] = instNop | cHigh | lsHigh;
 
     // Lookup table: VgaVsyncLineType enum → buffer pointer
     vsyncTypeBuffers[VSYNC_LSLS]  = syncDataLsLs;
@@ -262,6 +396,87 @@ static bool buildSyncData()
 }
 
 
+/*
+ * sync buffer for line of a field
+ */
+static const uint32_t* syncLineData(const VgaFieldParams* field, int line)
+{
+  if (vgaParams.params.fieldSync)
+  {
+    const int vsyncEnd  = field->vsyncLines;
+    const int porchEnd  = vsyncEnd + field->porchLines;
+    const int activeEnd = porchEnd + field->activeLines;
+
+    if (line < vsyncEnd) return vsyncTypeBuffers[field->vsyncPattern[line]];
+    if (line < porchEnd) return syncDataPorch;
+    if (line < activeEnd) return syncDataActive;
+    return vsyncTypeBuffers[field->trailingPattern[line - activeEnd]];
+  }
+
+  const VgaSyncParams* v = &vgaParams.params.vSyncParams;
+  if (line < v->syncPixels) return syncDataSync;
+  if (line < v->syncPixels + v->backPorchPixels) return syncDataPorch;
+  if (line < v->totalPixels - v->frontPorchPixels) return syncDataActive;
+  return syncDataPorch;
+}
+
+/*
+ * build the sync dma chain and its milestones
+ *
+ * a milestone at line L stops the chain once line L-1 has been queued,
+ * which is when the per-line irq used to act while setting up line L
+ */
+static void buildSyncList()
+{
+  const uint32_t** entry = syncList;
+  const int fieldCount = vgaParams.params.fieldSync ? vgaParams.params.numFields : 1;
+
+  syncMilestoneCount = 0;
+  nextSyncMilestone = 0;
+
+  for (int f = 0; f < fieldCount; ++f)
+  {
+    const VgaFieldParams* field = &vgaParams.params.fields[f];
+    int totalLines, activeLine, frontPorchLine;
+
+    if (vgaParams.params.fieldSync)
+    {
+      totalLines = field->totalLines;
+      activeLine = field->vsyncLines + field->porchLines - 2;
+      frontPorchLine = field->vsyncLines + field->porchLines + field->activeLines;
+    }
+    else
+    {
+      const VgaSyncParams* v = &vgaParams.params.vSyncParams;
+      totalLines = v->totalPixels;
+      activeLine = v->syncPixels + v->backPorchPixels - 2;
+      frontPorchLine = v->totalPixels - v->frontPorchPixels + 2;
+    }
+
+    // leave room for this field's milestones and the ones still to come
+    const int maxLines = (int)(VGA_SYNC_LIST_SIZE - (entry - syncList)) -
+                         VGA_SYNC_MILESTONES_PER_FIELD * (fieldCount - f);
+    if (totalLines > maxLines) totalLines = maxLines;
+    if (frontPorchLine >= totalLines) frontPorchLine = totalLines - 1;  // 1-line front porch (1280x1024)
+    if (activeLine >= frontPorchLine) activeLine = frontPorchLine - 1;
+
+    for (int line = 0; line < totalLines; ++line)
+    {
+      if (line == activeLine || line == frontPorchLine)
+      {
+        *entry++ = NULL;
+        syncMilestones[syncMilestoneCount++] = (VgaSyncMilestone){
+          entry, (line == activeLine) ? SYNC_MILESTONE_ACTIVE : SYNC_MILESTONE_FRONT_PORCH, f };
+      }
+      *entry++ = syncLineData(field, line);
+    }
+
+    *entry++ = NULL;
+    syncMilestones[syncMilestoneCount++] = (VgaSyncMilestone){
+      (f == fieldCount - 1) ? syncList : entry, SYNC_MILESTONE_END, f };
+  }
+}
+
 /*
  * initialise the vga sync pio
  */
@@ -276,7 +491,7 @@ static void vgaInitSync()
   }
 
   // add sync pio program
-  uint syncProgOffset = pio_add_program(VGA_PIO, &vga_sync_program);
+  syncProgOffset = pio_add_program(VGA_PIO, &vga_sync_program);
   pio_sm_set_consecutive_pindirs(VGA_PIO, SYNC_SM, SYNC_PINS_START, SYNC_PINS_COUNT, true);
 
   // configure sync pio
@@ -288,17 +503,24 @@ static void vgaInitSync()
   pio_sm_init(VGA_PIO, SYNC_SM, syncProgOffset, &syncConfig);
 
   // initialise sync dma
-  syncDmaChan = 0;//dma_claim_unused_channel(true);
-  syncDmaChanMask = 0x01 << syncDmaChan;
   dma_channel_config syncDmaChanConfig = dma_channel_get_default_config(syncDmaChan);
   channel_config_set_transfer_data_size(&syncDmaChanConfig, DMA_SIZE_32);           // transfer 32 bits at a time
   channel_config_set_read_increment(&syncDmaChanConfig, true);                       // increment read
   channel_config_set_write_increment(&syncDmaChanConfig, false);                     // don't increment write 
   channel_config_set_dreq(&syncDmaChanConfig, pio_get_dreq(VGA_PIO, SYNC_SM, true)); // transfer when there's space in fifo
+  channel_config_set_chain_to(&syncDmaChanConfig, syncCtrlDmaChan);                  // each line loads the next
+  channel_config_set_irq_quiet(&syncDmaChanConfig, true);                            // irq on NULL trigger only
+
+  // the control channel feeds the sync channel one line of the chain at a time
+  buildSyncList();
+  dma_channel_config syncCtrlDmaChanConfig = dma_channel_get_default_config(syncCtrlDmaChan);
+  channel_config_set_transfer_data_size(&syncCtrlDmaChanConfig, DMA_SIZE_32);
+  channel_config_set_read_increment(&syncCtrlDmaChanConfig, true);
+  channel_config_set_write_increment(&syncCtrlDmaChanConfig, false);
+  dma_channel_configure(syncCtrlDmaChan, &syncCtrlDmaChanConfig, &dma_hw->ch[syncDmaChan].al3_read_addr_trig, syncList, 1, false);
 
   // setup the dma channel and set it going
-  // setup the dma channel and set it going
-  uint32_t* syncInitBuf = vgaParams.params.interlaced ? syncDataLsLs : syncDataSync;
+  uint32_t* syncInitBuf = vgaParams.params.fieldSync ? syncDataLsLs : syncDataSync;
   dma_channel_configure(syncDmaChan, &syncDmaChanConfig, &VGA_PIO->txf[SYNC_SM], syncInitBuf, 4, false);
   dma_channel_set_irq0_enabled(syncDmaChan, true);
 }
@@ -333,11 +555,11 @@ static void vgaInitRgb()
 
   // add rgb pio program
   pio_sm_set_consecutive_pindirs(VGA_PIO, RGB_SM, RGB_PINS_START, RGB_PINS_COUNT, true);
-  // Output displayPixels + 2 pixels per line. The extra word (2 pixels) of
+  // Output hVirtualPixels + 2 pixels per line. The extra word (2 pixels) of
   // zeros absorbs the PIO's speculative autopull, preventing stale FIFO data
   // from bleeding into the next scanline. The extra pixels fall within the
   // front porch region and are blanked by the sync signal.
-  pio_set_y(VGA_PIO, RGB_SM, vgaParams.params.hSyncParams.displayPixels + 1);
+  pio_set_y(VGA_PIO, RGB_SM, vgaParams.params.hVirtualPixels + 1);
 
   rgbProgOffset = pio_add_program(VGA_PIO, &rgbProgram);
   rgbConfig = vga_rgb_program_get_default_config(rgbProgOffset);
@@ -349,161 +571,92 @@ static void vgaInitRgb()
   pio_sm_init(VGA_PIO, RGB_SM, rgbProgOffset, &rgbConfig);
 
   // initialise rgb dma
-  rgbDmaChan = 1;//dma_claim_unused_channel(true);
-  rgbDmaChanMask = 0x01 << rgbDmaChan;
   dma_channel_config rgbDmaChanConfig = dma_channel_get_default_config(rgbDmaChan);
   channel_config_set_transfer_data_size(&rgbDmaChanConfig, DMA_SIZE_32);  // transfer 32 bits at a time (2 pixels)
   channel_config_set_read_increment(&rgbDmaChanConfig, true);             // increment read
   channel_config_set_write_increment(&rgbDmaChanConfig, false);           // don't increment write
   channel_config_set_dreq(&rgbDmaChanConfig, pio_get_dreq(VGA_PIO, RGB_SM, true));
 
-  // DMA transfers displayPixels/2 + 1 words (the extra word is a black guard)
-  dma_channel_configure(rgbDmaChan, &rgbDmaChanConfig, &VGA_PIO->txf[RGB_SM], rgbDataBuffer[0], vgaParams.params.hSyncParams.displayPixels / 2 + 1, false);
+  // DMA transfers hVirtualPixels/2 + 1 words (the extra word is a black guard)
+  dma_channel_configure(rgbDmaChan, &rgbDmaChanConfig, &VGA_PIO->txf[RGB_SM], rgbDataBuffer[0], vgaParams.params.hVirtualPixels / 2 + 1, false);
   dma_channel_set_irq0_enabled(rgbDmaChan, true);
 }
 
 /*
  * dma interrupt handler
  *
- * Interlaced: all DMA transfers are 4 words (one full line = 64us).
- * Field structure is read from vgaParams.params.fields[currentField].
- * The vsync pattern, porch, active, and trailing EQ line counts are
- * all defined per-field in the VgaFieldParams.
+ * the sync channel only interrupts at the milestones of the sync dma chain
+ * (see buildSyncList): ahead of the active area, at the front porch and at
+ * the end of each field. the rgb channel interrupts at the end of each line.
  */
 static void __isr __time_critical_func(dmaIrqHandler)(void)
 {
-  static int currentLine = -1;
   static int currentDisplayLine = -1;
   static int currentField = 0;
 
-  if (dma_hw->ints0 & syncDmaChanMask)
+  if (dma_channel_get_irq0_status(syncDmaChan))
   {
-    dma_hw->ints0 = syncDmaChanMask;
+    dma_channel_acknowledge_irq0(syncDmaChan);
 
-    if (vgaParams.params.interlaced)
-    {
-      const VgaFieldParams* field = &vgaParams.params.fields[currentField];
+    const VgaSyncMilestone* milestone = &syncMilestones[nextSyncMilestone];
+    if (++nextSyncMilestone >= syncMilestoneCount) nextSyncMilestone = 0;
 
-      if (++currentLine >= (int)field->totalLines)
-      {
-        currentLine = 0;
-        currentDisplayLine = 0;
-        currentField ^= 1;
-        field = &vgaParams.params.fields[currentField];
-      }
+    // restart the chain first. the pio fifo is draining meanwhile
+    dma_channel_set_read_addr(syncCtrlDmaChan, milestone->resume, true);
 
-      const int vsyncEnd  = field->vsyncLines;
-      const int porchEnd  = vsyncEnd + field->porchLines;
-      const int activeEnd = porchEnd + field->activeLines;
-
-      if (currentLine < vsyncEnd)
-      {
-        // Vsync region: dispatch from per-field pattern
-        dma_channel_set_read_addr(syncDmaChan,
-          vsyncTypeBuffers[field->vsyncPattern[currentLine]], true);
-      }
-      else if (currentLine < porchEnd)
-      {
-        // Back porch
-        dma_channel_set_read_addr(syncDmaChan, syncDataPorch, true);
-        if (currentLine + 2 == porchEnd)
-        {
-          multicore_fifo_push_timeout_us((uint32_t)(currentField << 12) | 0, 0);
-          multicore_fifo_push_timeout_us((uint32_t)(currentField << 12) | 1, 0);
-
-          dma_channel_abort(rgbDmaChan);
-          dma_hw->ints0 = rgbDmaChanMask;
-          pio_sm_set_enabled(VGA_PIO, RGB_SM, false);
-          pio_sm_clear_fifos(VGA_PIO, RGB_SM);
-          pio_sm_restart(VGA_PIO, RGB_SM);
-          pio_sm_exec(VGA_PIO, RGB_SM, pio_encode_jmp(rgbProgOffset));
-          pio_sm_set_enabled(VGA_PIO, RGB_SM, true);
-          currentDisplayLine = 0;
-          dma_channel_set_read_addr(rgbDmaChan, rgbDataBuffer[0], true);
-        }
-      }
-      else if (currentLine < activeEnd)
-      {
-        dma_channel_set_read_addr(syncDmaChan, syncDataActive, true);
-      }
-      else
+    if (milestone->type == SYNC_MILESTONE_ACTIVE)
+    {
+      // bit 12 carries the field for interlaced modes (0 or 1)
+      currentField = milestone->field;
+      outputLine = -1;
+      pushRequest((uint32_t)(currentField << 12) | 0);
+      pushRequest((uint32_t)(currentField << 12) | 1);
+      currentDisplayLine = 0;
+
+      if (vgaParams.params.fieldSync)
       {
-        // Trailing lines: dispatch from per-field trailing pattern
-        int trailingIdx = currentLine - activeEnd;
-        dma_channel_set_read_addr(syncDmaChan,
-          vsyncTypeBuffers[field->trailingPattern[trailingIdx]], true);
-
-        if (currentLine == activeEnd)
-        {
-          multicore_fifo_push_timeout_us(FRONT_PORCH_MSG, 0);
-        }
+        dma_channel_abort(rgbDmaChan);
+        dma_channel_acknowledge_irq0(rgbDmaChan);
+        pio_sm_set_enabled(VGA_PIO, RGB_SM, false);
+        pio_sm_clear_fifos(VGA_PIO, RGB_SM);
+        pio_sm_restart(VGA_PIO, RGB_SM);
+        pio_sm_exec(VGA_PIO, RGB_SM, pio_encode_jmp(rgbProgOffset));
+        pio_sm_set_enabled(VGA_PIO, RGB_SM, true);
+        dma_channel_set_read_addr(rgbDmaChan, rgbLineSource[0], true);
       }
     }
-    else
+    else if (milestone->type == SYNC_MILESTONE_FRONT_PORCH)
     {
-      // non-interlaced VGA: original dispatch logic unchanged
-      if (++currentLine >= vgaParams.params.vSyncParams.totalPixels)
-      {
-        currentLine = 0;
-        currentDisplayLine = 0;
-      }
-
-      if (currentLine < vgaParams.params.vSyncParams.syncPixels)
-      {
-        dma_channel_set_read_addr(syncDmaChan, syncDataSync, true);
-      }
-      else if (currentLine < (vgaParams.params.vSyncParams.syncPixels + vgaParams.params.vSyncParams.backPorchPixels))
-      {
-        dma_channel_set_read_addr(syncDmaChan, syncDataPorch, true);
-        if (currentLine + 2 == (vgaParams.params.vSyncParams.syncPixels + vgaParams.params.vSyncParams.backPorchPixels))
-        {
-          multicore_fifo_push_timeout_us(0, 0);
-          multicore_fifo_push_timeout_us(1, 0);
-        }
-      }
-      else if (currentLine < (vgaParams.params.vSyncParams.totalPixels - vgaParams.params.vSyncParams.frontPorchPixels))
-      {
-        dma_channel_set_read_addr(syncDmaChan, syncDataActive, true);
-      }
-      else
-      {
-        dma_channel_set_read_addr(syncDmaChan, syncDataPorch, true);
-        if (currentLine == (vgaParams.params.vSyncParams.totalPixels - vgaParams.params.vSyncParams.frontPorchPixels) + 2)
-        {
-          multicore_fifo_push_timeout_us(FRONT_PORCH_MSG, 0);
-        }
-      }
+      pushRequest(FRONT_PORCH_MSG);
     }
   }
 
-  if (dma_hw->ints0 & rgbDmaChanMask)
+  if (dma_channel_get_irq0_status(rgbDmaChan))
   {
-    dma_hw->ints0 = rgbDmaChanMask;
+    dma_channel_acknowledge_irq0(rgbDmaChan);
 
     currentDisplayLine++;
 
     uint32_t pxLine = currentDisplayLine;
     if (vgaParams.params.vPixelScale == 2) pxLine >>= 1;
+    else if (vgaParams.params.vPixelScale == 4) pxLine >>= 2;
     uint32_t pxLineRpt = currentDisplayLine & (vgaParams.params.vPixelScale - 1);
 
-    uint32_t* currentBuffer = (uint32_t*)rgbDataBuffer[pxLine & 0x01];
-    
-    // crt effect?
-    if (vgaParams.scanlines && pxLineRpt != 0)
+    const bool crtEffect = vgaParams.scanlines && degradeLevel < VGA_DEGRADE_NO_CRT;
+
+    // crt effect? the last repeat of a line reads the dimmed copy proc1 made
+    const bool dimLine = crtEffect && pxLineRpt != 0 && pxLineRpt == vgaParams.params.vPixelScale - 1u;
+
+    if (pxLineRpt == 0)
     {
-      for (int i = 0; i < 5; ++i)
-      {
-#if PICO_RP2040
-        currentBuffer[i] >>= 1;
-#else
-        currentBuffer[i] = (currentBuffer[i] >> 1) & 0x07770777;
-#endif
-      }
+      outputLine = pxLine;
     }
-    dma_channel_set_read_addr(rgbDmaChan, currentBuffer, true);
+
+    dma_channel_set_read_addr(rgbDmaChan, dimLine ? rgbLineDimSource[pxLine & 0x01] : rgbLineSource[pxLine & 0x01], true);
 
 #if PICO_RP2040
-    pio_sm_set_pindirs_with_mask(VGA_PIO, RGB_SM, (vgaParams.scanlines && (currentDisplayLine & 0x01)) - 1, (1 << 5) | (1 << 9) | (1 << 13));
+    // the dimmed copy is a plain shift: mask the bits carried into each colour's msb
+    pio_sm_set_pindirs_with_mask(VGA_PIO, RGB_SM, dimLine - 1, (1 << 5) | (1 << 9) | (1 << 13));
 #endif
 
     // need a new line every X display lines
@@ -513,32 +666,38 @@ static void __isr __time_critical_func(dmaIrqHandler)(void)
       if (requestLine < vgaParams.params.vVirtualPixels)
       {
         // bit 12 carries the current field for interlaced modes (0 or 1)
-        multicore_fifo_push_timeout_us((currentField << 12) | requestLine, 0);
+        pushRequest((currentField << 12) | requestLine);
       }
 
       if (requestLine == vgaParams.params.vVirtualPixels - 1)
       {
-        multicore_fifo_push_timeout_us(END_OF_FRAME_MSG, 0);
-      }
-    }
-    else if (vgaParams.scanlines) // apply a lame CRT effect, darkening every 2nd scanline
-    {
-      int end = vgaParams.params.hSyncParams.displayPixels / 2;
-      for (int i = 5; i < end; ++i)
-      {
-#if PICO_RP2040
-        currentBuffer[i] >>= 1;
-#else
-        currentBuffer[i] = (currentBuffer[i] >> 1) & 0x07770777;
-#endif
+        pushRequest(END_OF_FRAME_MSG);
       }
     }
     if (pxLine == vgaParams.triggerScanline &&
         pxLineRpt == vgaParams.params.vPixelScale - 1)
     {
-      multicore_fifo_push_timeout_us(END_OF_SCANLINE_MSG | pxLine, 0);
+      pushRequest(END_OF_SCANLINE_MSG | pxLine);
     }
   }
+
+  if (stopRequest)
+  {
+    dma_channel_set_irq0_enabled(syncDmaChan, false);
+    dma_channel_set_irq0_enabled(rgbDmaChan, false);
+    stopRequest = false;
+    __dmb();
+    stopAck = true;
+  }
+}
+
+/*
+ * set the sync and rgb dma channels going
+ */
+static void startDma()
+{
+  dma_channel_start(syncDmaChan);
+  dma_channel_start(rgbDmaChan);
 }
 
 /*
@@ -549,79 +708,199 @@ static void initDma()
   irq_set_exclusive_handler(DMA_IRQ_0, dmaIrqHandler);
   irq_set_enabled(DMA_IRQ_0, true);
 
-  dma_channel_start(syncDmaChan);
-  dma_channel_start(rgbDmaChan);
+  startDma();
 }
 
 
 /*
- * main vga loop
+ * end of frame deadline bookkeeping (runs on proc1)
+ *
+ * any missed line this frame steps the degradation level down one step.
+ * VGA_DEGRADE_RECOVER_FRAMES clean frames in a row step it back up
  */
-void __time_critical_func(vgaLoop)()
+static void updateDeadline()
 {
-  if (vgaParams.initFn)
+  const uint8_t maxLevel = vgaParams.repeatScanlineFn ? VGA_DEGRADE_REPEAT_LINES : VGA_DEGRADE_REPEAT_LINES - 1;
+
+  ++deadlineStats.framesAtLevel[degradeLevel];
+
+  if (missedThisFrame)
   {
-    vgaParams.initFn();
+    if (degradeLevel < maxLevel) ++degradeLevel;
+    cleanFrames = 0;
+  }
+  else if (degradeLevel != VGA_DEGRADE_NONE && ++cleanFrames >= VGA_DEGRADE_RECOVER_FRAMES)
+  {
+    --degradeLevel;
+    cleanFrames = 0;
   }
 
+  missedThisFrame = 0;
+  deadlineStats.level = degradeLevel;
+}
 
-  uint32_t frameNumber = 0;
-  while (1)
+/*
+ * do lines have a CRT-dimmed repeat?
+ */
+static inline bool crtDimLines()
+{
+  return vgaParams.scanlines && degradeLevel < VGA_DEGRADE_NO_CRT && vgaParams.params.vPixelScale > 1;
+}
+
+/*
+ * make the CRT-dimmed copy of virtual line y (runs on proc1). the shared
+ * border line already has one
+ */
+static void __time_critical_func(dimScanline)(uint32_t y, uint32_t bufferIndex)
+{
+  const uint32_t* src = rgbLineSource[y & 0x01];
+  for (int set = 0; set < 2; ++set)
+  {
+    if (src == (uint32_t*)vgaBorderLine[set][0])
+    {
+      rgbLineDimSource[y & 0x01] = (uint32_t*)vgaBorderLine[set][1];
+      return;
+    }
+  }
+
+  uint32_t* dst = (uint32_t*)rgbDimBuffer[bufferIndex];
+  const int end = vgaParams.params.hVirtualPixels / 2;
+  for (int i = 0; i < end; ++i)
+  {
+    dst[i] = vgaDimPixels(src[i]);
+  }
+  rgbLineDimSource[y & 0x01] = dst;
+}
+
+/*
+ * is a request a line request (field << 12 | line) rather than an event?
+ */
+static inline bool isLineRequest(uint32_t message)
+{
+  return (message & (FRONT_PORCH_MSG | END_OF_SCANLINE_MSG | END_OF_FRAME_MSG)) == 0;
+}
+
+/*
+ * render the line request y (field << 12 | line)
+ */
+static void __time_critical_func(vgaRenderLine)(uint32_t message)
+{
+  const int32_t y = message & 0x0fff;
+  const bool repeatLines = degradeLevel >= VGA_DEGRADE_REPEAT_LINES;
+
+  if (repeatLines && (y & 0x01))
+  {
+    // degraded: odd lines re-send the even line above
+    rgbLineSource[y & 0x01] = rgbLineSource[(y - 1) & 0x01];
+    rgbLineDimSource[y & 0x01] = rgbLineDimSource[(y - 1) & 0x01];
+    vgaParams.repeatScanlineFn(message & 0x1fff, &vgaParams.params);
+    return;
+  }
+
+  // when repeating, each even/odd pair shares a buffer, so alternate by pair
+  const uint32_t bufferIndex = repeatLines ? ((y >> 1) & 0x01) : (y & 0x01);
+
+  // get the next scanline pixels. scanlineFn may redirect the line to
+  // the shared border line instead (see vgaUseBorderLine)
+  // for interlaced modes, bit 12 of y carries the field number (0 or 1)
+  rgbLineSource[y & 0x01] = (uint32_t*)rgbDataBuffer[bufferIndex];
+  dimLineClaimed = false;
+  vgaParams.scanlineFn(message & 0x1fff, &vgaParams.params,
+                       rgbDataBuffer[bufferIndex]);
+
+  // did the dma start sending this line before we finished it?
+  if (outputLine >= y)
   {
-    uint32_t message = multicore_fifo_pop_blocking();
+    ++missedThisFrame;
+    ++deadlineStats.missedLines;
+  }
+
+  if (crtDimLines())
+  {
+    // scanlineFn dimmed the line as it wrote it?
+    if (dimLineClaimed && rgbLineSource[y & 0x01] == (uint32_t*)rgbDataBuffer[bufferIndex])
+      rgbLineDimSource[y & 0x01] = (uint32_t*)rgbDimBuffer[bufferIndex];
+    else
+      dimScanline(y, bufferIndex);
+  }
+}
+
+/*
+ * handle the next request from the dma irq (vgaLoop). sleeps until one arrives
+ *
+ * a line request with more line requests queued behind it is already late,
+ * so it's skipped in favour of the latest one. the skip stops at any event
+ * (porch, scanline, end of frame), which stays queued to be handled in turn,
+ * after the line it follows
+ */
+static void __time_critical_func(vgaServiceRequest)(uint32_t* frameNumber)
+{
+  uint32_t message = popRequest();
 
-    if (message == FRONT_PORCH_MSG)
+  if (message == FRONT_PORCH_MSG)
+  {
+    if (vgaParams.porchFn)
     {
-      if (vgaParams.porchFn)
-      {
-        vgaParams.porchFn();
-      }
+      vgaParams.porchFn();
     }
-    else if (message == END_OF_FRAME_MSG)
+  }
+  else if (message == END_OF_FRAME_MSG)
+  {
+    updateDeadline();
+    if (vgaParams.endOfFrameFn)
     {
-      if (vgaParams.endOfFrameFn)
-      {
-        vgaParams.endOfFrameFn(frameNumber);
-        ++frameNumber;
-      }
+      vgaParams.endOfFrameFn(*frameNumber);
+      ++*frameNumber;
     }
-    else if ((message & END_OF_SCANLINE_MSG) != 0)
+  }
+  else if ((message & END_OF_SCANLINE_MSG) != 0)
+  {
+    if (vgaParams.endOfScanlineFn)
     {
-      if (vgaParams.endOfScanlineFn)
-      {
-        vgaParams.endOfScanlineFn(message & 0x0fff);
-      }
+      vgaParams.endOfScanlineFn(message & 0x0fff);
     }
-    else
+  }
+  else
+  {
+    // line 0 (of either field) arrives with line 1 already queued behind it
+    // (see dmaIrqHandler)
+    if ((message & 0x0fff) != 0)
     {
-      bool doEof = false;
-      if (message != 0)
+      while (requestPending() && isLineRequest(peekRequest()))
       {
-        while (multicore_fifo_rvalid()) // if we dropped a scanline, no point rendering it now
-        {
-          uint32_t nextMessage = sio_hw->fifo_rd;
-          if (nextMessage == END_OF_FRAME_MSG)
-          {
-            doEof = true;
-          }
-          else
-          {
-            message = nextMessage;
-          }
-        }
+        message = popRequest();
+        ++missedThisFrame;
+        ++deadlineStats.missedLines;
       }
+    }
+
+    vgaRenderLine(message);
+  }
+}
 
-      // get the next scanline pixels
-      // for interlaced modes, bit 12 of y carries the field number (0 or 1)
-      vgaParams.scanlineFn(message & 0x1fff, &vgaParams.params,
-                           rgbDataBuffer[message & 0x01]);
-      if (doEof && vgaParams.endOfFrameFn)
+/*
+ * main vga loop
+ */
+void __time_critical_func(vgaLoop)()
+{
+  if (vgaParams.initFn)
+  {
+    vgaParams.initFn();
+  }
+
+  uint32_t frameNumber = 0;
+  while (1)
+  {
+    // idle work must be short - the next line request is already on its way
+    if (vgaParams.idleFn)
+    {
+      while (!requestPending())
       {
-        vgaParams.endOfFrameFn(frameNumber);
-        ++frameNumber;
+        vgaParams.idleFn();
       }
-
     }
+
+    vgaServiceRequest(&frameNumber);
   }
 }
 
@@ -632,6 +911,21 @@ void vgaInit(VgaInitParams params)
 {
   vgaParams = params;
 
+  rgbLineSource[0] = (uint32_t*)rgbDataBuffer[0];
+  rgbLineSource[1] = (uint32_t*)rgbDataBuffer[1];
+  rgbLineDimSource[0] = (uint32_t*)rgbDimBuffer[0];
+  rgbLineDimSource[1] = (uint32_t*)rgbDimBuffer[1];
+
+  // fixed channels, claimed once. vgaRestart() reuses them
+  syncDmaChan = SYNC_DMA_CHAN;
+  syncCtrlDmaChan = SYNC_CTRL_DMA_CHAN;
+  rgbDmaChan = RGB_DMA_CHAN;
+  dma_channel_claim(syncDmaChan);
+  dma_channel_claim(syncCtrlDmaChan);
+  dma_channel_claim(rgbDmaChan);
+  syncDmaChanMask = 0x01 << syncDmaChan;
+  rgbDmaChanMask = 0x01 << rgbDmaChan;
+
   vgaInitSync();
   vgaInitRgb();
 
@@ -641,6 +935,68 @@ void vgaInit(VgaInitParams params)
   pio_sm_set_enabled(VGA_PIO, RGB_SM, true);
 }
 
+/*
+ * stop the vga output: both state machines, the dma and its interrupts
+ *
+ * call from proc1 (a vgaLoop callback). the dma irq itself runs on proc0
+ */
+void vgaStop()
+{
+  // the next dma irq (within a line) turns the interrupts off and acks.
+  // once it has, nothing can retrigger a channel we're about to abort
+  stopAck = false;
+  __dmb();
+  stopRequest = true;
+  while (!stopAck)
+    tight_loop_contents();
+  __dmb();
+
+  pio_sm_set_enabled(VGA_PIO, SYNC_SM, false);
+  pio_sm_set_enabled(VGA_PIO, RGB_SM, false);
+
+  // disable before aborting so an aborted sync line can't chain to the
+  // control channel (the chain trigger ignores a disabled channel)
+  const uint32_t mask = (1u << syncCtrlDmaChan) | syncDmaChanMask | rgbDmaChanMask;
+  hw_clear_bits(&dma_hw->ch[syncDmaChan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+  hw_clear_bits(&dma_hw->ch[syncCtrlDmaChan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+  hw_clear_bits(&dma_hw->ch[rgbDmaChan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+  dma_hw->abort = mask;
+  while (dma_hw->abort & mask)
+    tight_loop_contents();
+
+  dma_hw->ints0 = mask;
+}
+
+/*
+ * restart the vga output after vgaStop() in a new mode at the same system
+ * clock. rebuilds the sync data, the sync dma chain and both pio
+ * programs (clock dividers and the rgb pixel delay)
+ *
+ * call from proc1 (a vgaLoop callback)
+ */
+void vgaRestart(VgaInitParams params)
+{
+  pio_remove_program(VGA_PIO, &vga_sync_program, syncProgOffset);
+  pio_remove_program(VGA_PIO, &vga_rgb_program, rgbProgOffset);
+
+  vgaParams = params;
+  borderColor = 0xffffffff;   // the next vgaSetBorderColor() refills at the new width
+
+  // drop anything queued for the old mode. the irq is stopped and vgaLoop
+  // is on this core, so nothing else touches the ring
+  requestTail = requestHead;
+  outputLine = -1;
+
+  vgaInitSync();
+  vgaInitRgb();
+  pio_interrupt_clear(VGA_PIO, vga_rgb_RGB_IRQ);
+
+  startDma();
+
+  pio_sm_set_enabled(VGA_PIO, SYNC_SM, true);
+  pio_sm_set_enabled(VGA_PIO, RGB_SM, true);
+}
+
 VgaInitParams *vgaCurrentParams()
 {
   return &vgaParams;
@@ -649,4 +1005,79 @@ VgaInitParams *vgaCurrentParams()
 void vgaSetTriggerScanline(uint32_t scanline)
 {
   vgaParams.triggerScanline = scanline;
-}
\ No newline at end of file
+}
+
+/*
+ * set the colour of the shared border line (two packed pixels)
+ *
+ * only rebuilds the line when the colour changes, into the inactive set,
+ * then makes that set active. the previous line (still being scanned out)
+ * keeps the old set. call at the start of each line. the trailing guard
+ * word is left as zeros (black), matching the line buffers.
+ */
+void __time_critical_func(vgaSetBorderColor)(uint32_t pixels2)
+{
+  if (pixels2 == borderColor)
+    return;
+
+  borderColor = pixels2;
+
+  const uint32_t dimmed = vgaDimPixels(pixels2);
+
+  const uint32_t set = borderSet ^ 1;
+  uint32_t* line = (uint32_t*)vgaBorderLine[set][0];
+  uint32_t* lineDim = (uint32_t*)vgaBorderLine[set][1];
+  const int end = vgaParams.params.hVirtualPixels / 2;
+  for (int i = 0; i < end; ++i)
+  {
+    line[i] = pixels2;
+    lineDim[i] = dimmed;
+  }
+  borderSet = set;
+}
+
+/*
+ * scan out virtual line y from the shared border line rather than its
+ * line buffer. only valid for the line currently being generated
+ */
+void __time_critical_func(vgaUseBorderLine)(uint16_t y)
+{
+  rgbLineSource[y & 0x01] = (uint32_t*)vgaBorderLine[borderSet][0];
+}
+
+/*
+ * index (0 or 1) of a line buffer passed to scanlineFn
+ */
+uint32_t vgaLineBufferIndex(const uint16_t* pixels)
+{
+  return pixels == rgbDataBuffer[1];
+}
+
+/*
+ * the CRT-dimmed twin of a line buffer passed to scanlineFn, for scanlineFn
+ * to fill in full as it writes the line. NULL if the line has no dimmed repeat
+ */
+uint16_t* __time_critical_func(vgaClaimDimLine)(const uint16_t* pixels)
+{
+  if (!crtDimLines())
+    return NULL;
+
+  dimLineClaimed = true;
+  return rgbDimBuffer[vgaLineBufferIndex(pixels)];
+}
+
+/*
+ * current scanline deadline degradation level (VGA_DEGRADE_*)
+ */
+uint8_t vgaDegradeLevel()
+{
+  return degradeLevel;
+}
+
+/*
+ * scanline deadline statistics
+ */
+const VgaDeadlineStats *vgaDeadlineStats()
+{
+  return &deadlineStats;
+}
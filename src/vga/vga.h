@@ -78,8 +78,9 @@ typedef struct
   float pioClocksPerScaledPixel;
   float frameRateHz;                          // effective frame rate (e.g. 60, 50)
   bool interlaced;
+  bool fieldSync;                           // composite sync from fields[] (all SCART modes)
   uint8_t interlacedFieldOrder;             // 0 or 1: XOR'd with field number for double-row mapping
-  uint8_t numFields;                        // 1 = progressive, 2 = interlaced
+  uint8_t numFields;                        // 1 = progressive, 2 = interlaced (fieldSync only)
   uint8_t hPixelScale;
   uint8_t vPixelScale;
   uint8_t shortPulsePixels;                 // EQ pulse low duration in pixels (interlaced only)
@@ -93,6 +94,27 @@ typedef void (*vgaEndOfFrameFn)(uint32_t frameNumber);
 typedef void (*vgaPorchFn)();
 typedef void (*vgaInitFn)();
 typedef void (*vgaEndOfScanlineFn)(uint32_t displayLine);
+typedef void (*vgaRepeatScanlineFn)(uint16_t y, VgaParams* params);
+typedef void (*vgaIdleFn)();
+
+// scanline deadline degradation levels. each level includes those before it
+typedef enum
+{
+  VGA_DEGRADE_NONE = 0,
+  VGA_DEGRADE_NO_CRT,          // skip the CRT scanline effect
+  VGA_DEGRADE_NO_PAL_REFRESH,  // scanlineFn: no per-line palette cache refresh
+  VGA_DEGRADE_REPEAT_LINES,    // odd lines repeat the line above (needs repeatScanlineFn)
+  VGA_DEGRADE_LEVELS
+} VgaDegradeLevel;
+
+typedef struct
+{
+  uint32_t missedLines;                          // lines not ready when the dma needed them
+  uint32_t framesAtLevel[VGA_DEGRADE_LEVELS];    // frames spent at each level
+  uint32_t droppedRequests;                      // line requests lost to a full request ring
+  uint32_t maxQueuedRequests;                    // deepest request backlog vgaLoop has seen
+  uint8_t level;                                 // current level
+} VgaDeadlineStats;
 
 extern uint32_t vgaMinimumPioClockKHz(VgaParams* params);
 
@@ -104,6 +126,8 @@ typedef struct
   vgaEndOfFrameFn endOfFrameFn;
   vgaEndOfScanlineFn endOfScanlineFn;
   vgaPorchFn porchFn;
+  vgaRepeatScanlineFn repeatScanlineFn;  // state-only update for a repeated line. optional
+  vgaIdleFn idleFn;                      // polled while waiting for the next request. optional
   bool scanlines;
   uint32_t triggerScanline;  // scanline to fire endOfScanlineFn on; UINT32_MAX to disable
 } VgaInitParams;
@@ -112,6 +136,48 @@ void vgaLoop();
 
 void vgaInit(VgaInitParams params);
 
+/* stop the output ahead of a mode change. call from proc1 */
+void vgaStop();
+
+/* restart the output stopped by vgaStop() with new params. call from proc1 */
+void vgaRestart(VgaInitParams params);
+
 VgaInitParams *vgaCurrentParams();
 
 void vgaSetTriggerScanline(uint32_t scanline);
+
+/* set the colour of the shared border line (two packed pixels) */
+void vgaSetBorderColor(uint32_t pixels2);
+
+/* scan out line y from the shared border line. call from scanlineFn */
+void vgaUseBorderLine(uint16_t y);
+
+/* index (0 or 1) of a line buffer passed to scanlineFn */
+uint32_t vgaLineBufferIndex(const uint16_t* pixels);
+
+/*
+ * the CRT-dimmed twin of a line buffer passed to scanlineFn, for scanlineFn
+ * to fill in full (vgaDimPixels() of every pixel pair) as it writes the
+ * line. NULL if the line has no dimmed repeat. once claimed, vgaLoop
+ * doesn't make its own dimmed copy of the line
+ */
+uint16_t* vgaClaimDimLine(const uint16_t* pixels);
+
+/*
+ * CRT-dimmed pixel pair. the RP2040 masks the bits carried into each
+ * colour's msb with its pin directions rather than here
+ */
+static inline uint32_t vgaDimPixels(uint32_t pixels2)
+{
+#if PICO_RP2040
+  return pixels2 >> 1;
+#else
+  return (pixels2 >> 1) & 0x07770777;
+#endif
+}
+
+/* current scanline deadline degradation level (VGA_DEGRADE_*) */
+uint8_t vgaDegradeLevel();
+
+/* scanline deadline statistics */
+const VgaDeadlineStats *vgaDeadlineStats();
@@ -0,0 +1,94 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for the vrEmuTms9918 private header: the vdp state the boot
+ * path touches. the emulator itself is stubbed in boot_hw.c
+ */
+
+#include "pico.h"
+
+#define TMS9918_PIXELS_X 256
+#define TMS9918_PIXELS_Y 192
+
+#define STATUS_INT 0x80
+#define STATUS_5S  0x40
+#define STATUS_COL 0x20
+
+typedef enum
+{
+  TMS_MODE_GRAPHICS_I,
+  TMS_MODE_GRAPHICS_II,
+  TMS_MODE_TEXT,
+  TMS_MODE_MULTICOLOR,
+  TMS_MODE_TEXT80,
+} vrEmuTms9918Mode;
+
+typedef enum
+{
+  TMS_REG_0,
+  TMS_REG_1,
+  TMS_REG_NAME_TABLE,
+  TMS_REG_COLOR_TABLE,
+  TMS_REG_PATTERN_TABLE,
+  TMS_REG_SPRITE_ATTR_TABLE,
+  TMS_REG_SPRITE_PATT_TABLE,
+  TMS_REG_FG_BG_COLOR,
+} vrEmuTms9918Register;
+
+typedef struct
+{
+  uint8_t registers[64];
+  uint8_t status[16];
+  uint8_t config[256];
+
+  union
+  {
+    uint8_t bytes[0x10000];
+    struct
+    {
+      uint8_t vram[0x4000];
+      uint8_t gram1[0x1000];
+      uint8_t gram2[0x1000];
+      uint16_t pram[64];
+      uint8_t blanking;
+      uint8_t scanline;
+    } map;
+  } vram;
+
+  volatile bool palDirty;
+  volatile bool restart;
+  volatile bool flash;
+  volatile bool isUnlocked;
+  volatile bool configDirty;
+  uint8_t regWriteStage;
+  uint16_t gpuAddress;
+} VrEmuTms9918;
+
+extern VrEmuTms9918 *tms9918;
+
+#define TMS_REGISTER(t, r) ((t)->registers[r])
+#define TMS_STATUS(t, r) ((t)->status[r])
+
+void vrEmuTms9918Init(void);
+void vrEmuTms9918Reset(void);
+uint8_t vrEmuTms9918ScanLine(uint8_t y, uint8_t pixels[]);
+uint8_t vrEmuTms9918RegValue(vrEmuTms9918Register reg);
+vrEmuTms9918Mode vrEmuTms9918DisplayMode(VrEmuTms9918 *tms);
+void vrEmuTms9918SetStatusImpl(uint8_t status);
+bool vrEmuTms9918InterruptStatusImpl(void);
+void vrEmuTms9918WriteAddrImpl(uint8_t data);
+void vrEmuTms9918WriteDataImpl(uint8_t data);
+uint8_t vrEmuTms9918ReadDataNoIncImpl(void);
+uint8_t vrEmuTms9918ReadAheadDataImpl(void);
+uint16_t vrEmuTms9918DefaultPalette(int index);
@@ -0,0 +1,18 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for the vrEmuTms9918 utility header (see impl/)
+ */
+
+#include "impl/vrEmuTms9918Priv.h"
@@ -0,0 +1,414 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * host stubs for booting main.c (see boot_hw.h)
+ *
+ * time is virtual: only the calls that take time on the board advance it,
+ * by the sleep asked for or the typical figure from the part's datasheet.
+ * simFlash is the flash and its xip window in one, so the cache flush
+ * after a program (writes to the window) lands in it and the verify that
+ * follows retries: the record keeps what was programmed. proc1 runs on its
+ * own thread. multicore_launch_core1() waits for it to
+ * reach multicore_fifo_pop_blocking(), where it parks for good, so the
+ * record doesn't depend on the host's scheduling
+ */
+
+#include "boot_hw.h"
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "hardware/vreg.h"
+#include "pico/multicore.h"
+#include "pico/time.h"
+
+#include "config.h"
+#include "convert.h"
+#include "diag.h"
+#include "gpu.h"
+#include "splash.h"
+#include "temperature.h"
+#include "vga.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BOOT_MAX_EVENTS       256
+#define BOOT_PLL_LOCK_US      1       // pll relock while clk_sys runs from clk_ref
+#define BOOT_SECTOR_ERASE_US  45000   // 4 KB sector erase, typical (W25Q16JV)
+#define BOOT_PAGE_PROGRAM_US  700     // 256 byte page program, typical
+
+uint8_t simFlash[BOOT_FLASH_BYTES];
+jmp_buf bootExit;
+
+static BootEvent events[BOOT_MAX_EVENTS];
+static uint32_t eventCount;
+static uint64_t nowUs;
+static bool dongle;
+static uint32_t gpioOut;
+static __thread int core;
+
+static pio_hw_t bootPioRegs[2];
+pio_hw_t *const pio0_hw = &bootPioRegs[0];
+pio_hw_t *const pio1_hw = &bootPioRegs[1];
+static uint8_t pioUsed[2];
+
+static dma_hw_t bootDma;
+dma_hw_t *const dma_hw = &bootDma;
+
+static VrEmuTms9918 vdp;
+VrEmuTms9918 *tms9918 = &vdp;
+
+static pthread_t proc1;
+static pthread_mutex_t parkLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t parkCond = PTHREAD_COND_INITIALIZER;
+static bool parked;
+static jmp_buf parkExit;
+
+static void record(BootEventType type, uint32_t a, uint32_t b, uint32_t c)
+{
+  if (eventCount == BOOT_MAX_EVENTS)
+  {
+    fprintf(stderr, "boot: event log full\n");
+    abort();
+  }
+  events[eventCount++] = (BootEvent){ type, nowUs, core, a, b, c };
+}
+
+void bootHwReset(bool scartDongle)
+{
+  memset(simFlash, 0xff, sizeof(simFlash));
+  memset(bootPioRegs, 0, sizeof(bootPioRegs));
+  memset(pioUsed, 0, sizeof(pioUsed));
+  memset(&vdp, 0, sizeof(vdp));
+  eventCount = 0;
+  nowUs = 0;
+  gpioOut = 0;
+  dongle = scartDongle;
+  parked = false;
+  core = 0;
+}
+
+const BootEvent *bootEvents(uint32_t *count)
+{
+  *count = eventCount;
+  return events;
+}
+
+/* time */
+
+uint64_t time_us_64(void)
+{
+  return nowUs;
+}
+
+uint32_t time_us_32(void)
+{
+  return (uint32_t)nowUs;
+}
+
+void busy_wait_us_32(uint32_t us)
+{
+  nowUs += us;
+}
+
+void sleep_us(uint64_t us)
+{
+  nowUs += us;
+}
+
+void sleep_ms(uint32_t ms)
+{
+  nowUs += (uint64_t)ms * 1000;
+}
+
+/* clocks and power */
+
+uint32_t clock_get_hz(enum clock_index clock)
+{
+  (void)clock;
+  return 125000000;
+}
+
+bool set_sys_clock_pll(uint32_t vcoFreq, uint postDiv1, uint postDiv2)
+{
+  record(BOOT_EVENT_CLOCK, vcoFreq, postDiv1, postDiv2);
+  nowUs += BOOT_PLL_LOCK_US;
+  return true;
+}
+
+bool set_sys_clock_khz(uint32_t freqKHz, bool required)
+{
+  (void)required;
+  return set_sys_clock_pll(freqKHz * 1000, 1, 1);
+}
+
+void vreg_set_voltage(enum vreg_voltage voltage)
+{
+  record(BOOT_EVENT_VREG, voltage, 0, 0);
+}
+
+/* flash */
+
+void flash_range_erase(uint32_t flashOffs, size_t count)
+{
+  record(BOOT_EVENT_FLASH_ERASE, flashOffs, (uint32_t)count, 0);
+  memset(simFlash + flashOffs, 0xff, count);
+  nowUs += (count + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE * BOOT_SECTOR_ERASE_US;
+}
+
+void flash_range_program(uint32_t flashOffs, const uint8_t *data, size_t count)
+{
+  record(BOOT_EVENT_FLASH_PROGRAM, flashOffs, (uint32_t)count, count ? data[0] : 0);
+  for (size_t i = 0; i < count; ++i)
+    simFlash[flashOffs + i] &= data[i];
+  nowUs += (count + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * BOOT_PAGE_PROGRAM_US;
+}
+
+/* gpio. a scart dongle bridges the two sync pins */
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_init_mask(uint32_t mask) { (void)mask; }
+void gpio_set_function_masked(uint32_t mask, enum gpio_function fn) { (void)mask; (void)fn; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_set_dir_masked(uint32_t mask, uint32_t value) { (void)mask; (void)value; }
+void gpio_set_dir_all_bits(uint32_t values) { (void)values; }
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) { (void)gpio; (void)drive; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+void gpio_pull_down(uint gpio) { (void)gpio; }
+void gpio_disable_pulls(uint gpio) { (void)gpio; }
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) { (void)gpio; (void)events; (void)enabled; }
+void gpio_acknowledge_irq(uint gpio, uint32_t events) { (void)gpio; (void)events; }
+
+void gpio_put(uint gpio, bool value)
+{
+  gpioOut = value ? (gpioOut | (1u << gpio)) : (gpioOut & ~(1u << gpio));
+}
+
+void gpio_put_all(uint32_t value)
+{
+  gpioOut = value;
+}
+
+void gpio_set_mask(uint32_t mask)
+{
+  gpioOut |= mask;
+}
+
+void gpio_clr_mask(uint32_t mask)
+{
+  gpioOut &= ~mask;
+}
+
+bool gpio_get(uint gpio)
+{
+  if (dongle && gpio == VGA_SYNC_PINS_START + 1)
+    return (gpioOut >> VGA_SYNC_PINS_START) & 1;
+  return (gpioOut >> gpio) & 1;
+}
+
+/* irqs and events: nothing fires during the boot. barriers and events are recorded */
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) { (void)num; (void)handler; }
+void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
+void irq_set_priority(uint num, uint8_t priority) { (void)num; (void)priority; }
+void irq_clear(uint num) { (void)num; }
+void __dmb(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  record(BOOT_EVENT_DMB, tms9918->restart, 0, 0);
+}
+
+void __sev(void) { record(BOOT_EVENT_SEV, tms9918->restart, 0, 0); }
+void __wfe(void) {}
+void __wfi(void) {}
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t status) { (void)status; }
+
+/* pio */
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+  const int p = pio == pio1 ? 1 : 0;
+  if (pioUsed[p] + program->length > PIO_INSTRUCTION_COUNT)
+  {
+    fprintf(stderr, "boot: pio%d instruction memory full\n", p);
+    abort();
+  }
+  const uint offset = pioUsed[p];
+  pioUsed[p] += program->length;
+  return offset;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initialPc, const pio_sm_config *config)
+{
+  (void)initialPc; (void)config;
+  pio->ctrl &= ~(1u << sm);
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+  record(BOOT_EVENT_SM_ENABLE, pio == pio1 ? 1 : 0, sm, enabled);
+  pio->ctrl = enabled ? (pio->ctrl | (1u << sm)) : (pio->ctrl & ~(1u << sm));
+}
+
+void pio_gpio_init(PIO pio, uint pin) { (void)pio; (void)pin; }
+void pio_sm_put(PIO pio, uint sm, uint32_t data) { (void)pio; (void)sm; (void)data; }
+void pio_sm_clear_fifos(PIO pio, uint sm) { (void)pio; (void)sm; }
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div) { (void)pio; (void)sm; (void)div; }
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint base, uint count, bool isOut) { (void)pio; (void)sm; (void)base; (void)count; (void)isOut; }
+void pio_set_irq0_source_enabled(PIO pio, uint source, bool enabled) { (void)pio; (void)source; (void)enabled; }
+void pio_set_irq1_source_enabled(PIO pio, uint source, bool enabled) { (void)pio; (void)source; (void)enabled; }
+
+/* dma: configured, never started during the boot */
+
+void dma_channel_claim(uint chan) { (void)chan; }
+void dma_channel_set_config(uint chan, const dma_channel_config *config, bool trigger) { (void)chan; (void)config; (void)trigger; }
+void dma_channel_set_read_addr(uint chan, const volatile void *readAddr, bool trigger) { (void)chan; (void)readAddr; (void)trigger; }
+void dma_channel_set_write_addr(uint chan, volatile void *writeAddr, bool trigger) { (void)chan; (void)writeAddr; (void)trigger; }
+void dma_channel_set_trans_count(uint chan, uint32_t count, bool trigger) { (void)chan; (void)count; (void)trigger; }
+void dma_channel_wait_for_finish_blocking(uint chan) { (void)chan; }
+
+/* proc1 */
+
+static void *proc1Thread(void *arg)
+{
+  core = 1;
+  if (!setjmp(parkExit))
+    ((void (*)(void))arg)();
+
+  pthread_mutex_lock(&parkLock);
+  parked = true;
+  pthread_cond_signal(&parkCond);
+  pthread_mutex_unlock(&parkLock);
+  return NULL;
+}
+
+void multicore_launch_core1(void (*entry)(void))
+{
+  record(BOOT_EVENT_LAUNCH, 0, 0, 0);
+  if (pthread_create(&proc1, NULL, proc1Thread, (void *)entry))
+  {
+    fprintf(stderr, "boot: can't start proc1\n");
+    abort();
+  }
+
+  pthread_mutex_lock(&parkLock);
+  while (!parked)
+    pthread_cond_wait(&parkCond, &parkLock);
+  pthread_mutex_unlock(&parkLock);
+  pthread_join(proc1, NULL);
+}
+
+uint32_t multicore_fifo_pop_blocking(void)
+{
+  if (core != 1)
+  {
+    fprintf(stderr, "boot: core 0 waiting on the fifo\n");
+    abort();
+  }
+  record(BOOT_EVENT_PARK, 0, 0, 0);
+  longjmp(parkExit, 1);
+}
+
+void multicore_fifo_push_blocking(uint32_t data)
+{
+  (void)data;
+}
+
+/* the vdp emulator */
+
+void vrEmuTms9918Init(void) { memset(&vdp, 0, sizeof(vdp)); }
+void vrEmuTms9918Reset(void) {}
+uint8_t vrEmuTms9918ScanLine(uint8_t y, uint8_t pixels[]) { (void)y; (void)pixels; return 0; }
+uint8_t vrEmuTms9918RegValue(vrEmuTms9918Register reg) { return vdp.registers[reg]; }
+vrEmuTms9918Mode vrEmuTms9918DisplayMode(VrEmuTms9918 *tms) { (void)tms; return TMS_MODE_GRAPHICS_I; }
+void vrEmuTms9918SetStatusImpl(uint8_t status) { (void)status; }
+bool vrEmuTms9918InterruptStatusImpl(void) { return false; }
+void vrEmuTms9918WriteAddrImpl(uint8_t data) { record(BOOT_EVENT_TMS_ADDR, data, 0, 0); }
+void vrEmuTms9918WriteDataImpl(uint8_t data) { (void)data; }
+uint8_t vrEmuTms9918ReadDataNoIncImpl(void) { return 0; }
+uint8_t vrEmuTms9918ReadAheadDataImpl(void) { return 0; }
+uint16_t vrEmuTms9918DefaultPalette(int index) { return (uint16_t)(index * 0x111); }
+
+/* the vga output */
+
+static VgaInitParams vgaParams;
+
+void vgaInit(VgaInitParams params)
+{
+  vgaParams = params;
+  record(BOOT_EVENT_VGA_INIT, 0, 0, 0);
+}
+
+void vgaLoop()
+{
+  fprintf(stderr, "boot: proc1 ran past the fifo\n");
+  abort();
+}
+
+void vgaStop() {}
+void vgaRestart(VgaInitParams params) { vgaParams = params; }
+VgaInitParams *vgaCurrentParams() { return &vgaParams; }
+void vgaSetTriggerScanline(uint32_t scanline) { (void)scanline; }
+void vgaSetBorderColor(uint32_t pixels2) { (void)pixels2; }
+void vgaUseBorderLine(uint16_t y) { (void)y; }
+uint32_t vgaLineBufferIndex(const uint16_t *pixels) { (void)pixels; return 0; }
+uint16_t *vgaClaimDimLine(const uint16_t *pixels) { (void)pixels; return NULL; }
+uint8_t vgaDegradeLevel() { return 0; }
+
+/* the gpu: the boot ends as core 0 enters its loop */
+
+extern inline void gpuTrigger();
+
+void gpuInit() {}
+
+void gpuLoop()
+{
+  record(BOOT_EVENT_GPU_LOOP, 0, 0, 0);
+  longjmp(bootExit, 1);
+}
+
+/* diagnostics, splash, temperature and scanline conversion: not reached */
+
+void initDiagnostics() {}
+void diagSetTemperature(float tempC) { (void)tempC; }
+void diagSetClockHz(float clockHz) { (void)clockHz; }
+void diagSetModeFallback(bool fallback) { (void)fallback; }
+void diagBootPhase(DiagBootPhase phase) { record(BOOT_EVENT_PHASE, phase, 0, 0); }
+void diagnosticsConfigUpdated() {}
+void updateDiagnostics(uint32_t frameCount) { (void)frameCount; }
+void updateRenderTime(uint32_t renderTime, uint32_t frameTime) { (void)renderTime; (void)frameTime; }
+int renderText(uint16_t scanline, const char *text, uint16_t x, uint16_t y, uint16_t fg, uint16_t bg, uint16_t *pixels)
+{
+  (void)scanline; (void)text; (void)x; (void)y; (void)fg; (void)bg; (void)pixels;
+  return 0;
+}
+void renderDiagnostics(uint16_t y, uint16_t *pixels) { (void)y; (void)pixels; }
+void resetSplash() {}
+void allowSplashHide() {}
+void outputSplash(uint16_t y, uint32_t frameCount, uint32_t vBorder, uint32_t vPixels, uint16_t *pixels)
+{
+  (void)y; (void)frameCount; (void)vBorder; (void)vPixels; (void)pixels;
+}
+void initTemperature() {}
+float coreTemperatureC() { return 25.0f; }
+void convertScanline(const uint8_t *src, uint32_t *dst, const uint32_t *pal, int count) { (void)src; (void)dst; (void)pal; (void)count; }
+void convertScanlineDim(const uint8_t *src, uint32_t *dst, uint32_t *dstDim, const uint32_t *pal, int count) { (void)src; (void)dst; (void)dstDim; (void)pal; (void)count; }
+void expandPalette(const uint16_t *f18aPal, uint32_t *pal, int count) { (void)f18aPal; (void)pal; (void)count; }
+void expandPalettePairs(const uint16_t *f18aPal, uint32_t *pal) { (void)f18aPal; (void)pal; }
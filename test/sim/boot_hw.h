@@ -0,0 +1,59 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stubs for booting main.c: the sdk calls and the firmware modules
+ * main() reaches, on a virtual clock. they record what the boot does to
+ * the system clock, the state machines and the flash, and when
+ */
+
+#include "pico.h"
+
+#include <setjmp.h>
+
+/* the flash window readConfig() and friends read (XIP_BASE) */
+#define BOOT_FLASH_BYTES 0x200000
+
+typedef enum
+{
+  BOOT_EVENT_VREG,          // vreg_set_voltage: a = voltage
+  BOOT_EVENT_CLOCK,         // set_sys_clock_pll: a = vco Hz, b = postdiv1, c = postdiv2
+  BOOT_EVENT_LAUNCH,        // multicore_launch_core1
+  BOOT_EVENT_SM_ENABLE,     // pio_sm_set_enabled: a = pio, b = sm, c = enabled
+  BOOT_EVENT_FLASH_ERASE,   // flash_range_erase: a = offset, b = bytes
+  BOOT_EVENT_FLASH_PROGRAM, // flash_range_program: a = offset, b = bytes, c = first byte
+  BOOT_EVENT_PHASE,         // diagBootPhase: a = phase
+  BOOT_EVENT_VGA_INIT,      // vgaInit
+  BOOT_EVENT_PARK,          // proc1 waiting on the fifo
+  BOOT_EVENT_GPU_LOOP,      // core 0 handed to the gpu: the end of the boot
+  BOOT_EVENT_TMS_ADDR,      // vrEmuTms9918WriteAddrImpl (a register write's flags stored): a = byte
+  BOOT_EVENT_DMB,           // __dmb: a = the gpu trigger flag (restart) then
+  BOOT_EVENT_SEV,           // __sev: a = the gpu trigger flag (restart) then
+} BootEventType;
+
+typedef struct
+{
+  BootEventType type;
+  uint64_t us;              // virtual time since reset
+  int core;
+  uint32_t a, b, c;
+} BootEvent;
+
+/* a cold board: erased flash, nothing recorded, time zero */
+void bootHwReset(bool scartDongle);
+
+/* the events recorded since the reset, in order */
+const BootEvent *bootEvents(uint32_t *count);
+
+/* gpuLoop() returns here (longjmp value 1) */
+extern jmp_buf bootExit;
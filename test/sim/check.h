@@ -0,0 +1,51 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+ * minimal assertions for the host simulator tests. a test counts failures
+ * and returns checkResult() from main() so ctest sees a non-zero exit
+ */
+
+static int checkFailures = 0;
+
+#define CHECK(cond, ...) \
+  do { if (!(cond)) { ++checkFailures; printf("FAIL %s:%d: ", __FILE__, __LINE__); printf(__VA_ARGS__); printf("\n"); } } while (0)
+
+#define CHECK_EQ(actual, expected, ...) \
+  do { \
+    const long long checkA = (long long)(actual), checkE = (long long)(expected); \
+    if (checkA != checkE) { ++checkFailures; printf("FAIL %s:%d: %s = %lld, expected %lld: ", \
+      __FILE__, __LINE__, #actual, checkA, checkE); printf(__VA_ARGS__); printf("\n"); } \
+  } while (0)
+
+static inline int checkResult(const char *name)
+{
+  if (checkFailures)
+    printf("%s: %d failure(s)\n", name, checkFailures);
+  else
+    printf("%s: ok\n", name);
+  return checkFailures != 0;
+}
+
+/* deterministic xorshift32 so failures reproduce */
+static inline uint32_t checkRand(uint32_t *state)
+{
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
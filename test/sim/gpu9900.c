@@ -0,0 +1,940 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * the 9900 gpu interpreter model (see gpu9900.h)
+ *
+ * memory is big endian, as the 9900 sees it. handlers take the operands
+ * decoded (gpu9900.h) and resolve what's left at run time: the address in
+ * a register for *Rn, *Rn+ and @addr(Rn). the status bits a handler keeps
+ * are run9900's ("initialised ST")
+ */
+
+#include "gpu9900.h"
+
+#include <string.h>
+
+#define ST_LGT  0x8000
+#define ST_AGT  0x4000
+#define ST_EQ   0x2000
+#define ST_C    0x1000
+#define ST_OV   0x0800
+#define ST_OP   0x0400
+
+#define VREGS   0x6000          // the video registers, as run9900 maps them
+
+typedef enum
+{
+  FMT_NONE,                     // not implemented: a no-op
+  FMT_1,                        // two general operands (byte if B set)
+  FMT_3,                        // a general source, a register (D) destination
+  FMT_5,                        // shift: register, count
+  FMT_6,                        // a general operand
+  FMT_8I,                       // register and immediate
+  FMT_8R,                       // register
+  FMT_IMM,                      // immediate
+  FMT_0,                        // nothing
+  FMT_JUMP,                     // displacement
+  FMT_CRU,                      // LDCR, STCR: skip a symbolic operand's word
+} Format;
+
+typedef struct
+{
+  Gpu9900Handler handler;
+  uint8_t format;
+} OpEntry;
+
+static OpEntry opTable[2048];  // instruction >> 5, as JMPTBL
+
+/* memory */
+
+static inline uint16_t rd16(const uint8_t *p)
+{
+  return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+/* a written word a cache entry was decoded from: drop the entries it's part of */
+static void invalidateWord(Gpu9900 *gpu, uint32_t addr)
+{
+  gpu->codeWords[addr >> 1] = 0;
+
+  // an instruction is up to 3 words: the entries starting at it and the 2 before
+  for (uint32_t back = 0; back <= 4; back += 2)
+  {
+    const uint16_t pc = (uint16_t)(addr - back);
+    Gpu9900Decoded *d = &gpu->cache[(pc >> 1) & (GPU9900_CACHE_ENTRIES - 1)];
+    if (d->tag != GPU9900_TAG_NONE && (uint16_t)d->tag == pc &&
+        (uint16_t)(addr - pc) < (uint16_t)(d->next - pc))
+    {
+      d->tag = GPU9900_TAG_NONE;
+      ++gpu->stats.invalidations;
+    }
+  }
+}
+
+static inline void written(Gpu9900 *gpu, const uint8_t *p)
+{
+  const uint32_t word = (uint32_t)(p - gpu->mem) >> 1;
+  if (gpu->codeWords[word])
+    invalidateWord(gpu, word << 1);
+}
+
+static inline void wr16(Gpu9900 *gpu, uint8_t *p, uint16_t value)
+{
+  p[0] = value >> 8;
+  p[1] = value & 0xff;
+  written(gpu, p);
+}
+
+static inline void wr8(Gpu9900 *gpu, uint8_t *p, uint8_t value)
+{
+  p[0] = value;
+  written(gpu, p);
+}
+
+static inline uint8_t *reg(Gpu9900 *gpu, uint32_t r)
+{
+  return gpu->mem + gpu->wp + r * 2;
+}
+
+/* an operand's memory, its register's autoincrement done */
+static inline uint8_t *operand(Gpu9900 *gpu, const Gpu9900Operand *o)
+{
+  const uint16_t mask = o->size == 2 ? 0xfffe : 0xffff;
+  switch (o->mode)
+  {
+    case GPU9900_OPD_REG:
+    case GPU9900_OPD_SYM:
+      return o->ptr;
+
+    case GPU9900_OPD_IND:
+      return gpu->mem + (rd16(o->ptr) & mask);
+
+    case GPU9900_OPD_INC:
+    {
+      const uint16_t addr = rd16(o->ptr);
+      wr16(gpu, o->ptr, addr + o->size);
+      return gpu->mem + (addr & mask);
+    }
+
+    default:
+      return gpu->mem + ((uint16_t)(o->addr + rd16(o->ptr)) & mask);
+  }
+}
+
+/* status */
+
+static inline void compareZero(Gpu9900 *gpu, uint16_t keep, uint16_t value)
+{
+  gpu->st = (gpu->st & keep) |
+            (value == 0 ? ST_EQ : (int16_t)value > 0 ? ST_LGT | ST_AGT : ST_LGT);
+}
+
+static inline void compareZeroB(Gpu9900 *gpu, uint16_t keep, uint8_t value)
+{
+  gpu->st = (gpu->st & keep) |
+            (value == 0 ? ST_EQ : (int8_t)value > 0 ? ST_LGT | ST_AGT : ST_LGT) |
+            (__builtin_parity(value) ? ST_OP : 0);
+}
+
+static inline uint16_t compare(uint16_t a, uint16_t b)
+{
+  if (a == b)
+    return ST_EQ;
+  return (a > b ? ST_LGT : 0) | ((int16_t)a > (int16_t)b ? ST_AGT : 0);
+}
+
+static inline uint16_t compareB(uint8_t a, uint8_t b)
+{
+  if (a == b)
+    return ST_EQ;
+  return (a > b ? ST_LGT : 0) | ((int8_t)a > (int8_t)b ? ST_AGT : 0);
+}
+
+/* a + b (sub: a - b) with carry and overflow, status kept per run9900 */
+static uint16_t add(Gpu9900 *gpu, uint16_t a, uint16_t b, bool sub)
+{
+  const uint16_t result = sub ? a - b : a + b;
+  const bool carry = sub ? (b == 0 || a >= b) : result < a;
+  const bool overflow = sub ? ((a ^ b) & (a ^ result) & 0x8000) : (~(a ^ b) & (a ^ result) & 0x8000);
+
+  compareZero(gpu, ST_OP, result);
+  gpu->st |= (carry ? ST_C : 0) | (overflow ? ST_OV : 0);
+  return result;
+}
+
+static uint8_t addB(Gpu9900 *gpu, uint8_t a, uint8_t b, bool sub)
+{
+  const uint8_t result = sub ? a - b : a + b;
+  const bool carry = sub ? (b == 0 || a >= b) : result < a;
+  const bool overflow = sub ? ((a ^ b) & (a ^ result) & 0x80) : (~(a ^ b) & (a ^ result) & 0x80);
+
+  compareZeroB(gpu, 0, result);
+  gpu->st |= (carry ? ST_C : 0) | (overflow ? ST_OV : 0);
+  return result;
+}
+
+/* format 1: two general operands */
+
+#define SRC_W()   const uint16_t s = rd16(operand(gpu, &d->src))
+#define SRC_B()   const uint8_t s = *operand(gpu, &d->src)
+#define DST()     uint8_t *t = operand(gpu, &d->dst)
+
+static void opSZC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  const uint16_t v = rd16(t) & ~s;
+  wr16(gpu, t, v);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, v);
+}
+
+static void opSZCB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_B(); DST();
+  const uint8_t v = *t & ~s;
+  wr8(gpu, t, v);
+  compareZeroB(gpu, ST_C | ST_OV, v);
+}
+
+static void opS(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  wr16(gpu, t, add(gpu, rd16(t), s, true));
+}
+
+static void opSB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_B(); DST();
+  wr8(gpu, t, addB(gpu, *t, s, true));
+}
+
+static void opC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  gpu->st = (gpu->st & (ST_C | ST_OV | ST_OP)) | compare(s, rd16(t));
+}
+
+static void opCB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_B(); DST();
+  gpu->st = (gpu->st & (ST_C | ST_OV)) | compareB(s, *t) | (__builtin_parity(s) ? ST_OP : 0);
+}
+
+static void opA(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  wr16(gpu, t, add(gpu, rd16(t), s, false));
+}
+
+static void opAB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_B(); DST();
+  wr8(gpu, t, addB(gpu, *t, s, false));
+}
+
+static void opMOV(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  wr16(gpu, t, s);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, s);
+}
+
+static void opMOVB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_B(); DST();
+  wr8(gpu, t, s);
+  compareZeroB(gpu, ST_C | ST_OV, s);
+}
+
+static void opSOC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  const uint16_t v = rd16(t) | s;
+  wr16(gpu, t, v);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, v);
+}
+
+static void opSOCB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_B(); DST();
+  const uint8_t v = *t | s;
+  wr8(gpu, t, v);
+  compareZeroB(gpu, ST_C | ST_OV, v);
+}
+
+/* format 3 and 9: a general source, register D */
+
+static void opCOC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  gpu->st = (rd16(t) & s) == s ? gpu->st | ST_EQ : gpu->st & ~ST_EQ;
+}
+
+static void opCZC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  gpu->st = (rd16(t) & s) == 0 ? gpu->st | ST_EQ : gpu->st & ~ST_EQ;
+}
+
+static void opXOR(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  const uint16_t v = rd16(t) ^ s;
+  wr16(gpu, t, v);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, v);
+}
+
+static void opMUL(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  const uint32_t product = (uint32_t)rd16(t) * s;
+  wr16(gpu, t, product >> 16);
+  wr16(gpu, t + 2, product & 0xffff);
+}
+
+static void opDIV(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  SRC_W(); DST();
+  const uint16_t high = rd16(t);
+  if (s <= high)
+  {
+    gpu->st |= ST_OV;
+    return;
+  }
+
+  const uint32_t dividend = (uint32_t)high << 16 | rd16(t + 2);
+  wr16(gpu, t, dividend / s);
+  wr16(gpu, t + 2, dividend % s);
+  gpu->st &= ~ST_OV;
+}
+
+/* F18A PIX (XOP): a bitmap address (M set), or a bitmap layer pixel's address, test and write */
+static void opPIX(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  static const uint8_t mask[4] = { 0xc0, 0x30, 0x0c, 0x03 };
+  static const uint8_t shift[4] = { 6, 4, 2, 0 };
+
+  SRC_W(); DST();
+  uint16_t flags = rd16(t);
+  const uint8_t *vregs = gpu->mem + VREGS;
+  const uint32_t x = s >> 8, y = s & 0xff;
+
+  if (flags & 0x8000)
+  {
+    const uint16_t addr = ((y & 0xf8) << 5) | (x & 0xf8) | (y & 0x07) | ((vregs[4] & 0x04) << 11);
+    wr16(gpu, t, addr);
+    return;
+  }
+
+  const uint32_t p = y * (vregs[35] ? vregs[35] : 256) + x;
+  const uint16_t addr = (uint16_t)((vregs[32] << 6) + (p >> 2));
+  if (flags & 0x4000)
+  {
+    wr16(gpu, t, addr);
+    return;
+  }
+
+  const uint32_t sub = p & 3;
+  uint8_t *b = gpu->mem + addr;
+  const uint8_t pixel = (*b & mask[sub]) >> shift[sub];
+  const uint8_t test = (flags >> 4) & 3;
+
+  bool write = !(flags & 0x0400);
+  if (write && (flags & 0x0200))
+    write = (flags & 0x0100) ? pixel == test : pixel != test;
+  if (write)
+    wr8(gpu, b, (*b & ~mask[sub]) | ((flags & 3) << shift[sub]));
+
+  if (flags & 0x0800)
+  {
+    flags = (flags & ~3) | pixel;
+    wr16(gpu, t, flags);
+  }
+}
+
+/* format 6: a general operand */
+
+#define OPD() uint8_t *t = operand(gpu, &d->src)
+
+static void opBLWP(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  const uint16_t wp = gpu->wp, pc = gpu->pc;
+  gpu->wp = rd16(t) & 0xfffe;
+  wr16(gpu, reg(gpu, 13), wp);
+  wr16(gpu, reg(gpu, 14), pc);
+  wr16(gpu, reg(gpu, 15), gpu->st & 0xff00);
+  gpu->pc = rd16(t + 2) & 0xfffe;
+}
+
+static void opB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  gpu->pc = (uint16_t)(t - gpu->mem);
+}
+
+static void decode(Gpu9900 *gpu, uint16_t op, uint16_t pc, Gpu9900Decoded *d);
+
+static void opX(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+
+  // decoded each time, never cached: the instruction is data. its operand words follow the X
+  Gpu9900Decoded x;
+  decode(gpu, rd16(t), gpu->pc, &x);
+  gpu->pc = x.next;
+  x.handler(gpu, &x);
+}
+
+static void opCLR(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, 0);
+}
+
+static void opSETO(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, 0xffff);
+}
+
+static void opNEG(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  const uint16_t v = rd16(t);
+  if (v == 0x8000)
+  {
+    compareZero(gpu, ST_OP, v);
+    gpu->st |= ST_OV;
+    return;
+  }
+
+  const uint16_t result = -v;
+  wr16(gpu, t, result);
+  compareZero(gpu, ST_OP, result);
+  if (result == 0)
+    gpu->st |= ST_C;
+}
+
+static void opINV(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  const uint16_t v = ~rd16(t);
+  wr16(gpu, t, v);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, v);
+}
+
+static void opABS(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  const uint16_t v = rd16(t);
+  compareZero(gpu, ST_OP, v);     // the value before
+  if (v == 0x8000)
+    gpu->st |= ST_OV;
+  else if (v & 0x8000)
+    wr16(gpu, t, -v);
+}
+
+static void opINC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, add(gpu, rd16(t), 1, false));
+}
+
+static void opINCT(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, add(gpu, rd16(t), 2, false));
+}
+
+static void opDEC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, add(gpu, rd16(t), 1, true));
+}
+
+static void opDECT(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, add(gpu, rd16(t), 2, true));
+}
+
+static void opBL(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, reg(gpu, 11), gpu->pc);
+  gpu->pc = (uint16_t)(t - gpu->mem);
+}
+
+static void opSWPB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  const uint16_t v = rd16(t);
+  wr16(gpu, t, (uint16_t)(v << 8 | v >> 8));
+}
+
+/* the F18A stack, on R15 */
+
+static uint8_t *stackPush(Gpu9900 *gpu)
+{
+  uint8_t *r15 = reg(gpu, 15);
+  const uint16_t sp = rd16(r15) & 0xfffe;
+  wr16(gpu, r15, sp - 2);
+  return gpu->mem + sp;
+}
+
+static uint8_t *stackPop(Gpu9900 *gpu)
+{
+  uint8_t *r15 = reg(gpu, 15);
+  const uint16_t sp = (rd16(r15) & 0xfffe) + 2;
+  wr16(gpu, r15, sp);
+  return gpu->mem + sp;
+}
+
+static void opCALL(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, stackPush(gpu), gpu->pc);
+  gpu->pc = (uint16_t)(t - gpu->mem);
+}
+
+static void opRET(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  (void)d;
+  gpu->pc = rd16(stackPop(gpu)) & 0xfffe;
+}
+
+static void opPUSH(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  const uint16_t v = rd16(t);
+  wr16(gpu, stackPush(gpu), v);
+}
+
+static void opPOP(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  OPD();
+  wr16(gpu, t, rd16(stackPop(gpu)));
+}
+
+/* format 5: shifts. a count of 0 is R0's low nibble, 0 there is 16 */
+
+static uint32_t shiftCount(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  uint32_t count = d->imm;
+  if (!count)
+    count = gpu->mem[gpu->wp + 1] & 0x0f;
+  return count ? count : 16;
+}
+
+static void opSRA(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  uint8_t *t = d->src.ptr;
+  const uint32_t count = shiftCount(gpu, d);
+  const int32_t v = (int16_t)rd16(t);
+  const uint16_t result = (uint16_t)(v >> count);
+  wr16(gpu, t, result);
+  compareZero(gpu, ST_OV | ST_OP, result);
+  if ((v >> (count - 1)) & 1)
+    gpu->st |= ST_C;
+}
+
+static void opSRL(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  uint8_t *t = d->src.ptr;
+  const uint32_t count = shiftCount(gpu, d);
+  const uint32_t v = rd16(t);
+  const uint16_t result = (uint16_t)(v >> count);
+  wr16(gpu, t, result);
+  compareZero(gpu, ST_OV | ST_OP, result);
+  if ((v >> (count - 1)) & 1)
+    gpu->st |= ST_C;
+}
+
+static void opSLA(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  uint8_t *t = d->src.ptr;
+  const uint32_t count = shiftCount(gpu, d);
+  const uint32_t v = rd16(t);
+  const uint16_t result = (uint16_t)(v << count);
+
+  // the sign changes at some point: the bits shifted through it aren't all the same
+  const uint32_t through = (v << count) >> 15 & ((1u << (count + 1)) - 1);
+  const bool overflow = through != 0 && through != (1u << (count + 1)) - 1;
+
+  wr16(gpu, t, result);
+  compareZero(gpu, ST_OP, result);
+  gpu->st |= (((v << count) >> 16) & 1 ? ST_C : 0) | (overflow ? ST_OV : 0);
+}
+
+static void opSRC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  uint8_t *t = d->src.ptr;
+  const uint32_t count = shiftCount(gpu, d) & 15;
+  const uint16_t v = rd16(t);
+  const uint16_t result = (uint16_t)(v >> count | v << (16 - count));
+  wr16(gpu, t, result);
+  compareZero(gpu, ST_OV | ST_OP, result);
+  if (result & 0x8000)
+    gpu->st |= ST_C;
+}
+
+static void opSLC(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  uint8_t *t = d->src.ptr;
+  const uint32_t count = shiftCount(gpu, d) & 15;
+  const uint16_t v = rd16(t);
+  const uint16_t result = (uint16_t)(v << count | v >> (16 - count));
+  wr16(gpu, t, result);
+  compareZero(gpu, ST_OV | ST_OP, result);
+  if (result & 0x0001)
+    gpu->st |= ST_C;
+}
+
+/* format 8: register and immediate, and the rest */
+
+static void opLI(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  wr16(gpu, d->src.ptr, d->imm);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, d->imm);
+}
+
+static void opAI(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  wr16(gpu, d->src.ptr, add(gpu, rd16(d->src.ptr), d->imm, false));
+}
+
+static void opANDI(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  const uint16_t v = rd16(d->src.ptr) & d->imm;
+  wr16(gpu, d->src.ptr, v);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, v);
+}
+
+static void opORI(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  const uint16_t v = rd16(d->src.ptr) | d->imm;
+  wr16(gpu, d->src.ptr, v);
+  compareZero(gpu, ST_C | ST_OV | ST_OP, v);
+}
+
+static void opCI(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  gpu->st = (gpu->st & (ST_C | ST_OV | ST_OP)) | compare(rd16(d->src.ptr), d->imm);
+}
+
+static void opSTWP(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  wr16(gpu, d->src.ptr, gpu->wp);
+}
+
+static void opSTST(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  wr16(gpu, d->src.ptr, gpu->st);
+}
+
+static void opLWPI(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  gpu->wp = d->imm & 0xfffe;
+}
+
+static void opIDLE(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  (void)d;
+  gpu->idle = true;
+}
+
+static void opRTWP(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  (void)d;
+  gpu->st = gpu->mem[gpu->wp + 30] << 8;
+  gpu->pc = rd16(reg(gpu, 14)) & 0xfffe;
+  gpu->wp = rd16(reg(gpu, 13)) & 0xfffe;
+}
+
+static void opNOP(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  (void)gpu; (void)d;
+}
+
+static void opTB(Gpu9900 *gpu, const Gpu9900Decoded *d)
+{
+  (void)d;
+  gpu->st &= ~ST_EQ;
+}
+
+/* jumps */
+
+#define JUMP(name, cond) \
+  static void name(Gpu9900 *gpu, const Gpu9900Decoded *d) \
+  { \
+    const uint16_t st = gpu->st; (void)st; \
+    if (cond) gpu->pc = d->imm; \
+  }
+
+JUMP(opJMP, true)
+JUMP(opJLT, !(st & (ST_AGT | ST_EQ)))
+JUMP(opJLE, !(st & ST_LGT) || (st & ST_EQ))
+JUMP(opJEQ, st & ST_EQ)
+JUMP(opJHE, st & (ST_LGT | ST_EQ))
+JUMP(opJGT, st & ST_AGT)
+JUMP(opJNE, !(st & ST_EQ))
+JUMP(opJNC, !(st & ST_C))
+JUMP(opJOC, st & ST_C)
+JUMP(opJNO, !(st & ST_OV))
+JUMP(opJL, !(st & (ST_LGT | ST_EQ)))
+JUMP(opJH, (st & ST_LGT) && !(st & ST_EQ))
+JUMP(opJOP, st & ST_OP)
+
+/* decoding */
+
+static void ops(uint16_t first, uint16_t last, Gpu9900Handler handler, Format format)
+{
+  for (uint32_t i = first >> 5; i <= (uint32_t)(last >> 5); ++i)
+  {
+    opTable[i].handler = handler;
+    opTable[i].format = format;
+  }
+}
+
+/* the dispatch table, as JMPTBL */
+static void buildOpTable(void)
+{
+  ops(0x0000, 0xffff, opNOP, FMT_NONE);
+
+  ops(0x0200, 0x021f, opLI, FMT_8I);
+  ops(0x0220, 0x023f, opAI, FMT_8I);
+  ops(0x0240, 0x025f, opANDI, FMT_8I);
+  ops(0x0260, 0x027f, opORI, FMT_8I);
+  ops(0x0280, 0x029f, opCI, FMT_8I);
+  ops(0x02a0, 0x02bf, opSTWP, FMT_8R);
+  ops(0x02c0, 0x02df, opSTST, FMT_8R);
+  ops(0x02e0, 0x02ff, opLWPI, FMT_IMM);
+  ops(0x0300, 0x031f, opNOP, FMT_IMM);      // LIMI
+  ops(0x0340, 0x035f, opIDLE, FMT_0);
+  ops(0x0380, 0x039f, opRTWP, FMT_0);
+
+  ops(0x0400, 0x043f, opBLWP, FMT_6);
+  ops(0x0440, 0x047f, opB, FMT_6);
+  ops(0x0480, 0x04bf, opX, FMT_6);
+  ops(0x04c0, 0x04ff, opCLR, FMT_6);
+  ops(0x0500, 0x053f, opNEG, FMT_6);
+  ops(0x0540, 0x057f, opINV, FMT_6);
+  ops(0x0580, 0x05bf, opINC, FMT_6);
+  ops(0x05c0, 0x05ff, opINCT, FMT_6);
+  ops(0x0600, 0x063f, opDEC, FMT_6);
+  ops(0x0640, 0x067f, opDECT, FMT_6);
+  ops(0x0680, 0x06bf, opBL, FMT_6);
+  ops(0x06c0, 0x06ff, opSWPB, FMT_6);
+  ops(0x0700, 0x073f, opSETO, FMT_6);
+  ops(0x0740, 0x077f, opABS, FMT_6);
+
+  ops(0x0800, 0x08ff, opSRA, FMT_5);
+  ops(0x0900, 0x09ff, opSRL, FMT_5);
+  ops(0x0a00, 0x0aff, opSLA, FMT_5);
+  ops(0x0b00, 0x0bff, opSRC, FMT_5);
+
+  ops(0x0c00, 0x0c1f, opRET, FMT_0);
+  ops(0x0c80, 0x0cbf, opCALL, FMT_6);
+  ops(0x0d00, 0x0d3f, opPUSH, FMT_6);
+  ops(0x0e00, 0x0e3f, opSLC, FMT_5);
+  ops(0x0f00, 0x0f3f, opPOP, FMT_6);
+
+  static const Gpu9900Handler jumps[] = {
+    opJMP, opJLT, opJLE, opJEQ, opJHE, opJGT, opJNE, opJNC, opJOC, opJNO, opJL, opJH, opJOP
+  };
+  for (uint32_t i = 0; i < sizeof(jumps) / sizeof(jumps[0]); ++i)
+    ops(0x1000 + i * 0x100, 0x10ff + i * 0x100, jumps[i], FMT_JUMP);
+  ops(0x1f00, 0x1fff, opTB, FMT_NONE);
+
+  ops(0x2000, 0x23ff, opCOC, FMT_3);
+  ops(0x2400, 0x27ff, opCZC, FMT_3);
+  ops(0x2800, 0x2bff, opXOR, FMT_3);
+  ops(0x2c00, 0x2fff, opPIX, FMT_3);
+  ops(0x3000, 0x37ff, opNOP, FMT_CRU);      // LDCR, STCR
+  ops(0x3800, 0x3bff, opMUL, FMT_3);
+  ops(0x3c00, 0x3fff, opDIV, FMT_3);
+
+  static const Gpu9900Handler format1[] = {
+    opSZC, opSZCB, opS, opSB, opC, opCB, opA, opAB, opMOV, opMOVB, opSOC, opSOCB
+  };
+  for (uint32_t i = 0; i < sizeof(format1) / sizeof(format1[0]); ++i)
+    ops(0x4000 + i * 0x1000, 0x4fff + i * 0x1000, format1[i], FMT_1);
+}
+
+static inline uint16_t fetch(Gpu9900 *gpu, uint16_t *pc)
+{
+  const uint16_t word = rd16(gpu->mem + *pc);
+  *pc += 2;
+  return word;
+}
+
+/* a general operand (ts, r) of size bytes, its symbolic word read from pc */
+static void decodeOperand(Gpu9900 *gpu, uint16_t *pc, uint32_t ts, uint32_t r, uint8_t size, Gpu9900Operand *o)
+{
+  o->size = size;
+  o->ptr = reg(gpu, r);
+  switch (ts)
+  {
+    case 0: o->mode = GPU9900_OPD_REG; break;
+    case 1: o->mode = GPU9900_OPD_IND; break;
+    case 3: o->mode = GPU9900_OPD_INC; break;
+    default:
+      o->addr = fetch(gpu, pc);
+      if (r)
+      {
+        o->mode = GPU9900_OPD_IDX;
+      }
+      else
+      {
+        o->mode = GPU9900_OPD_SYM;
+        o->ptr = gpu->mem + (o->addr & (size == 2 ? 0xfffe : 0xffff));
+      }
+      break;
+  }
+}
+
+/* op, at the address before pc: its handler and operands. pc is where its operand words start */
+static void decode(Gpu9900 *gpu, uint16_t op, uint16_t pc, Gpu9900Decoded *d)
+{
+  const OpEntry *e = &opTable[op >> 5];
+  d->handler = e->handler;
+  d->op = op;
+  ++gpu->stats.decodes;
+
+  switch (e->format)
+  {
+    case FMT_1:
+    {
+      const uint8_t size = (op & 0x1000) ? 1 : 2;
+      decodeOperand(gpu, &pc, (op >> 4) & 3, op & 15, size, &d->src);
+      decodeOperand(gpu, &pc, (op >> 10) & 3, (op >> 6) & 15, size, &d->dst);
+      break;
+    }
+
+    case FMT_3:
+      decodeOperand(gpu, &pc, (op >> 4) & 3, op & 15, 2, &d->src);
+      decodeOperand(gpu, &pc, 0, (op >> 6) & 15, 2, &d->dst);
+      break;
+
+    case FMT_6:
+      decodeOperand(gpu, &pc, (op >> 4) & 3, op & 15, 2, &d->src);
+      break;
+
+    case FMT_5:
+      decodeOperand(gpu, &pc, 0, op & 15, 2, &d->src);
+      d->imm = (op >> 4) & 15;
+      break;
+
+    case FMT_8I:
+      decodeOperand(gpu, &pc, 0, op & 15, 2, &d->src);
+      d->imm = fetch(gpu, &pc);
+      break;
+
+    case FMT_8R:
+      decodeOperand(gpu, &pc, 0, op & 15, 2, &d->src);
+      break;
+
+    case FMT_IMM:
+      d->imm = fetch(gpu, &pc);
+      break;
+
+    case FMT_JUMP:
+      d->imm = pc + (int8_t)(op & 0xff) * 2;
+      break;
+
+    case FMT_CRU:
+      if (((op >> 4) & 3) == 2)
+        pc += 2;
+      break;
+
+    default:
+      break;
+  }
+
+  d->next = pc;
+}
+
+/* the pc's entry, decoded into the cache if it isn't there */
+static inline const Gpu9900Decoded *lookup(Gpu9900 *gpu)
+{
+  const uint16_t pc = gpu->pc;
+  const uint32_t tag = pc | (uint32_t)gpu->wp << 16;
+  Gpu9900Decoded *d = &gpu->cache[(pc >> 1) & (GPU9900_CACHE_ENTRIES - 1)];
+  if (d->tag == tag)
+  {
+    ++gpu->stats.hits;
+    return d;
+  }
+
+  decode(gpu, rd16(gpu->mem + pc), (uint16_t)(pc + 2), d);
+  d->tag = tag;
+  for (uint16_t addr = pc; addr != d->next; addr += 2)
+    gpu->codeWords[addr >> 1] = 1;
+  return d;
+}
+
+void gpu9900Init(Gpu9900 *gpu, uint8_t *mem, const volatile uint8_t *run, bool cached)
+{
+  if (!opTable[0].handler)
+    buildOpTable();
+
+  memset(gpu, 0, sizeof(*gpu));
+  gpu->mem = mem;
+  gpu->run = run;
+  gpu->cached = cached;
+  for (uint32_t i = 0; i < GPU9900_CACHE_ENTRIES; ++i)
+    gpu->cache[i].tag = GPU9900_TAG_NONE;
+}
+
+uint16_t gpu9900Run(Gpu9900 *gpu, uint16_t pc, uint16_t wp)
+{
+  gpu->pc = pc & 0xfffe;
+  gpu->wp = wp;
+  gpu->st = 0;
+  gpu->idle = false;
+
+  if (gpu->cached)
+  {
+    while ((*gpu->run & 1) && !gpu->idle)
+    {
+      const Gpu9900Decoded *d = lookup(gpu);
+      gpu->pc = d->next;
+      d->handler(gpu, d);
+      ++gpu->stats.instructions;
+    }
+  }
+  else
+  {
+    while ((*gpu->run & 1) && !gpu->idle)
+    {
+      Gpu9900Decoded d;
+      decode(gpu, rd16(gpu->mem + gpu->pc), (uint16_t)(gpu->pc + 2), &d);
+      gpu->pc = d.next;
+      d.handler(gpu, &d);
+      ++gpu->stats.instructions;
+    }
+  }
+
+  return gpu->pc;
+}
+
+void gpu9900HostWrite(Gpu9900 *gpu, uint16_t addr, uint8_t value)
+{
+  wr8(gpu, gpu->mem + addr, value);
+}
+
+void gpu9900Invalidate(Gpu9900 *gpu, uint16_t addr, uint32_t count)
+{
+  for (uint32_t a = addr & ~1u; a < (uint32_t)addr + count; a += 2)
+    if (gpu->codeWords[(a >> 1) & 0x7fff])
+      invalidateWord(gpu, a & 0xffff);
+}
@@ -0,0 +1,97 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * a C model of the 9900 gpu interpreter (run9900, thumb9900_*.S): the
+ * same instruction set, F18A extensions (CALL, RET, PUSH, POP, SLC, PIX)
+ * and status bits, dispatched on instruction >> 5 as JMPTBL is
+ *
+ * it runs either way: decoding every instruction as it's fetched (as
+ * run9900 does), or from a pre-decoded instruction cache. a cache entry
+ * is keyed by the pc and the workspace, and holds the handler and the
+ * operands decoded to pointers: register operands point at the register,
+ * symbolic ones at the memory, and their operand words are already read.
+ * a write (by the gpu, or the host through gpu9900HostWrite) to a word an
+ * entry was decoded from drops the entry
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GPU9900_MEM_BYTES       (0x10000 + 32)  // 64KB, and a workspace at >FFE2 or above runs past it (run9900 doesn't wrap)
+#define GPU9900_CACHE_ENTRIES   2048            // direct mapped on pc >> 1
+#define GPU9900_TAG_NONE        0x00000001      // an empty entry (pcs are even)
+
+typedef struct Gpu9900 Gpu9900;
+typedef struct Gpu9900Decoded Gpu9900Decoded;
+
+typedef void (*Gpu9900Handler)(Gpu9900 *gpu, const Gpu9900Decoded *d);
+
+typedef struct
+{
+  uint8_t mode;                 // GPU9900_OPD_*
+  uint8_t size;                 // 1 (byte) or 2 (word): the autoincrement
+  uint16_t addr;                // indexed: the base
+  uint8_t *ptr;                 // register: the register. symbolic: the memory. else the register the address is in
+} Gpu9900Operand;
+
+enum
+{
+  GPU9900_OPD_REG,              // Rn
+  GPU9900_OPD_IND,              // *Rn
+  GPU9900_OPD_INC,              // *Rn+
+  GPU9900_OPD_SYM,              // @addr
+  GPU9900_OPD_IDX,              // @addr(Rn)
+};
+
+struct Gpu9900Decoded
+{
+  Gpu9900Handler handler;
+  uint32_t tag;                 // pc | wp << 16 (cached entries)
+  uint16_t op;                  // the instruction
+  uint16_t next;                // the pc after it and its operand words
+  uint16_t imm;                 // immediate, jump target, or shift count
+  Gpu9900Operand src, dst;
+};
+
+typedef struct
+{
+  uint64_t instructions;
+  uint64_t decodes;             // instructions decoded (every one, uncached)
+  uint64_t hits;                // cached instructions run without a decode
+  uint64_t invalidations;       // cache entries dropped by writes
+} Gpu9900Stats;
+
+struct Gpu9900
+{
+  uint8_t *mem;                 // GPU9900_MEM_BYTES. the video registers are at >6000
+  const volatile uint8_t *run;  // VR56 (>38): bit 0 clear stops the gpu
+  uint16_t pc, wp, st;
+  bool idle;
+  bool cached;                  // run from the pre-decoded cache
+  Gpu9900Stats stats;
+  uint8_t codeWords[GPU9900_MEM_BYTES / 2];   // words a cache entry may have been decoded from
+  Gpu9900Decoded cache[GPU9900_CACHE_ENTRIES];
+};
+
+/* a gpu on mem, stopped by VR56 (run), with an empty cache if cached */
+void gpu9900Init(Gpu9900 *gpu, uint8_t *mem, const volatile uint8_t *run, bool cached);
+
+/* run from pc with workspace wp (ST 0) until IDLE or VR56 bit 0 clears, as run9900. returns the pc */
+uint16_t gpu9900Run(Gpu9900 *gpu, uint16_t pc, uint16_t wp);
+
+/* a host (tms bus) write to the memory */
+void gpu9900HostWrite(Gpu9900 *gpu, uint16_t addr, uint8_t value);
+
+/* drop cache entries decoded from count bytes at addr (a block load or a dma job) */
+void gpu9900Invalidate(Gpu9900 *gpu, uint16_t addr, uint32_t count);
@@ -0,0 +1,46 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for the pioasm output of src/clocks.pio, assembled by hand.
+ * keep it in step with clocks.pio
+ */
+
+#include "hardware/pio.h"
+
+// ----- //
+// clock //
+// ----- //
+
+#define clock_wrap_target 0
+#define clock_wrap 1
+
+static const uint16_t clock_program_instructions[] = {
+            //     .wrap_target
+    0xe001, //  0: set    pins, 1
+    0xe000, //  1: set    pins, 0
+            //     .wrap
+};
+
+static const pio_program_t clock_program = {
+    .instructions = clock_program_instructions,
+    .length = 2,
+    .origin = -1,
+};
+
+static inline pio_sm_config clock_program_get_default_config(uint offset)
+{
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + clock_wrap_target, offset + clock_wrap);
+    return c;
+}
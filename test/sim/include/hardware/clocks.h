@@ -0,0 +1,24 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/clocks.h. the model's system clock
+ */
+
+#include "pico.h"
+
+enum clock_index { clk_gpout0 = 0, clk_ref = 4, clk_sys = 5, clk_peri = 6 };
+
+uint32_t clock_get_hz(enum clock_index clock);
+bool set_sys_clock_pll(uint32_t vcoFreq, uint postDiv1, uint postDiv2);
+bool set_sys_clock_khz(uint32_t freqKHz, bool required);
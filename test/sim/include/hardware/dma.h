@@ -0,0 +1,188 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/dma.h, over the register model in sim_hw.c
+ *
+ * the ctrl bits are the RP2040's. each channel's register aliases share
+ * storage, and the address registers are pointer width on the host. a plain
+ * store to ints0/1 is taken as a write-one-to-clear when the model next
+ * looks at them (see syncInts in sim_hw.c)
+ */
+
+#include "pico.h"
+#include "hardware/irq.h"
+
+#define NUM_DMA_CHANNELS 12
+
+#define DMA_CH0_CTRL_TRIG_EN_BITS          0x00000001u
+#define DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB    2
+#define DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS   0x0000000cu
+#define DMA_CH0_CTRL_TRIG_INCR_READ_BITS   0x00000010u
+#define DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS  0x00000020u
+#define DMA_CH0_CTRL_TRIG_RING_SIZE_LSB    6
+#define DMA_CH0_CTRL_TRIG_RING_SIZE_BITS   0x000003c0u
+#define DMA_CH0_CTRL_TRIG_RING_SEL_BITS    0x00000400u
+#define DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB     11
+#define DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS    0x00007800u
+#define DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB     15
+#define DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS    0x001f8000u
+#define DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS   0x00200000u
+#define DMA_CH0_CTRL_TRIG_BUSY_BITS        0x01000000u
+
+#define DREQ_PIO0_TX0 0
+#define DREQ_PIO1_TX0 8
+#define DREQ_FORCE 0x3f
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+typedef struct
+{
+  union { volatile uintptr_t read_addr, al1_read_addr, al2_read_addr, al3_read_addr_trig; };
+  union { volatile uintptr_t write_addr, al1_write_addr, al2_write_addr_trig, al3_write_addr; };
+  union { volatile uint32_t transfer_count, al1_transfer_count_trig, al2_transfer_count, al3_transfer_count; };
+  union { volatile uint32_t ctrl_trig, al1_ctrl, al2_ctrl, al3_ctrl; };
+} dma_channel_hw_t;
+
+typedef struct
+{
+  dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+  volatile uint32_t intr;
+  volatile uint32_t inte0, intf0, ints0;
+  volatile uint32_t inte1, intf1, ints1;
+  volatile uint32_t multi_channel_trigger;
+  volatile uint32_t abort;
+} dma_hw_t;
+
+extern dma_hw_t *const dma_hw;
+
+typedef struct
+{
+  uint32_t ctrl;
+} dma_channel_config;
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+  c->ctrl = incr ? (c->ctrl | DMA_CH0_CTRL_TRIG_INCR_READ_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_INCR_READ_BITS);
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+  c->ctrl = incr ? (c->ctrl | DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS);
+}
+
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq)
+{
+  c->ctrl = (c->ctrl & ~DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS) | (dreq << DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB);
+}
+
+static inline void channel_config_set_chain_to(dma_channel_config *c, uint chan)
+{
+  c->ctrl = (c->ctrl & ~DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS) | (chan << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB);
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+  c->ctrl = (c->ctrl & ~DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS) | ((uint32_t)size << DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB);
+}
+
+static inline void channel_config_set_ring(dma_channel_config *c, bool write, uint sizeBits)
+{
+  c->ctrl = (c->ctrl & ~(DMA_CH0_CTRL_TRIG_RING_SIZE_BITS | DMA_CH0_CTRL_TRIG_RING_SEL_BITS)) |
+            (sizeBits << DMA_CH0_CTRL_TRIG_RING_SIZE_LSB) | (write ? DMA_CH0_CTRL_TRIG_RING_SEL_BITS : 0);
+}
+
+static inline void channel_config_set_irq_quiet(dma_channel_config *c, bool quiet)
+{
+  c->ctrl = quiet ? (c->ctrl | DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS);
+}
+
+static inline void channel_config_set_enable(dma_channel_config *c, bool enable)
+{
+  c->ctrl = enable ? (c->ctrl | DMA_CH0_CTRL_TRIG_EN_BITS) : (c->ctrl & ~DMA_CH0_CTRL_TRIG_EN_BITS);
+}
+
+static inline uint32_t channel_config_get_ctrl_value(const dma_channel_config *c)
+{
+  return c->ctrl;
+}
+
+static inline dma_channel_config dma_channel_get_default_config(uint chan)
+{
+  dma_channel_config c = { 0 };
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, DREQ_FORCE);
+  channel_config_set_chain_to(&c, chan);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_enable(&c, true);
+  return c;
+}
+
+static inline dma_channel_hw_t *dma_channel_hw_addr(uint chan)
+{
+  return &dma_hw->ch[chan];
+}
+
+void dma_channel_claim(uint chan);
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint chan);
+bool dma_channel_is_claimed(uint chan);
+
+void dma_channel_set_config(uint chan, const dma_channel_config *config, bool trigger);
+void dma_channel_set_read_addr(uint chan, const volatile void *readAddr, bool trigger);
+void dma_channel_set_write_addr(uint chan, volatile void *writeAddr, bool trigger);
+void dma_channel_set_trans_count(uint chan, uint32_t count, bool trigger);
+void dma_channel_configure(uint chan, const dma_channel_config *config, volatile void *writeAddr,
+                           const volatile void *readAddr, uint count, bool trigger);
+void dma_channel_start(uint chan);
+void dma_start_channel_mask(uint32_t mask);
+void dma_channel_abort(uint chan);
+bool dma_channel_is_busy(uint chan);
+void dma_channel_wait_for_finish_blocking(uint chan);
+void dma_channel_set_irq0_enabled(uint chan, bool enabled);
+void dma_channel_set_irq1_enabled(uint chan, bool enabled);
+void dma_channel_acknowledge_irq0(uint chan);
+void dma_channel_acknowledge_irq1(uint chan);
+
+static inline bool dma_channel_get_irq0_status(uint chan)
+{
+  return (dma_hw->ints0 & (1u << chan)) != 0;
+}
+
+static inline bool dma_channel_get_irq1_status(uint chan)
+{
+  return (dma_hw->ints1 & (1u << chan)) != 0;
+}
+
+static inline void dma_irqn_set_channel_enabled(uint irqIndex, uint chan, bool enabled)
+{
+  if (irqIndex) dma_channel_set_irq1_enabled(chan, enabled);
+  else dma_channel_set_irq0_enabled(chan, enabled);
+}
+
+static inline bool dma_irqn_get_channel_status(uint irqIndex, uint chan)
+{
+  return irqIndex ? dma_channel_get_irq1_status(chan) : dma_channel_get_irq0_status(chan);
+}
+
+static inline void dma_irqn_acknowledge_channel(uint irqIndex, uint chan)
+{
+  if (irqIndex) dma_channel_acknowledge_irq1(chan);
+  else dma_channel_acknowledge_irq0(chan);
+}
+
+static inline uint dma_get_irq_num(uint irqIndex)
+{
+  return DMA_IRQ_0 + irqIndex;
+}
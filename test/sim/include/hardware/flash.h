@@ -0,0 +1,29 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/flash.h. the xip window maps simFlash, which
+ * the boot stubs (boot_hw.c) define
+ */
+
+#include "pico.h"
+
+#define FLASH_PAGE_SIZE   256
+#define FLASH_SECTOR_SIZE 4096
+
+extern uint8_t simFlash[];
+
+#define XIP_BASE ((uintptr_t)simFlash)
+
+void flash_range_erase(uint32_t flashOffs, size_t count);
+void flash_range_program(uint32_t flashOffs, const uint8_t *data, size_t count);
@@ -0,0 +1,58 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/gpio.h. the boot test (boot_hw.c) records
+ * what the firmware does with the pins
+ */
+
+#include "pico.h"
+
+enum gpio_function { GPIO_FUNC_SIO = 5, GPIO_FUNC_PIO0 = 6, GPIO_FUNC_PIO1 = 7, GPIO_FUNC_NULL = 0x1f };
+
+enum gpio_irq_level
+{
+  GPIO_IRQ_LEVEL_LOW = 0x1u,
+  GPIO_IRQ_LEVEL_HIGH = 0x2u,
+  GPIO_IRQ_EDGE_FALL = 0x4u,
+  GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+enum gpio_drive_strength
+{
+  GPIO_DRIVE_STRENGTH_2MA = 0,
+  GPIO_DRIVE_STRENGTH_4MA = 1,
+  GPIO_DRIVE_STRENGTH_8MA = 2,
+  GPIO_DRIVE_STRENGTH_12MA = 3,
+};
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+void gpio_init(uint gpio);
+void gpio_init_mask(uint32_t mask);
+void gpio_set_function_masked(uint32_t mask, enum gpio_function fn);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_set_dir_masked(uint32_t mask, uint32_t value);
+void gpio_set_dir_all_bits(uint32_t values);
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_put_all(uint32_t value);
+void gpio_set_mask(uint32_t mask);
+void gpio_clr_mask(uint32_t mask);
+bool gpio_get(uint gpio);
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled);
+void gpio_acknowledge_irq(uint gpio, uint32_t events);
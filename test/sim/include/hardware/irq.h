@@ -0,0 +1,42 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/irq.h. the model (sim_hw.c) calls the
+ * registered handlers
+ */
+
+#include "pico.h"
+
+typedef void (*irq_handler_t)(void);
+
+enum
+{
+  TIMER_IRQ_0 = 0, TIMER_IRQ_1, TIMER_IRQ_2, TIMER_IRQ_3,
+  PIO0_IRQ_0 = 7, PIO0_IRQ_1, PIO1_IRQ_0, PIO1_IRQ_1,
+  DMA_IRQ_0 = 11, DMA_IRQ_1,
+  IO_IRQ_BANK0 = 13,
+  SIO_IRQ_PROC0 = 15, SIO_IRQ_PROC1,
+  NUM_IRQS = 32
+};
+
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+#define PICO_LOWEST_IRQ_PRIORITY 0xff
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t orderPriority);
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_priority(uint num, uint8_t priority);
+void irq_clear(uint num);
@@ -0,0 +1,157 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/pio.h, over the state machine model in
+ * sim_hw.c. the instruction encoders are the real ones
+ */
+
+#include "pico.h"
+#include "hardware/irq.h"
+
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+
+typedef struct
+{
+  volatile uint32_t ctrl;
+  volatile uint32_t fstat;
+  volatile uint32_t fdebug;
+  volatile uint32_t flevel;
+  volatile uint32_t txf[NUM_PIO_STATE_MACHINES];
+  volatile uint32_t rxf[NUM_PIO_STATE_MACHINES];
+  volatile uint32_t irq;
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t *const pio0_hw;
+extern pio_hw_t *const pio1_hw;
+#define pio0 pio0_hw
+#define pio1 pio1_hw
+
+typedef struct
+{
+  const uint16_t *instructions;
+  uint8_t length;
+  int8_t origin;
+} pio_program_t;
+
+enum pio_fifo_join { PIO_FIFO_JOIN_NONE = 0, PIO_FIFO_JOIN_TX = 1, PIO_FIFO_JOIN_RX = 2 };
+
+typedef struct
+{
+  float clkdiv;
+  uint8_t wrapTarget, wrap;
+  uint8_t outBase, outCount;
+  uint8_t setBase, setCount;
+  uint8_t inBase;
+  uint8_t sidesetBase;
+  uint8_t jmpPin;
+  bool outShiftRight, autopull;
+  uint8_t pullThreshold;
+  bool inShiftRight, autopush;
+  uint8_t pushThreshold;
+  enum pio_fifo_join fifoJoin;
+} pio_sm_config;
+
+static inline pio_sm_config pio_get_default_sm_config(void)
+{
+  pio_sm_config c = { 0 };
+  c.clkdiv = 1.0f;
+  c.wrap = PIO_INSTRUCTION_COUNT - 1;
+  c.outShiftRight = c.inShiftRight = true;
+  c.pullThreshold = c.pushThreshold = 32;
+  return c;
+}
+
+static inline void sm_config_set_wrap(pio_sm_config *c, uint wrapTarget, uint wrap) { c->wrapTarget = wrapTarget; c->wrap = wrap; }
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint base, uint count) { c->outBase = base; c->outCount = count; }
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint base, uint count) { c->setBase = base; c->setCount = count; }
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint base) { c->inBase = base; }
+static inline void sm_config_set_sideset_pins(pio_sm_config *c, uint base) { c->sidesetBase = base; }
+static inline void sm_config_set_jmp_pin(pio_sm_config *c, uint pin) { c->jmpPin = pin; }
+static inline void sm_config_set_clkdiv(pio_sm_config *c, float div) { c->clkdiv = div; }
+static inline void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) { c->fifoJoin = join; }
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, bool shiftRight, bool autopull, uint threshold)
+{
+  c->outShiftRight = shiftRight; c->autopull = autopull; c->pullThreshold = threshold;
+}
+
+static inline void sm_config_set_in_shift(pio_sm_config *c, bool shiftRight, bool autopush, uint threshold)
+{
+  c->inShiftRight = shiftRight; c->autopush = autopush; c->pushThreshold = threshold;
+}
+
+/* instruction encoding */
+
+enum pio_src_dest
+{
+  pio_pins = 0, pio_x = 1, pio_y = 2, pio_null = 3, pio_pindirs = 4, pio_exec_mov = 4,
+  pio_status = 5, pio_pc = 5, pio_isr = 6, pio_osr = 7, pio_exec_out = 7
+};
+
+static inline uint pio_encode_delay(uint cycles) { return cycles << 8; }
+static inline uint pio_encode_jmp(uint addr) { return 0x0000u | addr; }
+static inline uint pio_encode_jmp_x_dec(uint addr) { return 0x0000u | (2u << 5) | addr; }
+static inline uint pio_encode_wait_irq(bool polarity, bool relative, uint irq) { return 0x2000u | ((uint)polarity << 7) | (2u << 5) | (relative ? 0x10u : 0) | irq; }
+static inline uint pio_encode_in(enum pio_src_dest src, uint count) { return 0x4000u | ((uint)src << 5) | (count & 31u); }
+static inline uint pio_encode_out(enum pio_src_dest dest, uint count) { return 0x6000u | ((uint)dest << 5) | (count & 31u); }
+static inline uint pio_encode_push(bool ifFull, bool block) { return 0x8000u | ((uint)ifFull << 6) | ((uint)block << 5); }
+static inline uint pio_encode_pull(bool ifEmpty, bool block) { return 0x8080u | ((uint)ifEmpty << 6) | ((uint)block << 5); }
+static inline uint pio_encode_mov(enum pio_src_dest dest, enum pio_src_dest src) { return 0xa000u | ((uint)dest << 5) | (uint)src; }
+static inline uint pio_encode_irq_set(bool relative, uint irq) { return 0xc000u | (relative ? 0x10u : 0) | irq; }
+static inline uint pio_encode_irq_clear(bool relative, uint irq) { return 0xc040u | (relative ? 0x10u : 0) | irq; }
+static inline uint pio_encode_set(enum pio_src_dest dest, uint value) { return 0xe000u | ((uint)dest << 5) | value; }
+static inline uint pio_encode_nop(void) { return pio_encode_mov(pio_y, pio_y); }
+
+static inline uint pio_get_dreq(PIO pio, uint sm, bool isTx)
+{
+  return (pio == pio0 ? 0u : 8u) + sm + (isTx ? 0u : 4u);
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+uint pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, uint offset);
+void pio_clear_instruction_memory(PIO pio);
+void pio_gpio_init(PIO pio, uint pin);
+
+void pio_sm_init(PIO pio, uint sm, uint initialPc, const pio_sm_config *config);
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled);
+void pio_sm_restart(PIO pio, uint sm);
+void pio_sm_clkdiv_restart(PIO pio, uint sm);
+void pio_sm_exec(PIO pio, uint sm, uint instr);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+void pio_sm_drain_tx_fifo(PIO pio, uint sm);
+void pio_sm_put(PIO pio, uint sm, uint32_t data);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+uint32_t pio_sm_get(PIO pio, uint sm);
+uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint base, uint count, bool isOut);
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t dirs, uint32_t mask);
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t values, uint32_t mask);
+void pio_interrupt_clear(PIO pio, uint irq);
+enum pio_interrupt_source
+{
+  pis_sm0_rx_fifo_not_empty = 0, pis_sm1_rx_fifo_not_empty, pis_sm2_rx_fifo_not_empty, pis_sm3_rx_fifo_not_empty,
+  pis_sm0_tx_fifo_not_full = 4, pis_sm1_tx_fifo_not_full, pis_sm2_tx_fifo_not_full, pis_sm3_tx_fifo_not_full,
+};
+
+void pio_set_irq0_source_enabled(PIO pio, uint source, bool enabled);
+void pio_set_irq1_source_enabled(PIO pio, uint source, bool enabled);
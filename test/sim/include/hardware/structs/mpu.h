@@ -0,0 +1,46 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/structs/mpu.h. one register block with both
+ * the RP2040's (rasr) and the RP2350's (rlar) region attribute register.
+ * a test defines mpu_hw and reads back what the firmware programmed
+ */
+
+#include "pico.h"
+
+#define M0PLUS_MPU_CTRL_ENABLE_BITS       0x00000001u
+#define M0PLUS_MPU_CTRL_PRIVDEFENA_BITS   0x00000004u
+#define M0PLUS_MPU_RBAR_VALID_BITS        0x00000010u
+#define M0PLUS_MPU_RBAR_REGION_BITS       0x0000000fu
+#define M0PLUS_MPU_RASR_ENABLE_BITS       0x00000001u
+#define M0PLUS_MPU_RASR_SIZE_LSB          1
+#define M0PLUS_MPU_RASR_SRD_LSB           8
+
+#define M33_MPU_CTRL_ENABLE_BITS          0x00000001u
+#define M33_MPU_CTRL_PRIVDEFENA_BITS      0x00000004u
+#define M33_MPU_RBAR_XN_BITS              0x00000001u
+#define M33_MPU_RBAR_AP_LSB               1
+#define M33_MPU_RLAR_EN_BITS              0x00000001u
+
+typedef struct
+{
+  volatile uint32_t type;
+  volatile uint32_t ctrl;
+  volatile uint32_t rnr;
+  volatile uint32_t rbar;
+  volatile uint32_t rasr;
+  volatile uint32_t rlar;
+} mpu_hw_t;
+
+extern mpu_hw_t *const mpu_hw;
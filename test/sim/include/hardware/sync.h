@@ -0,0 +1,36 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/sync.h. the barriers are real fences, __dmb()
+ * and the event instructions are calls into the model (sim_hw.c) or the
+ * boot stubs (boot_hw.c), which record them
+ */
+
+#include "pico.h"
+
+#define __dsb() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __isb() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+void __dmb(void);
+void __sev(void);
+void __wfe(void);
+void __wfi(void);
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+static inline void tight_loop_contents(void) { __wfe(); }
+
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask) { *addr |= mask; }
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask) { *addr &= ~mask; }
@@ -0,0 +1,30 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for hardware/vreg.h
+ */
+
+#include "pico.h"
+
+enum vreg_voltage
+{
+  VREG_VOLTAGE_1_05 = 0x0b,
+  VREG_VOLTAGE_1_10 = 0x0c,
+  VREG_VOLTAGE_1_15 = 0x0d,
+  VREG_VOLTAGE_1_20 = 0x0e,
+  VREG_VOLTAGE_1_25 = 0x0f,
+  VREG_VOLTAGE_1_30 = 0x10,
+};
+
+void vreg_set_voltage(enum vreg_voltage voltage);
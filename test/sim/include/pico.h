@@ -0,0 +1,41 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for the pico sdk's pico.h. just enough for the firmware
+ * sources the simulator builds natively
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define __time_critical_func(x) x
+#define __not_in_flash_func(x) x
+#define __no_inline_not_in_flash_func(x) __attribute__((noinline)) x
+#define __aligned(x) __attribute__((aligned(x)))
+#define __packed __attribute__((packed))
+#define __unused __attribute__((unused))
+#define __isr
+#define __force_inline inline __attribute__((always_inline))
+#define __scratch_x(x)
+#define __scratch_y(x)
+
+#ifndef PICO_RP2040
+#define PICO_RP2040 0
+#endif
+#ifndef PICO_RP2350
+#define PICO_RP2350 (!PICO_RP2040)
+#endif
@@ -0,0 +1,22 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for pico/binary_info.h. no binary info on the host
+ */
+
+#define bi_decl(x)
+#define bi_1pin_with_name(pin, name)
+#define bi_pin_mask_with_names(mask, names)
+#define bi_program_name(name)
+#define bi_program_version_string(version)
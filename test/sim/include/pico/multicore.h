@@ -0,0 +1,25 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for pico/multicore.h
+ */
+
+#include "pico.h"
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_reset_core1(void);
+void multicore_fifo_push_blocking(uint32_t data);
+bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeoutUs);
+uint32_t multicore_fifo_pop_blocking(void);
+bool multicore_fifo_rvalid(void);
@@ -0,0 +1,22 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for pico/time.h
+ */
+
+#include "pico.h"
+#include "hardware/timer.h"
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
@@ -0,0 +1,102 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for the pioasm output of src/tms9918.pio, assembled by hand.
+ * keep it in step with tms9918.pio
+ */
+
+#include "hardware/pio.h"
+
+// ------- //
+// tmsRead //
+// ------- //
+
+#define tmsRead_wrap_target 2
+#define tmsRead_wrap 19
+
+#define tmsRead_CSR_PIN 26
+
+static const uint16_t tmsRead_program_instructions[] = {
+    0x80a0, //  0: pull   block
+    0xa027, //  1: mov    x, osr
+            //     .wrap_target
+    0xa0e3, //  2: mov    osr, null
+    0x209a, //  3: wait   1 gpio, 26
+    0x6088, //  4: out    pindirs, 8
+    0xa0c3, //  5: mov    isr, null
+    0x8080, //  6: pull   noblock
+    0xa027, //  7: mov    x, osr
+    0x00c6, //  8: jmp    pin, 6
+    0xa742, //  9: nop                    [7]
+    0x00c6, // 10: jmp    pin, 6
+    0x4001, // 11: in     pins, 1
+    0xa046, // 12: mov    y, isr
+    0x6088, // 13: out    pindirs, 8
+    0x6008, // 14: out    pins, 8
+    0x0072, // 15: jmp    !y, 18
+    0x6008, // 16: out    pins, 8
+    0xa0c1, // 17: mov    isr, x
+    0x4001, // 18: in     pins, 1
+    0x8020, // 19: push   block
+            //     .wrap
+};
+
+static const pio_program_t tmsRead_program = {
+    .instructions = tmsRead_program_instructions,
+    .length = 20,
+    .origin = -1,
+};
+
+static inline pio_sm_config tmsRead_program_get_default_config(uint offset)
+{
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + tmsRead_wrap_target, offset + tmsRead_wrap);
+    return c;
+}
+
+// -------- //
+// tmsWrite //
+// -------- //
+
+#define tmsWrite_wrap_target 0
+#define tmsWrite_wrap 8
+
+#define tmsWrite_CSW_PIN 27
+
+static const uint16_t tmsWrite_program_instructions[] = {
+            //     .wrap_target
+    0x271b, //  0: wait   0 gpio, 27      [7]
+    0x4010, //  1: in     pins, 16
+    0xa020, //  2: mov    x, pins
+    0x00c5, //  3: jmp    pin, 5
+    0x0002, //  4: jmp    2
+    0xa742, //  5: nop                    [7]
+    0x00c8, //  6: jmp    pin, 8
+    0x0002, //  7: jmp    2
+    0x4030, //  8: in     x, 16
+            //     .wrap
+};
+
+static const pio_program_t tmsWrite_program = {
+    .instructions = tmsWrite_program_instructions,
+    .length = 9,
+    .origin = -1,
+};
+
+static inline pio_sm_config tmsWrite_program_get_default_config(uint offset)
+{
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + tmsWrite_wrap_target, offset + tmsWrite_wrap);
+    return c;
+}
@@ -0,0 +1,87 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stand-in for the pioasm output of src/vga/vga.pio, assembled by hand.
+ * keep it in step with vga.pio
+ */
+
+#include "hardware/pio.h"
+
+// ------ //
+// vga_sync //
+// ------ //
+
+#define vga_sync_wrap_target 0
+#define vga_sync_wrap 3
+
+#define vga_sync_SETUP_OVERHEAD 5
+#define vga_sync_WORD_VSYNC_OFFSET 15
+#define vga_sync_WORD_HSYNC_OFFSET 14
+#define vga_sync_WORD_EXEC_OFFSET 16
+
+static const uint16_t vga_sync_program_instructions[] = {
+            //     .wrap_target
+    0x602e, //  0: out    x, 14
+    0x6002, //  1: out    pins, 2
+    0x60f0, //  2: out    exec, 16
+    0x0043, //  3: jmp    x--, 3
+            //     .wrap
+};
+
+static const pio_program_t vga_sync_program = {
+    .instructions = vga_sync_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config vga_sync_program_get_default_config(uint offset)
+{
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + vga_sync_wrap_target, offset + vga_sync_wrap);
+    return c;
+}
+
+// ------- //
+// vga_rgb //
+// ------- //
+
+#define vga_rgb_wrap_target 0
+#define vga_rgb_wrap 4
+
+#define vga_rgb_LOOP_TICKS 2
+#define vga_rgb_DELAY_INSTR 3
+#define vga_rgb_RGB_IRQ 4
+
+static const uint16_t vga_rgb_program_instructions[] = {
+            //     .wrap_target
+    0xa003, //  0: mov    pins, null
+    0x20c4, //  1: wait   1 irq, 4
+    0xa022, //  2: mov    x, y
+    0x6010, //  3: out    pins, 16
+    0x0043, //  4: jmp    x--, 3
+            //     .wrap
+};
+
+static const pio_program_t vga_rgb_program = {
+    .instructions = vga_rgb_program_instructions,
+    .length = 5,
+    .origin = -1,
+};
+
+static inline pio_sm_config vga_rgb_program_get_default_config(uint offset)
+{
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + vga_rgb_wrap_target, offset + vga_rgb_wrap);
+    return c;
+}
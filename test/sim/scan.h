@@ -0,0 +1,122 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * main.c's display path on the hardware model. main() boots on the
+ * scan_hw.c stubs, then the test runs proc1: vgaLoop()'s request handling
+ * and idle work, between steps of the model. the host cpu reads the status
+ * register as soon as /INT is asserted (scanAckInts)
+ *
+ * include after vga.c and main.c (main renamed pico9918Main): this uses
+ * their statics
+ */
+
+#include "scan_hw.h"
+#include "sim_hw.h"
+
+#include <setjmp.h>
+#include <string.h>
+
+static uint32_t scanFrameNumber;      // vgaLoop()'s frame count
+static bool scanAckInts = true;       // the host reads the status on /INT
+
+/*
+ * the host's status register read (through the read state machine's irq)
+ */
+static uint8_t scanReadStatus(void)
+{
+  const uint8_t status = TMS_STATUS(tms9918, 0);
+  TMS_PIO->rxf[tmsReadSm] = 0x01 | (uint32_t)status << 17;
+  tmsReadIrqHandler();
+  return status;
+}
+
+/*
+ * one pass of proc1's loop: a request, or the idle work and the model run
+ * on (at most maxTicks) until the next one
+ */
+static void scanStep(uint64_t maxTicks)
+{
+  if (requestPending())
+  {
+    vgaServiceRequest(&scanFrameNumber);
+  }
+  else if (vgaParams.idleFn)
+  {
+    vgaParams.idleFn();
+    const uint64_t us = simSysClockHz() / 1000000;
+    simHwAdvance(maxTicks < us ? maxTicks : us);
+  }
+  else
+  {
+    simHwAdvance(maxTicks);
+  }
+
+  if (scanAckInts && scanStats.intActive)
+    scanReadStatus();
+}
+
+/* run for us microseconds */
+static void scanRun(uint32_t us)
+{
+  const uint64_t end = simTicks() + (uint64_t)us * (simSysClockHz() / 1000000);
+  while (simTicks() < end)
+    scanStep(end - simTicks());
+}
+
+/* run until vgaLoop() has handled count more ends of frame */
+static void scanRunFrames(uint32_t count)
+{
+  const uint32_t end = scanFrameNumber + count;
+  while (scanFrameNumber != end)
+    scanStep(UINT64_MAX);
+}
+
+/*
+ * a cold boot into vga mode vgaMode (CONF_VGA_MODE) with a vdp rate
+ * (CONF_VDP_RATE), past the splash: the display enabled with interrupts
+ * (R1 0x60) on a blue backdrop. then two frames: the display's geometry
+ * (vBorder, vPixels) is set at the end of the first, and the config it
+ * read (the palette) is applied there, for the second
+ */
+static void scanBoot(uint8_t vgaMode, uint8_t vdpRate)
+{
+  simHwReset();
+  scanHwReset();
+  scanFrameNumber = 0;
+
+  if (!setjmp(scanExit))
+    pico9918Main();
+
+  // the defaults main() booted into, switched the way a saved change is
+  tms9918->config[CONF_DISP_DRIVER_PREF] = 1;
+  tms9918->config[CONF_VGA_MODE] = vgaMode;
+  tms9918->config[CONF_VDP_RATE] = vdpRate;
+  applyClock(configDisplayPlan(tms9918->config).clock);
+  switchDisplayMode();
+
+  // what proc1Entry() does before the vga loop: release /INT
+  gpio_set_mask(GPIO_INT_MASK);
+
+  validWrites = true;
+  frameCount = 600;
+  TMS_REGISTER(tms9918, 0) = 0x00;
+  TMS_REGISTER(tms9918, 1) = 0x60;
+  TMS_REGISTER(tms9918, 7) = 0x04;
+
+  scanRunFrames(2);
+
+  const bool intActive = scanStats.intActive;
+  memset(&scanStats, 0, sizeof(scanStats));
+  scanStats.intActive = intActive;
+}
@@ -0,0 +1,200 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * host stubs for running main.c's display path on the hardware model
+ * (see scan_hw.h)
+ *
+ * the vdp fills each line with one colour index (the frame count, or
+ * scanLineColour) and returns the status the test scripts for it. /INT
+ * assertions are counted with the model's time. the diagnostics, splash,
+ * temperature and gpu are inert: only the display path runs
+ */
+
+#include "scan_hw.h"
+
+#include "hardware/flash.h"
+#include "hardware/gpio.h"
+#include "hardware/vreg.h"
+#include "pico/multicore.h"
+#include "pico/time.h"
+
+#include "diag.h"
+#include "gpio.h"
+#include "gpu.h"
+#include "splash.h"
+#include "temperature.h"
+
+#include "impl/vrEmuTms9918Priv.h"
+
+#include <string.h>
+
+uint8_t simFlash[SCAN_FLASH_BYTES];
+jmp_buf scanExit;
+
+uint8_t (*scanLineColour)(uint8_t y) = NULL;
+uint8_t scanLineStatus[256];
+ScanStats scanStats;
+
+static VrEmuTms9918 vdp;
+VrEmuTms9918 *tms9918 = &vdp;
+
+static uint32_t gpioOut;
+
+void scanHwReset(void)
+{
+  memset(simFlash, 0xff, sizeof(simFlash));
+  memset(&vdp, 0, sizeof(vdp));
+  memset(scanLineStatus, 0, sizeof(scanLineStatus));
+  memset(&scanStats, 0, sizeof(scanStats));
+  scanLineColour = NULL;
+  gpioOut = 0;
+}
+
+/* time. the model runs on through a sleep */
+
+void sleep_ms(uint32_t ms)
+{
+  busy_wait_us_32(ms * 1000);
+}
+
+void vreg_set_voltage(enum vreg_voltage voltage) { (void)voltage; }
+
+/* flash */
+
+void flash_range_erase(uint32_t flashOffs, size_t count)
+{
+  memset(simFlash + flashOffs, 0xff, count);
+}
+
+void flash_range_program(uint32_t flashOffs, const uint8_t *data, size_t count)
+{
+  for (size_t i = 0; i < count; ++i)
+    simFlash[flashOffs + i] &= data[i];
+}
+
+/* gpio. only /INT (active low) is watched */
+
+static void setGpioOut(uint32_t value)
+{
+  gpioOut = value;
+
+  const bool intActive = !(gpioOut & GPIO_INT_MASK);
+  if (intActive && !scanStats.intActive)
+  {
+    if (scanStats.ints < SCAN_MAX_INTS)
+      scanStats.intUs[scanStats.ints] = time_us_64();
+    ++scanStats.ints;
+  }
+  scanStats.intActive = intActive;
+}
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_init_mask(uint32_t mask) { (void)mask; }
+void gpio_set_function_masked(uint32_t mask, enum gpio_function fn) { (void)mask; (void)fn; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_set_dir_masked(uint32_t mask, uint32_t value) { (void)mask; (void)value; }
+void gpio_set_dir_all_bits(uint32_t values) { (void)values; }
+void gpio_set_drive_strength(uint gpio, enum gpio_drive_strength drive) { (void)gpio; (void)drive; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+void gpio_pull_down(uint gpio) { (void)gpio; }
+void gpio_disable_pulls(uint gpio) { (void)gpio; }
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) { (void)gpio; (void)events; (void)enabled; }
+void gpio_acknowledge_irq(uint gpio, uint32_t events) { (void)gpio; (void)events; }
+void gpio_put(uint gpio, bool value) { setGpioOut(value ? (gpioOut | (1u << gpio)) : (gpioOut & ~(1u << gpio))); }
+void gpio_put_all(uint32_t value) { setGpioOut(value); }
+void gpio_set_mask(uint32_t mask) { setGpioOut(gpioOut | mask); }
+void gpio_clr_mask(uint32_t mask) { setGpioOut(gpioOut & ~mask); }
+bool gpio_get(uint gpio) { return (gpioOut >> gpio) & 1; }
+
+/* proc1 is the test's loop (scan.h) */
+
+void multicore_launch_core1(void (*entry)(void)) { (void)entry; }
+void multicore_fifo_push_blocking(uint32_t data) { (void)data; }
+uint32_t multicore_fifo_pop_blocking(void) { return 0; }
+
+/* the vdp emulator */
+
+void vrEmuTms9918Reset(void)
+{
+  for (int i = 0; i < 64; ++i)
+    vdp.vram.map.pram[i] = vrEmuTms9918DefaultPalette(i & 0x0f);
+}
+
+void vrEmuTms9918Init(void)
+{
+  memset(&vdp, 0, sizeof(vdp));
+  vrEmuTms9918Reset();
+}
+
+uint8_t vrEmuTms9918ScanLine(uint8_t y, uint8_t pixels[])
+{
+  ++scanStats.scanLines;
+  if (y == 0)
+    ++scanStats.frames;
+
+  const uint8_t colour = scanLineColour ? scanLineColour(y) : 1 + scanStats.frames % 15;
+  memset(pixels, colour, TMS9918_PIXELS_X);
+  return scanLineStatus[y];
+}
+
+uint8_t vrEmuTms9918RegValue(vrEmuTms9918Register reg) { return vdp.registers[reg]; }
+vrEmuTms9918Mode vrEmuTms9918DisplayMode(VrEmuTms9918 *tms) { (void)tms; return TMS_MODE_GRAPHICS_I; }
+void vrEmuTms9918SetStatusImpl(uint8_t status) { vdp.status[0] = status; }
+
+/* the frame interrupt (R1 IE) or the F18A line interrupt (R0 IE1) */
+bool vrEmuTms9918InterruptStatusImpl(void)
+{
+  return ((vdp.status[0] & STATUS_INT) && (vdp.registers[1] & 0x20)) ||
+         ((vdp.status[1] & 0x01) && (vdp.registers[0] & 0x10));
+}
+
+void vrEmuTms9918WriteAddrImpl(uint8_t data) { (void)data; }
+void vrEmuTms9918WriteDataImpl(uint8_t data) { (void)data; }
+uint8_t vrEmuTms9918ReadDataNoIncImpl(void) { return 0; }
+uint8_t vrEmuTms9918ReadAheadDataImpl(void) { return 0; }
+uint16_t vrEmuTms9918DefaultPalette(int index) { return (uint16_t)(index * 0x111); }
+
+/* the gpu: main() ends as core 0 enters its loop */
+
+extern inline void gpuTrigger();
+
+void gpuInit() {}
+
+void gpuLoop()
+{
+  longjmp(scanExit, 1);
+}
+
+/* diagnostics, splash and temperature: inert */
+
+void initDiagnostics() {}
+void diagSetTemperature(float tempC) { (void)tempC; }
+void diagSetClockHz(float clockHz) { (void)clockHz; }
+void diagSetModeFallback(bool fallback) { (void)fallback; }
+void diagBootPhase(DiagBootPhase phase) { (void)phase; }
+void diagnosticsConfigUpdated() {}
+void updateDiagnostics(uint32_t frameCount) { (void)frameCount; }
+void updateRenderTime(uint32_t renderTime, uint32_t frameTime) { (void)renderTime; (void)frameTime; }
+int renderText(uint16_t scanline, const char *text, uint16_t x, uint16_t y, uint16_t fg, uint16_t bg, uint16_t *pixels)
+{
+  (void)scanline; (void)text; (void)x; (void)y; (void)fg; (void)bg; (void)pixels;
+  return 0;
+}
+void renderDiagnostics(uint16_t y, uint16_t *pixels) { (void)y; (void)pixels; }
+void resetSplash() {}
+void allowSplashHide() {}
+void outputSplash(uint16_t y, uint32_t frameCount, uint32_t vBorder, uint32_t vPixels, uint16_t *pixels)
+{
+  (void)y; (void)frameCount; (void)vBorder; (void)vPixels; (void)pixels;
+}
+void initTemperature() {}
+float coreTemperatureC() { return 25.0f; }
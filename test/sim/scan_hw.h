@@ -0,0 +1,49 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host stubs for running main.c's display path (its scanline callbacks
+ * and vga.c) on the hardware model (sim_hw.c): a scriptable vdp emulator,
+ * the /INT pin, and the modules main() reaches that the display doesn't.
+ * scan.h boots main() on these and runs proc1
+ */
+
+#include "pico.h"
+
+#include <setjmp.h>
+
+#define SCAN_FLASH_BYTES 0x200000
+#define SCAN_MAX_INTS    256
+
+typedef struct
+{
+  uint32_t scanLines;               // vrEmuTms9918ScanLine() calls
+  uint32_t frames;                  // of them, line 0s
+  uint32_t ints;                    // /INT assertions
+  uint64_t intUs[SCAN_MAX_INTS];    // when, the first SCAN_MAX_INTS
+  bool intActive;                   // /INT asserted now
+} ScanStats;
+
+/* the colour index vrEmuTms9918ScanLine() fills line y with (default: the frame count, 1 to 15) */
+extern uint8_t (*scanLineColour)(uint8_t y);
+
+/* the status vrEmuTms9918ScanLine() returns for line y (5S, COL and the sprite number) */
+extern uint8_t scanLineStatus[256];
+
+extern ScanStats scanStats;
+
+/* gpuLoop() returns here (longjmp value 1): the end of main() */
+extern jmp_buf scanExit;
+
+/* a powered-up board: erased flash, a reset vdp, no stats. the model is reset separately */
+void scanHwReset(void);
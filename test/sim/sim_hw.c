@@ -0,0 +1,1262 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * host model of the RP2040 hardware behind the sdk stand-ins: dma channels
+ * (chaining, irq quiet/null triggers, rings, dreqs from the pio tx fifos),
+ * pio state machines running their programs cycle by cycle, irq handlers
+ * and the system clock
+ *
+ * it steps one system clock at a time. the irq handlers run in zero time
+ * between steps, and the dma moves as much as its dreqs allow each step
+ */
+
+#include "sim_hw.h"
+
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/clocks.h"
+#include "hardware/timer.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_DEFAULT_SYS_CLOCK_HZ 125000000
+
+// a pio state machine
+typedef struct
+{
+  bool enabled;
+  uint8_t pc;
+  uint32_t x, y, osr, isr;
+  uint8_t osrCount, isrCount;         // bits shifted out of the osr / into the isr
+  uint8_t delay;
+  bool execPending;                   // OUT/MOV EXEC: run execInstr next cycle
+  uint16_t execInstr;
+  uint32_t fifo[8];
+  uint8_t fifoHead, fifoCount;
+  float divAcc;
+  pio_sm_config config;
+  SimSmStats stats;
+} SimSm;
+
+typedef struct
+{
+  uint16_t instr[PIO_INSTRUCTION_COUNT];
+  uint32_t used;                      // instruction memory bitmap
+  SimSm sm[NUM_PIO_STATE_MACHINES];
+  uint32_t pins, pindirs;
+} SimPio;
+
+static dma_hw_t simDma;
+dma_hw_t *const dma_hw = &simDma;
+
+static pio_hw_t simPioRegs[2];
+pio_hw_t *const pio0_hw = &simPioRegs[0];
+pio_hw_t *const pio1_hw = &simPioRegs[1];
+
+static SimPio simPio[2];
+static uint32_t dmaClaimed = 0;
+static uint32_t dmaReload[NUM_DMA_CHANNELS];     // transfer count loaded on each trigger
+static irq_handler_t irqHandlers[NUM_IRQS];
+static uint32_t irqEnabled = 0;
+static uint32_t sysClockHz = SIM_DEFAULT_SYS_CLOCK_HZ;
+static uint64_t ticks = 0;
+static uint64_t extraUs = 0;                     // busy waits while the model isn't stepping
+static void (*wfeHook)(void) = NULL;
+static SimDmaHook dmaHook = NULL;
+static SimPinHook pinHook = NULL;
+static SimIrqHook irqHook = NULL;
+static int irqDepth = 0;
+static uint32_t shownInts[2];                    // ints0/1 as the model last set them
+
+static SimPio *simPioOf(PIO pio)
+{
+  return &simPio[pio == pio1];
+}
+
+void simHwReset(void)
+{
+  memset(&simDma, 0, sizeof(simDma));
+  memset(simPioRegs, 0, sizeof(simPioRegs));
+  memset(simPio, 0, sizeof(simPio));
+
+  // the state machines come out of reset with the hardware's shift and clock
+  // settings, which pio_set_x/y() rely on before pio_sm_init()
+  for (int i = 0; i < 2; ++i)
+  {
+    for (int sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm)
+      simPio[i].sm[sm].config = pio_get_default_sm_config();
+  }
+  memset(dmaReload, 0, sizeof(dmaReload));
+  memset(irqHandlers, 0, sizeof(irqHandlers));
+  dmaClaimed = 0;
+  irqEnabled = 0;
+  sysClockHz = SIM_DEFAULT_SYS_CLOCK_HZ;
+  ticks = 0;
+  extraUs = 0;
+  wfeHook = NULL;
+  dmaHook = NULL;
+  pinHook = NULL;
+  irqHook = NULL;
+  irqDepth = 0;
+  shownInts[0] = shownInts[1] = 0;
+}
+
+uint32_t simSysClockHz(void)
+{
+  return sysClockHz;
+}
+
+uint64_t simTicks(void)
+{
+  return ticks;
+}
+
+void simSetWfeHook(void (*hook)(void))
+{
+  wfeHook = hook;
+}
+
+void simSetDmaHook(SimDmaHook hook)
+{
+  dmaHook = hook;
+}
+
+void simSetPinHook(SimPinHook hook)
+{
+  pinHook = hook;
+}
+
+void simSetIrqHook(SimIrqHook hook)
+{
+  irqHook = hook;
+}
+
+irq_handler_t simIrqHandler(uint num)
+{
+  return (irqEnabled & (1u << num)) ? irqHandlers[num] : NULL;
+}
+
+const SimSmStats *simSmStats(PIO pio, uint sm)
+{
+  return &simPioOf(pio)->sm[sm].stats;
+}
+
+uint32_t simSmTxLevel(PIO pio, uint sm)
+{
+  return simPioOf(pio)->sm[sm].fifoCount;
+}
+
+uint32_t simPioPins(PIO pio)
+{
+  const SimPio *p = simPioOf(pio);
+  return p->pins & p->pindirs;
+}
+
+/* pio state machines */
+
+static uint32_t fifoDepth(const SimSm *s)
+{
+  return s->config.fifoJoin == PIO_FIFO_JOIN_TX ? 8 : 4;
+}
+
+static bool fifoPush(SimSm *s, uint32_t value)
+{
+  if (s->fifoCount >= fifoDepth(s))
+    return false;
+  s->fifo[(s->fifoHead + s->fifoCount++) & 7] = value;
+  return true;
+}
+
+static uint32_t fifoPop(SimSm *s)
+{
+  const uint32_t value = s->fifo[s->fifoHead];
+  s->fifoHead = (s->fifoHead + 1) & 7;
+  --s->fifoCount;
+  return value;
+}
+
+static void pull(SimSm *s)
+{
+  s->osr = fifoPop(s);
+  s->osrCount = 0;
+  ++s->stats.txPulls;
+}
+
+static void writePins(SimPio *p, uint base, uint count, uint32_t value)
+{
+  const uint32_t mask = (count >= 32) ? 0xffffffffu : ((1u << count) - 1);
+  p->pins = (p->pins & ~(mask << base)) | ((value & mask) << base);
+}
+
+static void writePindirs(SimPio *p, uint base, uint count, uint32_t value)
+{
+  const uint32_t mask = (count >= 32) ? 0xffffffffu : ((1u << count) - 1);
+  p->pindirs = (p->pindirs & ~(mask << base)) | ((value & mask) << base);
+}
+
+static uint32_t bitReverse(uint32_t v)
+{
+  uint32_t r = 0;
+  for (int i = 0; i < 32; ++i, v >>= 1)
+    r = (r << 1) | (v & 1);
+  return r;
+}
+
+typedef enum { EXEC_DONE, EXEC_STALL, EXEC_JUMP } ExecResult;
+
+/*
+ * one instruction, as far as the firmware's programs need: JMP, WAIT IRQ,
+ * IN, OUT (with autopull), PULL, MOV, IRQ and SET. no side-set
+ */
+static ExecResult execute(SimPio *p, pio_hw_t *regs, SimSm *s, uint16_t instr)
+{
+  const uint op = instr >> 13;
+  const uint arg1 = (instr >> 5) & 0x07;
+  const uint arg2 = instr & 0x1f;
+  const pio_sm_config *c = &s->config;
+
+  switch (op)
+  {
+    case 0:   // JMP
+    {
+      bool taken;
+      switch (arg1)
+      {
+        case 0: taken = true; break;
+        case 1: taken = s->x == 0; break;
+        case 2: taken = s->x != 0; --s->x; break;
+        case 3: taken = s->y == 0; break;
+        case 4: taken = s->y != 0; --s->y; break;
+        case 5: taken = s->x != s->y; break;
+        case 6: taken = false; break;
+        default: taken = s->osrCount < c->pullThreshold; break;
+      }
+      if (!taken)
+        return EXEC_DONE;
+      s->pc = arg2;
+      return EXEC_JUMP;
+    }
+
+    case 1:   // WAIT (irq only. pin/gpio waits pass)
+    {
+      const bool polarity = instr & 0x80;
+      const uint source = (instr >> 5) & 0x03;
+      if (source != 2)
+        return EXEC_DONE;
+      const uint32_t bit = 1u << (arg2 & 0x07);
+      if (polarity)
+      {
+        if (!(regs->irq & bit))
+          return EXEC_STALL;
+        regs->irq &= ~bit;
+      }
+      else if (regs->irq & bit)
+      {
+        return EXEC_STALL;
+      }
+      return EXEC_DONE;
+    }
+
+    case 2:   // IN
+    {
+      const uint count = arg2 ? arg2 : 32;
+      uint32_t data;
+      switch (arg1)
+      {
+        case 1: data = s->x; break;
+        case 2: data = s->y; break;
+        case 6: data = s->isr; break;
+        case 7: data = s->osr; break;
+        default: data = 0; break;
+      }
+      const uint32_t mask = (count >= 32) ? 0xffffffffu : ((1u << count) - 1);
+      if (c->inShiftRight)
+        s->isr = (count >= 32) ? data : ((s->isr >> count) | ((data & mask) << (32 - count)));
+      else
+        s->isr = (count >= 32) ? data : ((s->isr << count) | (data & mask));
+      s->isrCount = (s->isrCount + count > 32) ? 32 : s->isrCount + count;
+      return EXEC_DONE;
+    }
+
+    case 3:   // OUT
+    {
+      if (c->autopull && s->osrCount >= c->pullThreshold)
+      {
+        if (!s->fifoCount)
+        {
+          ++s->stats.outStalls;
+          return EXEC_STALL;
+        }
+        pull(s);
+      }
+
+      const uint count = arg2 ? arg2 : 32;
+      uint32_t data;
+      if (c->outShiftRight)
+      {
+        data = (count >= 32) ? s->osr : (s->osr & ((1u << count) - 1));
+        s->osr = (count >= 32) ? 0 : (s->osr >> count);
+      }
+      else
+      {
+        data = (count >= 32) ? s->osr : (s->osr >> (32 - count));
+        s->osr = (count >= 32) ? 0 : (s->osr << count);
+      }
+      s->osrCount = (s->osrCount + count > 32) ? 32 : s->osrCount + count;
+
+      ExecResult result = EXEC_DONE;
+      switch (arg1)
+      {
+        case 0: writePins(p, c->outBase, c->outCount, data); break;
+        case 1: s->x = data; break;
+        case 2: s->y = data; break;
+        case 4: writePindirs(p, c->outBase, c->outCount, data); break;
+        case 5: s->pc = data & 0x1f; result = EXEC_JUMP; break;
+        case 6: s->isr = data; s->isrCount = count; break;
+        case 7: s->execPending = true; s->execInstr = (uint16_t)data; break;
+        default: break;
+      }
+
+      // the autopull refills the emptied osr straight away when it can
+      if (c->autopull && s->osrCount >= c->pullThreshold && s->fifoCount)
+        pull(s);
+      return result;
+    }
+
+    case 4:   // PUSH / PULL
+    {
+      if (!(instr & 0x80))
+      {
+        s->isr = 0;
+        s->isrCount = 0;
+        return EXEC_DONE;
+      }
+      const bool ifEmpty = instr & 0x40, block = instr & 0x20;
+      if (ifEmpty && s->osrCount < c->pullThreshold)
+        return EXEC_DONE;
+      if (!s->fifoCount)
+      {
+        if (block)
+          return EXEC_STALL;
+        s->osr = s->x;
+        s->osrCount = 0;
+        return EXEC_DONE;
+      }
+      pull(s);
+      return EXEC_DONE;
+    }
+
+    case 5:   // MOV
+    {
+      const uint src = instr & 0x07;
+      const uint mop = (instr >> 3) & 0x03;
+      uint32_t data;
+      switch (src)
+      {
+        case 0: data = p->pins; break;
+        case 1: data = s->x; break;
+        case 2: data = s->y; break;
+        case 5: data = (s->fifoCount < fifoDepth(s)) ? 0xffffffffu : 0; break;
+        case 6: data = s->isr; break;
+        case 7: data = s->osr; break;
+        default: data = 0; break;
+      }
+      if (mop == 1) data = ~data;
+      else if (mop == 2) data = bitReverse(data);
+
+      switch (arg1)
+      {
+        case 0: writePins(p, c->outBase, c->outCount, data); break;
+        case 1: s->x = data; break;
+        case 2: s->y = data; break;
+        case 4: s->execPending = true; s->execInstr = (uint16_t)data; break;
+        case 5: s->pc = data & 0x1f; return EXEC_JUMP;
+        case 6: s->isr = data; s->isrCount = 0; break;
+        case 7: s->osr = data; s->osrCount = 0; break;
+        default: break;
+      }
+      return EXEC_DONE;
+    }
+
+    case 6:   // IRQ
+    {
+      const uint32_t bit = 1u << (arg2 & 0x07);
+      if (instr & 0x40)
+        regs->irq &= ~bit;
+      else
+        regs->irq |= bit;
+      return EXEC_DONE;
+    }
+
+    default:  // SET
+    {
+      switch (arg1)
+      {
+        case 0: writePins(p, c->setBase, c->setCount, arg2); break;
+        case 1: s->x = arg2; break;
+        case 2: s->y = arg2; break;
+        case 4: writePindirs(p, c->setBase, c->setCount, arg2); break;
+        default: break;
+      }
+      return EXEC_DONE;
+    }
+  }
+}
+
+/*
+ * one cycle of a state machine
+ */
+static void smCycle(SimPio *p, pio_hw_t *regs, SimSm *s)
+{
+  if (s->delay)
+  {
+    --s->delay;
+    return;
+  }
+
+  const bool fromExec = s->execPending;
+  const uint16_t instr = fromExec ? s->execInstr : p->instr[s->pc];
+  s->execPending = false;
+
+  const ExecResult result = execute(p, regs, s, instr);
+  if (result == EXEC_STALL)
+  {
+    if (fromExec)
+    {
+      s->execPending = true;
+      s->execInstr = instr;
+    }
+    return;
+  }
+
+  // an executed instruction runs in place of the next one rather than advancing
+  if (result != EXEC_JUMP && !fromExec)
+    s->pc = (s->pc == s->config.wrap) ? s->config.wrapTarget : s->pc + 1;
+
+  // OUT/MOV EXEC ignore their own delay
+  if (!s->execPending)
+    s->delay = (instr >> 8) & 0x1f;
+}
+
+/* dma */
+
+/*
+ * bring ints0/1 up to date with the raw interrupts. a value the firmware
+ * stored there since is a write-one-to-clear acknowledge. (a store of the
+ * value already shown isn't seen: use dma_channel_acknowledge_irq0/1)
+ */
+static void syncInts(void)
+{
+  if (simDma.ints0 != shownInts[0]) simDma.intr &= ~simDma.ints0;
+  if (simDma.ints1 != shownInts[1]) simDma.intr &= ~simDma.ints1;
+  simDma.ints0 = shownInts[0] = simDma.intr & simDma.inte0;
+  simDma.ints1 = shownInts[1] = simDma.intr & simDma.inte1;
+}
+
+static void dmaRaise(uint chan)
+{
+  syncInts();
+  simDma.intr |= 1u << chan;
+  syncInts();
+}
+
+static bool dreqReady(uint treq)
+{
+  if (treq == DREQ_FORCE)
+    return true;
+  if (treq >= 16 || (treq & 0x04))
+    return false;   // only the pio tx dreqs are modelled
+  SimSm *s = &simPio[treq >> 3].sm[treq & 0x03];
+  return s->fifoCount < fifoDepth(s);
+}
+
+static void dmaTrigger(uint chan);
+
+/*
+ * a dma write into a channel's registers. the firmware only does this
+ * through trigger aliases, so any write to the read address triggers
+ */
+static bool dmaRegisterWrite(uintptr_t addr, uintptr_t value)
+{
+  const uintptr_t base = (uintptr_t)&simDma.ch[0];
+  if (addr < base || addr >= base + sizeof(simDma.ch))
+    return false;
+
+  const uint chan = (addr - base) / sizeof(dma_channel_hw_t);
+  dma_channel_hw_t *ch = &simDma.ch[chan];
+  if (addr == (uintptr_t)&ch->read_addr)
+  {
+    ch->read_addr = value;
+    if (value)
+      dmaTrigger(chan);
+    else if (ch->ctrl_trig & DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS)
+      dmaRaise(chan);   // null trigger
+  }
+  else if (addr == (uintptr_t)&ch->write_addr)
+  {
+    ch->write_addr = value;
+  }
+  else if (addr == (uintptr_t)&ch->transfer_count)
+  {
+    dmaReload[chan] = (uint32_t)value;
+  }
+  else
+  {
+    ch->ctrl_trig = (ch->ctrl_trig & DMA_CH0_CTRL_TRIG_BUSY_BITS) | (uint32_t)value;
+  }
+  return true;
+}
+
+static bool pioTxWrite(uintptr_t addr, uint32_t value)
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    const uintptr_t base = (uintptr_t)&simPioRegs[i].txf[0];
+    if (addr >= base && addr < base + sizeof(simPioRegs[i].txf))
+    {
+      fifoPush(&simPio[i].sm[(addr - base) / sizeof(uint32_t)], value);
+      return true;
+    }
+  }
+  return false;
+}
+
+static uintptr_t ringWrap(uintptr_t addr, uintptr_t next, uint32_t ctrl, bool write)
+{
+  const uint ringBits = (ctrl & DMA_CH0_CTRL_TRIG_RING_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_RING_SIZE_LSB;
+  if (!ringBits || ((ctrl & DMA_CH0_CTRL_TRIG_RING_SEL_BITS) != 0) != write)
+    return next;
+  const uintptr_t mask = ((uintptr_t)1 << ringBits) - 1;
+  return (addr & ~mask) | (next & mask);
+}
+
+/*
+ * one transfer. a 32-bit transfer into a dma address register moves a
+ * host pointer, so lists of pointers work as they do on the device
+ */
+static void dmaTransfer(uint chan)
+{
+  dma_channel_hw_t *ch = &simDma.ch[chan];
+  const uint32_t ctrl = ch->ctrl_trig;
+  const uintptr_t base = (uintptr_t)&simDma.ch[0];
+  const bool toDmaReg = ch->write_addr >= base && ch->write_addr < base + sizeof(simDma.ch);
+  const bool toAddrReg = toDmaReg && ((ch->write_addr - base) % sizeof(dma_channel_hw_t)) < 2 * sizeof(uintptr_t);
+
+  uint32_t size = 1u << ((ctrl & DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB);
+  uintptr_t value;
+  if (toAddrReg && size == 4)
+  {
+    size = sizeof(uintptr_t);
+    value = *(const uintptr_t *)ch->read_addr;
+  }
+  else if (size == 4)
+  {
+    value = *(const uint32_t *)ch->read_addr;
+  }
+  else if (size == 2)
+  {
+    value = *(const uint16_t *)ch->read_addr;
+  }
+  else
+  {
+    value = *(const uint8_t *)ch->read_addr;
+  }
+
+  const uintptr_t writeAddr = ch->write_addr;
+  if (ctrl & DMA_CH0_CTRL_TRIG_INCR_READ_BITS)
+    ch->read_addr = ringWrap(ch->read_addr, ch->read_addr + size, ctrl, false);
+  if (ctrl & DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS)
+    ch->write_addr = ringWrap(ch->write_addr, ch->write_addr + size, ctrl, true);
+  --ch->transfer_count;
+
+  if (dmaRegisterWrite(writeAddr, value) || pioTxWrite(writeAddr, (uint32_t)value))
+    return;
+
+  if (size == 4) *(uint32_t *)writeAddr = (uint32_t)value;
+  else if (size == 2) *(uint16_t *)writeAddr = (uint16_t)value;
+  else *(uint8_t *)writeAddr = (uint8_t)value;
+}
+
+static void dmaTrigger(uint chan)
+{
+  dma_channel_hw_t *ch = &simDma.ch[chan];
+  if (!(ch->ctrl_trig & DMA_CH0_CTRL_TRIG_EN_BITS))
+    return;
+
+  ch->transfer_count = dmaReload[chan];
+  ch->ctrl_trig |= DMA_CH0_CTRL_TRIG_BUSY_BITS;
+  if (dmaHook)
+    dmaHook(chan, SIM_DMA_TRIGGER, ch->read_addr);
+}
+
+static void dmaComplete(uint chan)
+{
+  dma_channel_hw_t *ch = &simDma.ch[chan];
+  ch->ctrl_trig &= ~DMA_CH0_CTRL_TRIG_BUSY_BITS;
+  if (!(ch->ctrl_trig & DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS))
+    dmaRaise(chan);
+
+  const uint chainTo = (ch->ctrl_trig & DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS) >> DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB;
+  if (chainTo != chan)
+    dmaTrigger(chainTo);
+}
+
+/*
+ * run the dma until every busy channel is waiting on its dreq. transfers
+ * take no time: the dma is much faster than the pio programs it feeds
+ */
+static void dmaRun(void)
+{
+  syncInts();
+
+  if (simDma.abort)
+  {
+    for (uint chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+    {
+      if (simDma.abort & (1u << chan))
+        dma_channel_abort(chan);
+    }
+    simDma.abort = 0;
+  }
+
+  bool progress = true;
+  while (progress)
+  {
+    progress = false;
+    for (uint chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+    {
+      dma_channel_hw_t *ch = &simDma.ch[chan];
+      if (!(ch->ctrl_trig & DMA_CH0_CTRL_TRIG_BUSY_BITS))
+        continue;
+
+      const uint treq = (ch->ctrl_trig & DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS) >> DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB;
+      while (ch->transfer_count && dreqReady(treq))
+      {
+        dmaTransfer(chan);
+        progress = true;
+      }
+      if (!ch->transfer_count)
+      {
+        dmaComplete(chan);
+        progress = true;
+      }
+    }
+  }
+}
+
+/*
+ * call the handlers for pending, enabled dma interrupts, until they're
+ * acknowledged
+ */
+static void dmaIrqs(void)
+{
+  for (int line = 0; line < 2; ++line)
+  {
+    volatile uint32_t *ints = line ? &simDma.ints1 : &simDma.ints0;
+    const uint irq = line ? DMA_IRQ_1 : DMA_IRQ_0;
+    irq_handler_t handler = simIrqHandler(irq);
+    if (!handler || irqDepth)
+      continue;
+
+    syncInts();
+    for (int calls = 0; *ints && calls < 16; ++calls)
+    {
+      ++irqDepth;
+      if (irqHook) irqHook(irq, true);
+      handler();
+      if (irqHook) irqHook(irq, false);
+      --irqDepth;
+      dmaRun();
+    }
+  }
+}
+
+void simHwStep(void)
+{
+  ++ticks;
+  dmaRun();
+
+  for (int i = 0; i < 2; ++i)
+  {
+    SimPio *p = &simPio[i];
+    const uint32_t before = p->pins & p->pindirs;
+    for (int sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm)
+    {
+      SimSm *s = &p->sm[sm];
+      if (!s->enabled)
+        continue;
+      s->divAcc += 1.0f;
+      if (s->divAcc < s->config.clkdiv)
+        continue;
+      s->divAcc -= s->config.clkdiv;
+      smCycle(p, &simPioRegs[i], s);
+    }
+    const uint32_t after = p->pins & p->pindirs;
+    if (pinHook && after != before)
+      pinHook(i, ticks, after);
+  }
+
+  dmaRun();
+  dmaIrqs();
+}
+
+/*
+ * system clocks until a state machine's next cycle, and how many cycles
+ * after that it only counts down (a delay, a "jmp x--" to itself, a stall
+ * on an empty fifo or an irq). UINT32_MAX if it could stay like that
+ * indefinitely. 0 cycles if its clock divider isn't an integer
+ */
+static uint32_t smQuietCycles(const SimPio *p, const pio_hw_t *regs, const SimSm *s, uint32_t *ticksToCycle)
+{
+  if (s->config.clkdiv != (float)(uint32_t)s->config.clkdiv)
+    return 0;
+  *ticksToCycle = (uint32_t)(s->config.clkdiv - s->divAcc);
+
+  if (s->delay)
+    return s->delay;
+  if (s->execPending)
+    return 0;
+
+  const uint16_t instr = p->instr[s->pc];
+  if ((instr & 0xffe0) == 0x0040 && (instr & 0x1f) == s->pc)    // jmp x-- to itself, no delay
+    return s->x;
+  if ((instr & 0xe060) == 0x2040)                               // wait irq
+    return ((regs->irq >> (instr & 0x07)) & 1) == ((instr >> 7) & 1) ? 0 : UINT32_MAX;
+  if ((instr & 0xe000) == 0x6000 && s->config.autopull &&       // out, waiting on an empty fifo
+      s->osrCount >= s->config.pullThreshold && !s->fifoCount)
+    return UINT32_MAX;
+  return 0;
+}
+
+static void smSkipCycles(const SimPio *p, SimSm *s, uint32_t cycles)
+{
+  if (s->delay)
+    s->delay -= cycles;
+  else if ((p->instr[s->pc] & 0xe000) == 0x0000)
+    s->x -= cycles;
+  else if ((p->instr[s->pc] & 0xe000) == 0x6000)
+    s->stats.outStalls += cycles;
+}
+
+static bool dmaIdle(void)
+{
+  for (uint chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+  {
+    const uint32_t ctrl = simDma.ch[chan].ctrl_trig;
+    if ((ctrl & DMA_CH0_CTRL_TRIG_BUSY_BITS) &&
+        dreqReady((ctrl & DMA_CH0_CTRL_TRIG_TREQ_SEL_BITS) >> DMA_CH0_CTRL_TRIG_TREQ_SEL_LSB))
+      return false;
+  }
+  return !simDma.abort && !(simDma.intr & (simDma.inte0 | simDma.inte1));
+}
+
+uint64_t simHwAdvance(uint64_t maxTicks)
+{
+  uint64_t skip = maxTicks ? maxTicks - 1 : 0;
+
+  if (skip && dmaIdle())
+  {
+    for (int i = 0; i < 2 && skip; ++i)
+    {
+      const SimPio *p = &simPio[i];
+      for (int sm = 0; sm < NUM_PIO_STATE_MACHINES && skip; ++sm)
+      {
+        const SimSm *s = &p->sm[sm];
+        if (!s->enabled)
+          continue;
+        uint32_t toCycle = 0;
+        const uint32_t quiet = smQuietCycles(p, &simPioRegs[i], s, &toCycle);
+        if (quiet == UINT32_MAX)
+          continue;
+        // its first busy cycle must be the next step
+        const uint64_t busyAt = toCycle + (uint64_t)quiet * (uint32_t)s->config.clkdiv;
+        if (busyAt - 1 < skip)
+          skip = busyAt - 1;
+      }
+    }
+  }
+  else
+  {
+    skip = 0;
+  }
+
+  if (skip)
+  {
+    for (int i = 0; i < 2; ++i)
+    {
+      SimPio *p = &simPio[i];
+      for (int sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm)
+      {
+        SimSm *s = &p->sm[sm];
+        if (!s->enabled)
+          continue;
+        const uint32_t div = (uint32_t)s->config.clkdiv;
+        const uint32_t toCycle = (uint32_t)(s->config.clkdiv - s->divAcc);
+        const uint64_t cycles = (skip >= toCycle) ? (skip - toCycle) / div + 1 : 0;
+        smSkipCycles(p, s, (uint32_t)cycles);
+        s->divAcc = (float)((uint64_t)s->divAcc + skip - cycles * div);
+      }
+    }
+    ticks += skip;
+  }
+
+  simHwStep();
+  return skip + 1;
+}
+
+void simHwRun(uint64_t count)
+{
+  while (count--)
+    simHwStep();
+}
+
+/* sync */
+
+void __dmb(void)
+{
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void __sev(void)
+{
+}
+
+void __wfe(void)
+{
+  if (wfeHook)
+    wfeHook();
+  else if (irqDepth == 0)
+    simHwStep();
+  else
+    sched_yield();
+}
+
+void __wfi(void)
+{
+  __wfe();
+}
+
+uint32_t save_and_disable_interrupts(void)
+{
+  return 0;
+}
+
+void restore_interrupts(uint32_t status)
+{
+  (void)status;
+}
+
+/* irq */
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler)
+{
+  irqHandlers[num] = handler;
+}
+
+/* one handler per irq in the model: a shared one is the only one */
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t orderPriority)
+{
+  (void)orderPriority;
+  irqHandlers[num] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+  irqEnabled = enabled ? (irqEnabled | (1u << num)) : (irqEnabled & ~(1u << num));
+}
+
+void irq_set_priority(uint num, uint8_t priority)
+{
+  (void)num; (void)priority;
+}
+
+void irq_clear(uint num)
+{
+  (void)num;
+}
+
+/* clocks and time */
+
+uint32_t clock_get_hz(enum clock_index clock)
+{
+  return clock == clk_sys ? sysClockHz : 12000000;
+}
+
+bool set_sys_clock_pll(uint32_t vcoFreq, uint postDiv1, uint postDiv2)
+{
+  sysClockHz = vcoFreq / (postDiv1 * postDiv2);
+  return true;
+}
+
+bool set_sys_clock_khz(uint32_t freqKHz, bool required)
+{
+  (void)required;
+  sysClockHz = freqKHz * 1000;
+  return true;
+}
+
+uint64_t time_us_64(void)
+{
+  return ticks / (sysClockHz / 1000000) + extraUs;
+}
+
+uint32_t time_us_32(void)
+{
+  return (uint32_t)time_us_64();
+}
+
+/*
+ * the model runs on while the caller waits. an irq handler's wait passes
+ * the time without running it
+ */
+void busy_wait_us_32(uint32_t us)
+{
+  if (irqDepth)
+  {
+    extraUs += us;
+    return;
+  }
+  const uint64_t end = time_us_64() + us;
+  while (time_us_64() < end)
+    simHwStep();
+}
+
+/* dma */
+
+void dma_channel_claim(uint chan)
+{
+  if (dmaClaimed & (1u << chan))
+  {
+    // the sdk panics here
+    fprintf(stderr, "dma channel %u already claimed\n", chan);
+    abort();
+  }
+  dmaClaimed |= 1u << chan;
+}
+
+int dma_claim_unused_channel(bool required)
+{
+  for (uint chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+  {
+    if (!(dmaClaimed & (1u << chan)))
+    {
+      dma_channel_claim(chan);
+      return (int)chan;
+    }
+  }
+  return required ? (int)NUM_DMA_CHANNELS : -1;
+}
+
+void dma_channel_unclaim(uint chan)
+{
+  dmaClaimed &= ~(1u << chan);
+}
+
+bool dma_channel_is_claimed(uint chan)
+{
+  return (dmaClaimed & (1u << chan)) != 0;
+}
+
+void dma_start_channel_mask(uint32_t mask)
+{
+  for (uint chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+  {
+    if (mask & (1u << chan))
+      dmaTrigger(chan);
+  }
+}
+
+void dma_channel_start(uint chan)
+{
+  dma_start_channel_mask(1u << chan);
+}
+
+void dma_channel_set_config(uint chan, const dma_channel_config *config, bool trigger)
+{
+  dma_hw->ch[chan].al1_ctrl = (dma_hw->ch[chan].al1_ctrl & DMA_CH0_CTRL_TRIG_BUSY_BITS) | config->ctrl;
+  if (trigger) dma_channel_start(chan);
+}
+
+void dma_channel_set_read_addr(uint chan, const volatile void *readAddr, bool trigger)
+{
+  dma_hw->ch[chan].read_addr = (uintptr_t)readAddr;
+  if (trigger) dma_channel_start(chan);
+}
+
+void dma_channel_set_write_addr(uint chan, volatile void *writeAddr, bool trigger)
+{
+  dma_hw->ch[chan].write_addr = (uintptr_t)writeAddr;
+  if (trigger) dma_channel_start(chan);
+}
+
+void dma_channel_set_trans_count(uint chan, uint32_t count, bool trigger)
+{
+  dmaReload[chan] = count;
+  dma_hw->ch[chan].transfer_count = count;
+  if (trigger) dma_channel_start(chan);
+}
+
+void dma_channel_configure(uint chan, const dma_channel_config *config, volatile void *writeAddr,
+                           const volatile void *readAddr, uint count, bool trigger)
+{
+  dma_channel_set_read_addr(chan, readAddr, false);
+  dma_channel_set_write_addr(chan, writeAddr, false);
+  dma_channel_set_trans_count(chan, count, false);
+  dma_channel_set_config(chan, config, trigger);
+}
+
+void dma_channel_abort(uint chan)
+{
+  dma_hw->ch[chan].ctrl_trig &= ~DMA_CH0_CTRL_TRIG_BUSY_BITS;
+  if (dmaHook)
+    dmaHook(chan, SIM_DMA_ABORT, dma_hw->ch[chan].read_addr);
+}
+
+bool dma_channel_is_busy(uint chan)
+{
+  return (dma_hw->ch[chan].ctrl_trig & DMA_CH0_CTRL_TRIG_BUSY_BITS) != 0;
+}
+
+void dma_channel_wait_for_finish_blocking(uint chan)
+{
+  while (dma_channel_is_busy(chan))
+    tight_loop_contents();
+}
+
+void dma_channel_set_irq0_enabled(uint chan, bool enabled)
+{
+  syncInts();
+  dma_hw->inte0 = enabled ? (dma_hw->inte0 | (1u << chan)) : (dma_hw->inte0 & ~(1u << chan));
+  syncInts();
+}
+
+void dma_channel_set_irq1_enabled(uint chan, bool enabled)
+{
+  syncInts();
+  dma_hw->inte1 = enabled ? (dma_hw->inte1 | (1u << chan)) : (dma_hw->inte1 & ~(1u << chan));
+  syncInts();
+}
+
+void dma_channel_acknowledge_irq0(uint chan)
+{
+  syncInts();
+  simDma.intr &= ~(1u << chan);
+  syncInts();
+}
+
+void dma_channel_acknowledge_irq1(uint chan)
+{
+  dma_channel_acknowledge_irq0(chan);
+}
+
+/* pio */
+
+static int findProgramOffset(SimPio *p, const pio_program_t *program)
+{
+  const uint32_t mask = (1u << program->length) - 1;
+  if (program->origin >= 0)
+    return (p->used & (mask << program->origin)) ? -1 : program->origin;
+
+  // same as the sdk: the highest free offset
+  for (int offset = PIO_INSTRUCTION_COUNT - program->length; offset >= 0; --offset)
+  {
+    if (!(p->used & (mask << offset)))
+      return offset;
+  }
+  return -1;
+}
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program)
+{
+  return findProgramOffset(simPioOf(pio), program) >= 0;
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program)
+{
+  SimPio *p = simPioOf(pio);
+  const int offset = findProgramOffset(p, program);
+  if (offset < 0)
+    return PIO_INSTRUCTION_COUNT;
+
+  for (int i = 0; i < program->length; ++i)
+  {
+    // relocate jumps, as the sdk does
+    uint16_t instr = program->instructions[i];
+    if ((instr & 0xe000) == 0x0000)
+      instr += offset;
+    p->instr[offset + i] = instr;
+  }
+  p->used |= ((1u << program->length) - 1) << offset;
+  return (uint)offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, uint offset)
+{
+  simPioOf(pio)->used &= ~(((1u << program->length) - 1) << offset);
+}
+
+void pio_clear_instruction_memory(PIO pio)
+{
+  simPioOf(pio)->used = 0;
+}
+
+void pio_gpio_init(PIO pio, uint pin)
+{
+  (void)pio; (void)pin;
+}
+
+void pio_sm_set_config(PIO pio, uint sm, const pio_sm_config *config)
+{
+  simPioOf(pio)->sm[sm].config = *config;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initialPc, const pio_sm_config *config)
+{
+  pio_sm_set_enabled(pio, sm, false);
+  pio_sm_set_config(pio, sm, config);
+  pio_sm_clear_fifos(pio, sm);
+  pio_sm_restart(pio, sm);
+  pio_sm_clkdiv_restart(pio, sm);
+  pio_sm_exec(pio, sm, pio_encode_jmp(initialPc));
+}
+
+void pio_set_sm_mask_enabled(PIO pio, uint32_t mask, bool enabled)
+{
+  pio->ctrl = enabled ? (pio->ctrl | mask) : (pio->ctrl & ~mask);
+  for (uint sm = 0; sm < NUM_PIO_STATE_MACHINES; ++sm)
+  {
+    if (mask & (1u << sm))
+      simPioOf(pio)->sm[sm].enabled = enabled;
+  }
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled)
+{
+  pio_set_sm_mask_enabled(pio, 1u << sm, enabled);
+}
+
+/*
+ * the osr is left empty, so the first OUT autopulls
+ */
+void pio_sm_restart(PIO pio, uint sm)
+{
+  SimSm *s = &simPioOf(pio)->sm[sm];
+  s->osrCount = 32;
+  s->isrCount = 0;
+  s->delay = 0;
+  s->execPending = false;
+}
+
+void pio_sm_clkdiv_restart(PIO pio, uint sm)
+{
+  simPioOf(pio)->sm[sm].divAcc = 0.0f;
+}
+
+void pio_sm_exec(PIO pio, uint sm, uint instr)
+{
+  SimPio *p = simPioOf(pio);
+  execute(p, pio, &p->sm[sm], (uint16_t)instr);
+}
+
+void pio_sm_clear_fifos(PIO pio, uint sm)
+{
+  SimSm *s = &simPioOf(pio)->sm[sm];
+  s->fifoHead = s->fifoCount = 0;
+}
+
+void pio_sm_drain_tx_fifo(PIO pio, uint sm)
+{
+  SimSm *s = &simPioOf(pio)->sm[sm];
+  while (s->fifoCount)
+    pull(s);
+}
+
+void pio_sm_put(PIO pio, uint sm, uint32_t data)
+{
+  fifoPush(&simPioOf(pio)->sm[sm], data);
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data)
+{
+  SimSm *s = &simPioOf(pio)->sm[sm];
+  while (s->fifoCount >= fifoDepth(s))
+    simHwStep();
+  fifoPush(s, data);
+}
+
+uint32_t pio_sm_get(PIO pio, uint sm)
+{
+  (void)pio; (void)sm;
+  return 0;
+}
+
+uint32_t pio_sm_get_blocking(PIO pio, uint sm)
+{
+  return pio_sm_get(pio, sm);
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm)
+{
+  const SimSm *s = &simPioOf(pio)->sm[sm];
+  return s->fifoCount >= fifoDepth(s);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm)
+{
+  (void)pio; (void)sm;
+  return true;
+}
+
+void pio_sm_set_clkdiv(PIO pio, uint sm, float div)
+{
+  simPioOf(pio)->sm[sm].config.clkdiv = div;
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint base, uint count, bool isOut)
+{
+  (void)sm;
+  const uint32_t mask = ((1u << count) - 1) << base;
+  SimPio *p = simPioOf(pio);
+  p->pindirs = isOut ? (p->pindirs | mask) : (p->pindirs & ~mask);
+}
+
+void pio_sm_set_pindirs_with_mask(PIO pio, uint sm, uint32_t dirs, uint32_t mask)
+{
+  (void)sm;
+  SimPio *p = simPioOf(pio);
+  p->pindirs = (p->pindirs & ~mask) | (dirs & mask);
+}
+
+void pio_sm_set_pins_with_mask(PIO pio, uint sm, uint32_t values, uint32_t mask)
+{
+  (void)pio; (void)sm; (void)values; (void)mask;
+}
+
+void pio_interrupt_clear(PIO pio, uint irq)
+{
+  pio->irq &= ~(1u << irq);
+}
+
+void pio_set_irq0_source_enabled(PIO pio, uint source, bool enabled)
+{
+  (void)pio; (void)source; (void)enabled;
+}
+
+void pio_set_irq1_source_enabled(PIO pio, uint source, bool enabled)
+{
+  (void)pio; (void)source; (void)enabled;
+}
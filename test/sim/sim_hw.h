@@ -0,0 +1,78 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+#pragma once
+
+/*
+ * host model behind the sdk stand-ins in include/. a test builds the
+ * firmware source it checks against this, then drives and inspects the
+ * model through here
+ */
+
+#include "pico.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+
+typedef struct
+{
+  uint64_t outStalls;     // cycles an OUT waited on an empty tx fifo
+  uint64_t txPulls;       // words the state machine pulled from it
+} SimSmStats;
+
+typedef enum { SIM_DMA_TRIGGER, SIM_DMA_ABORT } SimDmaEvent;
+
+typedef void (*SimDmaHook)(uint chan, SimDmaEvent event, uintptr_t readAddr);
+typedef void (*SimPinHook)(int pio, uint64_t tick, uint32_t pins);
+typedef void (*SimIrqHook)(uint irq, bool enter);
+
+/* reset all of the modelled hardware (registers, claims, programs, irqs) */
+void simHwReset(void);
+
+/* advance the model one system clock / count system clocks */
+void simHwStep(void);
+void simHwRun(uint64_t count);
+
+/*
+ * advance to the next system clock anything can change on, at most
+ * maxTicks, skipping the clocks where the state machines only count down
+ * and the dma is idle. returns the clocks advanced
+ */
+uint64_t simHwAdvance(uint64_t maxTicks);
+
+/* system clocks run since the reset */
+uint64_t simTicks(void);
+
+/* system clock, as set by set_sys_clock_pll() */
+uint32_t simSysClockHz(void);
+
+/* a state machine's statistics */
+const SimSmStats *simSmStats(PIO pio, uint sm);
+
+/* words waiting in a state machine's tx fifo */
+uint32_t simSmTxLevel(PIO pio, uint sm);
+
+/* the pins a pio drives (output values masked by pin directions) */
+uint32_t simPioPins(PIO pio);
+
+/* called as a dma channel starts (with its read address) or is aborted */
+void simSetDmaHook(SimDmaHook hook);
+
+/* called when the pins a pio drives change */
+void simSetPinHook(SimPinHook hook);
+
+/* called on entry to and exit from each irq handler call */
+void simSetIrqHook(SimIrqHook hook);
+
+/* called by __wfe() (and tight_loop_contents()). NULL steps the model */
+void simSetWfeHook(void (*hook)(void));
+
+/* handler registered for an irq, or NULL */
+irq_handler_t simIrqHandler(uint num);
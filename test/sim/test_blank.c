@@ -0,0 +1,178 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * the blanked display (R1 bit 6 clear) through main.c's scanline path, on
+ * the hardware model
+ *
+ * the vdp reports a fifth sprite (5S) on one line and a collision (COL) on
+ * another, and an F18A line interrupt is set on a third. with the display
+ * enabled a frame has a line interrupt (5S and COL with it) and a frame
+ * interrupt. blanked, the vdp renders nothing, so it reports no 5S or COL,
+ * but both interrupts still come once a frame, the scanline register still
+ * counts each line, and every display line scans out the shared border
+ * line. the display is shifted a line down (every mode's border is even)
+ * so a line's vga and tms numbers differ in parity: a redirect by the tms
+ * line would pick the wrong line's buffer
+ */
+
+#include "check.h"
+
+#include "vga.c"
+
+#define main pico9918Main
+#include "main.c"
+#undef main
+
+#include "scan.h"
+
+#define FRAMES          8
+#define LINE_INT        100     // F18A line interrupt (R19)
+#define LINE_5S         50
+#define LINE_COL        60
+
+// this frame
+static uint32_t lineInts;
+static uint32_t frameInts;
+static uint8_t lineStatus;      // the status read on the line interrupt
+static uint32_t badScanline;    // lines the scanline register was wrong after
+static uint32_t sourceLines;    // display lines scanned out while blanked
+static uint32_t badSource;      // of them, not from the border line
+
+static bool blanked(void)
+{
+  return !(TMS_REGISTER(tms9918, 1) & R1_DISP_ACTIVE);
+}
+
+static bool displayLine(int32_t y)
+{
+  return y >= (int32_t)vBorder && y < (int32_t)(vBorder + vPixels);
+}
+
+static bool isBorderLine(uintptr_t addr)
+{
+  for (int set = 0; set < 2; ++set)
+    if (addr == (uintptr_t)vgaBorderLine[set][0])
+      return true;
+  return false;
+}
+
+static void shiftedEndOfFrame(uint32_t frameNumber)
+{
+  tmsEndOfFrame(frameNumber);
+  ++vBorder;
+  vgaSetTriggerScanline(vBorder + vPixels);
+}
+
+static void checkedScanline(uint16_t y, VgaParams *params, uint16_t *pixels)
+{
+  tmsScanline(y, params, pixels);
+
+  y &= 0x0fff;
+  if (displayLine(y) && TMS_STATUS(tms9918, 0x03) != y - vBorder)
+    ++badScanline;
+}
+
+/* the rgb dma starting a line: where a blanked display line reads from */
+static void onDma(uint chan, SimDmaEvent event, uintptr_t readAddr)
+{
+  if (chan != RGB_DMA_CHAN || event != SIM_DMA_TRIGGER || !blanked() || !displayLine(outputLine))
+    return;
+
+  ++sourceLines;
+  if (!isBorderLine(readAddr) || *(const uint32_t *)readAddr != bg)
+    ++badSource;
+}
+
+static void readStatus(void)
+{
+  const bool lineInt = TMS_STATUS(tms9918, 0x01) & 0x01;
+  const uint32_t scanline = tms9918->vram.map.scanline;
+  const uint8_t status = scanReadStatus();
+
+  if (lineInt)
+  {
+    CHECK_EQ(scanline, LINE_INT, "line interrupt on the wrong line");
+    lineStatus = status;
+    ++lineInts;
+  }
+  else
+  {
+    CHECK((int)scanline >= vPixels, "frame interrupt on display line %u", scanline);
+    CHECK(status & STATUS_INT, "frame interrupt without the status flag");
+    ++frameInts;
+  }
+}
+
+static void runFrame(void)
+{
+  lineInts = frameInts = badScanline = sourceLines = badSource = 0;
+  lineStatus = 0;
+
+  const uint32_t end = scanFrameNumber + 1;
+  while (scanFrameNumber != end)
+  {
+    scanStep(UINT64_MAX);
+    if (scanStats.intActive)
+      readStatus();
+  }
+}
+
+int main(void)
+{
+  scanBoot(0, 0);
+  scanAckInts = false;
+
+  vgaParams.scanlineFn = checkedScanline;
+  vgaParams.endOfFrameFn = shiftedEndOfFrame;
+  simSetDmaHook(onDma);
+
+  TMS_REGISTER(tms9918, 0) |= 0x10;   // line interrupt enabled
+  TMS_REGISTER(tms9918, 0x13) = LINE_INT;
+  scanLineStatus[LINE_5S] = STATUS_5S | 5;
+  scanLineStatus[LINE_COL] = STATUS_COL;
+
+  runFrame();                         // into the shifted geometry
+  CHECK(vBorder & 1, "border %u: not odd", vBorder);
+
+  for (int phase = 0; phase < 3; ++phase)
+  {
+    const bool blank = phase == 1;
+    TMS_REGISTER(tms9918, 1) = blank ? 0x20 : 0x60;
+    const uint32_t scanLines = scanStats.scanLines;
+
+    for (int f = 0; f < FRAMES; ++f)
+    {
+      runFrame();
+      const char *name = blank ? "blanked" : "displayed";
+
+      CHECK_EQ(lineInts, 1, "%s frame %d: line interrupts", name, f);
+      CHECK_EQ(frameInts, 1, "%s frame %d: frame interrupts", name, f);
+      CHECK_EQ(badScanline, 0, "%s frame %d: lines with the wrong scanline register", name, f);
+
+      const uint8_t expect = blank ? STATUS_INT : (STATUS_INT | STATUS_5S | STATUS_COL | 5);
+      CHECK_EQ(lineStatus, expect, "%s frame %d: status at the line interrupt", name, f);
+
+      if (blank)
+      {
+        CHECK_EQ(sourceLines, vPixels * vgaParams.params.vPixelScale, "%s frame %d: display lines scanned out", name, f);
+        CHECK_EQ(badSource, 0, "%s frame %d: display lines not from the border line", name, f);
+      }
+    }
+
+    if (blank)
+      CHECK_EQ(scanStats.scanLines - scanLines, 0, "blanked lines rendered");
+    else
+      CHECK_EQ(scanStats.scanLines - scanLines, FRAMES * vPixels, "displayed lines rendered");
+  }
+
+  return checkResult("blank");
+}
@@ -0,0 +1,244 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * boot order of main.c, on the stubs in boot_hw.c
+ *
+ * a host can read the vdp soon after reset, so the tms bus pios must be up
+ * quickly. for each flash config (saved settings, a pending display change
+ * to try, an armed one to revert, a scart dongle) the boot must set the
+ * system clock exactly once, to the configured mode's clock, before the
+ * bus comes up. nothing may write flash before the bus is up, and the bus
+ * must be up before the vga output starts, within BOOT_BUS_BOUND_US
+ *
+ * each config boots in a fresh process: main.c's statics start cold
+ */
+
+#include "check.h"
+#include "boot_hw.h"
+
+#include "config.h"
+#include "diag.h"
+#include "display.h"
+#include "vga.h"
+
+#include "hardware/flash.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// a second clock change or a sector erase before the bus breaks this
+#define BOOT_BUS_BOUND_US     5000
+
+// the flash layout config.c keeps
+#define CONFIG_FLASH_OFFSET   (BOOT_FLASH_BYTES - 0x1000)
+#define PENDING_FLASH_OFFSET  (CONFIG_FLASH_OFFSET - 0x1000)
+
+int pico9918Main(void);
+extern const uint tmsWriteSm, tmsReadSm;
+
+typedef struct
+{
+  uint8_t driverPref, vgaMode, scartMode, preset;
+} Settings;
+
+typedef struct
+{
+  const char *name;
+  bool dongle;
+  bool saved;             // settings saved to flash (otherwise erased)
+  Settings settings;
+  uint8_t pendingState;   // a pending block (PENDING_STATE_*), or 0
+  Settings pending;
+} BootCase;
+
+static const BootCase cases[] = {
+  { "erased flash",             false, false, { 0, 0, 0, 0 }, 0, { 0 } },
+  { "saved 1024x768",           false, true,  { 1, 2, 0, 0 }, 0, { 0 } },
+  { "saved 720x576 preset 2",   false, true,  { 0, 4, 0, 2 }, 0, { 0 } },
+  { "pending 1280x1024",        false, true,  { 0, 0, 0, 0 }, PENDING_STATE_PENDING, { 0, 3, 0, 1 } },
+  { "armed 640x400 reverts",    false, true,  { 0, 0, 0, 1 }, PENDING_STATE_ARMED,   { 0, 1, 0, 0 } },
+  { "dongle auto 576i",         true,  true,  { 0, 0, 0, 0 }, 0, { 0 } },
+  { "dongle pending 240p",      true,  true,  { 0, 2, 0, 0 }, PENDING_STATE_PENDING, { 2, 2, 3, 1 } },
+  { "dongle forced vga 400p",   true,  true,  { 1, 1, 2, 0 }, 0, { 0 } },
+};
+
+#define CASE_COUNT (sizeof(cases) / sizeof(cases[0]))
+
+/*
+ * the settings the boot should run: a pending change is tried, an armed
+ * one has had its boot and reverts to the saved settings
+ */
+static DisplayPlan expectedPlan(const BootCase *c)
+{
+  static const uint8_t scartDrivers[] = { 2, 1, 4, 3 };
+
+  const Settings *s = (c->pendingState == PENDING_STATE_PENDING) ? &c->pending : &c->settings;
+  const bool scart = s->driverPref == 2 || (s->driverPref == 0 && c->dongle);
+  return displayPlan(scart ? scartDrivers[s->scartMode] : 0, s->vgaMode, s->scartMode, s->preset);
+}
+
+/*
+ * a board with the case's flash contents
+ */
+static void prepareFlash(const BootCase *c)
+{
+  bootHwReset(c->dongle);
+
+  if (c->saved)
+  {
+    // a valid config block: the defaults with the case's settings
+    uint8_t config[CONFIG_BYTES];
+    readConfig(config);
+    config[CONF_DISP_DRIVER_PREF] = c->settings.driverPref;
+    config[CONF_VGA_MODE] = c->settings.vgaMode;
+    config[CONF_SCART_MODE] = c->settings.scartMode;
+    config[CONF_CLOCK_PRESET_ID] = c->settings.preset;
+    memcpy(simFlash + CONFIG_FLASH_OFFSET, config, CONFIG_BYTES);
+  }
+
+  if (c->pendingState)
+  {
+    const PendingDisplay p = {
+      .state = c->pendingState,
+      .dispDriverPref = c->pending.driverPref,
+      .vgaMode = c->pending.vgaMode,
+      .scartMode = c->pending.scartMode,
+      .clockPresetId = c->pending.preset,
+    };
+    memcpy(simFlash + PENDING_FLASH_OFFSET, &p, sizeof(p));
+  }
+}
+
+static void checkBoot(const BootCase *c)
+{
+  prepareFlash(c);
+
+  if (!setjmp(bootExit))
+    pico9918Main();
+
+  uint32_t count;
+  const BootEvent *e = bootEvents(&count);
+
+  // where each thing happened in the record
+  int clocks = 0, clockAt = -1, busAt = -1, vgaAt = -1, gpuAt = -1, firstFlashAt = -1;
+  int phaseAt[DIAG_BOOT_PHASES];
+  int erases = 0, programs = 0;
+  uint32_t armedState = 0;
+  uint32_t tmsSms = 0;
+  const uint32_t busSms = (1u << tmsWriteSm) | (1u << tmsReadSm);
+  for (int p = 0; p < DIAG_BOOT_PHASES; ++p)
+    phaseAt[p] = -1;
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    switch (e[i].type)
+    {
+      case BOOT_EVENT_CLOCK:
+        if (clocks++ == 0) clockAt = i;
+        break;
+
+      case BOOT_EVENT_SM_ENABLE:
+        if (e[i].a == 1 && (busSms & (1u << e[i].b)))
+        {
+          tmsSms = e[i].c ? (tmsSms | (1u << e[i].b)) : (tmsSms & ~(1u << e[i].b));
+          if (tmsSms == busSms && busAt < 0) busAt = i;
+        }
+        break;
+
+      case BOOT_EVENT_FLASH_ERASE:
+      case BOOT_EVENT_FLASH_PROGRAM:
+        if (firstFlashAt < 0) firstFlashAt = i;
+        CHECK_EQ(e[i].a, PENDING_FLASH_OFFSET, "%s: flash written outside the pending block", c->name);
+        if (e[i].type == BOOT_EVENT_FLASH_ERASE)
+          ++erases;
+        else if (programs++ == 0)
+          armedState = e[i].c;
+        break;
+
+      case BOOT_EVENT_PHASE:
+        if (e[i].a < DIAG_BOOT_PHASES) phaseAt[e[i].a] = i;
+        break;
+
+      case BOOT_EVENT_VGA_INIT: vgaAt = i; break;
+      case BOOT_EVENT_GPU_LOOP: gpuAt = i; break;
+      default: break;
+    }
+  }
+
+  CHECK(gpuAt >= 0, "%s: never reached the gpu loop", c->name);
+  CHECK(busAt >= 0, "%s: tms bus never came up", c->name);
+  if (gpuAt < 0 || busAt < 0) return;
+
+  // one clock change, the configured mode's, before the bus
+  const DisplayPlan plan = expectedPlan(c);
+  CHECK_EQ(clocks, 1, "%s: system clock changes", c->name);
+  if (clockAt >= 0)
+  {
+    CHECK(clockAt < busAt, "%s: system clock set after the bus came up", c->name);
+    CHECK_EQ(e[clockAt].a, plan.clock.vcoKHz * 1000, "%s: vco", c->name);
+    CHECK_EQ(e[clockAt].b, plan.clock.postDiv1, "%s: postdiv1", c->name);
+    CHECK_EQ(e[clockAt].c, plan.clock.postDiv2, "%s: postdiv2", c->name);
+  }
+
+  // the bus comes up quickly, ahead of any flash write and the vga output
+  CHECK(e[busAt].us <= BOOT_BUS_BOUND_US, "%s: tms bus up at %llu us", c->name, (unsigned long long)e[busAt].us);
+  CHECK(firstFlashAt < 0 || firstFlashAt > busAt, "%s: flash written before the bus came up", c->name);
+  CHECK(vgaAt > busAt, "%s: vga started before the bus came up", c->name);
+
+  // the pending block still moves on: PENDING -> ARMED is rewritten, ARMED erased
+  if (c->pendingState == PENDING_STATE_PENDING)
+  {
+    CHECK(erases >= 1 && programs >= 1, "%s: pending block not armed (%d erases, %d programs)", c->name, erases, programs);
+    CHECK_EQ(armedState, PENDING_STATE_ARMED, "%s: pending block state programmed", c->name);
+  }
+  else if (c->pendingState == PENDING_STATE_ARMED)
+  {
+    CHECK(erases == 1 && programs == 0, "%s: armed block not erased (%d erases, %d programs)", c->name, erases, programs);
+  }
+  else
+  {
+    CHECK(firstFlashAt < 0, "%s: flash written", c->name);
+  }
+
+  // the phases the diagnostics show, in boot order
+  CHECK(phaseAt[DIAG_BOOT_CONFIG] >= 0 && phaseAt[DIAG_BOOT_CONFIG] < clockAt, "%s: config phase", c->name);
+  CHECK(phaseAt[DIAG_BOOT_CLOCK] > clockAt && phaseAt[DIAG_BOOT_CLOCK] < busAt, "%s: clock phase", c->name);
+  CHECK(phaseAt[DIAG_BOOT_BUS] > busAt && phaseAt[DIAG_BOOT_BUS] < vgaAt, "%s: bus phase", c->name);
+  CHECK(phaseAt[DIAG_BOOT_VGA] > vgaAt, "%s: vga phase", c->name);
+}
+
+int main(void)
+{
+  for (size_t i = 0; i < CASE_COUNT; ++i)
+  {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+      checkFailures = 0;
+      char name[64];
+      snprintf(name, sizeof(name), "boot %s", cases[i].name);
+      checkBoot(&cases[i]);
+      const int result = checkResult(name);
+      fflush(stdout);
+      _exit(result);
+    }
+
+    int status = 0;
+    CHECK(pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0,
+          "%s: boot failed", cases[i].name);
+  }
+
+  return checkResult("boot");
+}
@@ -0,0 +1,171 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * the shared border line (vgaSetBorderColor, vgaUseBorderLine) through
+ * main.c's scanline path, on the hardware model
+ *
+ * the backdrop colour (R7) is changed mid-frame: in the bottom border, on a
+ * display line, and on two lines in a row in the top border. each full
+ * border line must scan out from the shared border line (never a line
+ * buffer, whatever that last held), in the colour set when the line was
+ * generated (a frame's first row: its last line's). the set a line scans out from must still hold that colour when
+ * the line ends: a change fills the other set and switches to it for the
+ * next line, never under the line being scanned out. the sets switch once
+ * per colour change and not otherwise
+ */
+
+#include "check.h"
+
+#include "vga.c"
+
+#define main pico9918Main
+#include "main.c"
+#undef main
+
+#include "scan.h"
+
+#define MAX_LINES     1024
+
+typedef struct
+{
+  int frame;
+  int line;                     // relative to the border (negative: from the end of the frame)
+  uint8_t colour;
+} ColourChange;
+
+static const ColourChange changes[] = {
+  { 2, -8, 0x06 },              // bottom border
+  { 4, 100, 0x09 },             // display line, so the bottom border after it
+  { 6, 10, 0x02 },              // top border, two lines in a row
+  { 6, 11, 0x03 },
+};
+
+#define CHANGES (sizeof(changes) / sizeof(changes[0]))
+
+static int frame;
+static uint32_t expected[MAX_LINES];    // the border colour each line was generated with
+static uint32_t switches;
+
+// this frame
+static uint32_t borderLines;            // border line starts seen
+static uint32_t badSource;              // of them, not from a border line
+static uint32_t badColour;              // in the wrong colour
+static uint32_t overwritten;            // lines whose border line changed under them
+static const uint32_t *scanning;        // the border line being scanned out, and its colour
+static uint32_t scanningColour;
+
+static bool borderLine(int32_t y)
+{
+  return y < (int32_t)vBorder || y >= (int32_t)(vBorder + vPixels);
+}
+
+static bool isBorderLine(uintptr_t addr)
+{
+  for (int set = 0; set < 2; ++set)
+    if (addr == (uintptr_t)vgaBorderLine[set][0])
+      return true;
+  return false;
+}
+
+/* is the whole line (hVirtualPixels) in one colour? */
+static bool lineIs(const uint32_t *line, uint32_t colour)
+{
+  for (int i = 0; i < vgaParams.params.hVirtualPixels / 2; ++i)
+    if (line[i] != colour)
+      return false;
+  return true;
+}
+
+static void changingScanline(uint16_t y, VgaParams *params, uint16_t *pixels)
+{
+  const int32_t line = y & 0x0fff;
+  for (uint32_t i = 0; i < CHANGES; ++i)
+  {
+    const int32_t at = changes[i].line < 0 ? (int32_t)params->vVirtualPixels + changes[i].line : changes[i].line;
+    if (changes[i].frame == frame && at == line)
+      TMS_REGISTER(tms9918, 7) = changes[i].colour;
+  }
+
+  const uint32_t set = borderSet;
+  tmsScanline(y, params, pixels);
+  switches += borderSet != set;
+
+  if (line < MAX_LINES)
+    expected[line] = bg;
+}
+
+/* the rgb dma starting a line: the line before it is done */
+static void onDma(uint chan, SimDmaEvent event, uintptr_t readAddr)
+{
+  if (chan != RGB_DMA_CHAN || event != SIM_DMA_TRIGGER)
+    return;
+
+  if (scanning && !lineIs(scanning, scanningColour))
+    ++overwritten;
+  scanning = NULL;
+
+  // the line started past the end of the frame is the next frame's first
+  // row. it's started before that frame's lines are generated, so it reads
+  // what the last line in its slot left there. line 0's other rows follow
+  // the frame start, where outputLine is reset (-1)
+  int32_t line = outputLine;
+  if (line >= vgaParams.params.vVirtualPixels)
+    line -= 2;
+  else if (line < 0)
+    line = 0;
+
+  if (!borderLine(line))
+    return;
+
+  ++borderLines;
+  if (!isBorderLine(readAddr))
+  {
+    ++badSource;
+    return;
+  }
+
+  scanning = (const uint32_t *)readAddr;
+  scanningColour = expected[line];
+  if (!lineIs(scanning, scanningColour))
+    ++badColour;
+}
+
+int main(void)
+{
+  scanBoot(0, 0);
+
+  vgaParams.scanlineFn = changingScanline;
+  vgaParams.scanlines = false;        // no dimmed repeats: each line reads the border line itself
+  simSetDmaHook(onDma);
+
+  // a frame to record the colour each line is generated with (no changes)
+  frame = -1;
+  scanRunFrames(1);
+
+  const uint32_t perFrame = 2 * vBorder * vgaParams.params.vPixelScale;
+
+  for (frame = 0; frame < 8; ++frame)
+  {
+    borderLines = badSource = badColour = overwritten = 0;
+    scanRunFrames(1);
+
+    CHECK_EQ(borderLines, perFrame, "frame %d: border lines scanned out", frame);
+    CHECK_EQ(badSource, 0, "frame %d: border lines not from the border line", frame);
+    CHECK_EQ(badColour, 0, "frame %d: border lines in the wrong colour", frame);
+    CHECK_EQ(overwritten, 0, "frame %d: border lines changed as they were scanned out", frame);
+  }
+
+  CHECK_EQ(switches, CHANGES, "border line set switches");
+  CHECK_EQ(bg, pram[0x03], "final border colour");
+
+  return checkResult("border");
+}
@@ -0,0 +1,164 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * scanline conversion kernels (convert_m0.c, convert_m33.c) against a
+ * scalar reference
+ *
+ * both kernels are built natively here (the M33 pack instructions have a
+ * plain C fallback off-target), so this checks their results only. their
+ * cycle counts need the real cores or a cycle-accurate emulator.
+ */
+
+#include "check.h"
+
+#include <string.h>
+
+#define KERNEL_DECLS(suffix) \
+  void convertScanline##suffix(const uint8_t *src, uint32_t *dst, const uint32_t *pal, int count); \
+  void convertScanlineDim##suffix(const uint8_t *src, uint32_t *dst, uint32_t *dstDim, const uint32_t *pal, int count); \
+  void expandPalette##suffix(const uint16_t *f18aPal, uint32_t *pal, int count); \
+  void expandPalettePairs##suffix(const uint16_t *f18aPal, uint32_t *pal);
+
+KERNEL_DECLS(M0)
+KERNEL_DECLS(M33)
+
+typedef struct
+{
+  const char *name;
+  void (*convertScanline)(const uint8_t *, uint32_t *, const uint32_t *, int);
+  void (*convertScanlineDim)(const uint8_t *, uint32_t *, uint32_t *, const uint32_t *, int);
+  uint32_t dimMask;   // bits kept by the CRT dimming (the RP2040 masks its msbs with pin directions)
+  void (*expandPalette)(const uint16_t *, uint32_t *, int);
+  void (*expandPalettePairs)(const uint16_t *, uint32_t *);
+} Kernels;
+
+static const Kernels kernels[] = {
+  { "m0",  convertScanlineM0,  convertScanlineDimM0,  0xffffffff, expandPaletteM0,  expandPalettePairsM0 },
+  { "m33", convertScanlineM33, convertScanlineDimM33, 0x07770777, expandPaletteM33, expandPalettePairsM33 },
+};
+
+/* F18A 0x0RGB (big-endian, so read as 0xGB0R) to 0x0BGR. the top nibble
+   keeps G as the firmware always has - it isn't wired to an output pin */
+static uint32_t refBgr(uint16_t v)
+{
+  const uint32_t r = v & 0x0f;
+  const uint32_t b = (v >> 8) & 0x0f;
+  const uint32_t g = (v >> 12) & 0x0f;
+  return (g << 12) | (b << 8) | (g << 4) | r;
+}
+
+static void testConvertScanline(const Kernels *k, uint32_t *seed)
+{
+  uint32_t pal[256];
+  for (int i = 0; i < 256; ++i) pal[i] = checkRand(seed);
+
+  for (int count = 8; count <= 256; count += 8)
+  {
+    uint32_t srcWords[256 / 4];
+    uint8_t *src = (uint8_t *)srcWords;
+    for (int i = 0; i < count; ++i) src[i] = checkRand(seed) & 0xff;
+
+    uint32_t dst[256 + 1];
+    memset(dst, 0xa5, sizeof(dst));
+    k->convertScanline(src, dst, pal, count);
+
+    for (int i = 0; i < count; ++i)
+      CHECK_EQ(dst[i], pal[src[i]], "%s convertScanline count %d pixel %d", k->name, count, i);
+    CHECK_EQ(dst[count], 0xa5a5a5a5, "%s convertScanline count %d wrote past the end", k->name, count);
+  }
+}
+
+static void testConvertScanlineDim(const Kernels *k, uint32_t *seed)
+{
+  uint32_t pal[256];
+  for (int i = 0; i < 256; ++i) pal[i] = checkRand(seed);
+
+  for (int count = 8; count <= 256; count += 8)
+  {
+    uint32_t srcWords[256 / 4];
+    uint8_t *src = (uint8_t *)srcWords;
+    for (int i = 0; i < count; ++i) src[i] = checkRand(seed) & 0xff;
+
+    uint32_t dst[256 + 1], dstDim[256 + 1];
+    memset(dst, 0xa5, sizeof(dst));
+    memset(dstDim, 0xa5, sizeof(dstDim));
+    k->convertScanlineDim(src, dst, dstDim, pal, count);
+
+    for (int i = 0; i < count; ++i)
+    {
+      CHECK_EQ(dst[i], pal[src[i]], "%s convertScanlineDim count %d pixel %d", k->name, count, i);
+      CHECK_EQ(dstDim[i], (pal[src[i]] >> 1) & k->dimMask, "%s convertScanlineDim count %d dimmed pixel %d", k->name, count, i);
+    }
+    CHECK_EQ(dst[count], 0xa5a5a5a5, "%s convertScanlineDim count %d wrote past the end", k->name, count);
+    CHECK_EQ(dstDim[count], 0xa5a5a5a5, "%s convertScanlineDim count %d wrote past the dimmed end", k->name, count);
+  }
+}
+
+static void testExpandPalette(const Kernels *k, uint32_t *seed)
+{
+  for (int count = 8; count <= 64; count += 8)
+  {
+    for (int offset = 0; offset < 2; ++offset)
+    {
+      uint16_t f18a[64 + 1];
+      for (int i = 0; i <= 64; ++i) f18a[i] = checkRand(seed) & 0xffff;
+
+      uint32_t pal[64 + 1];
+      memset(pal, 0xa5, sizeof(pal));
+      k->expandPalette(f18a + offset, pal, count);
+
+      for (int i = 0; i < count; ++i)
+      {
+        const uint32_t bgr = refBgr(f18a[offset + i]);
+        CHECK_EQ(pal[i], bgr | (bgr << 16), "%s expandPalette count %d offset %d entry %d", k->name, count, offset, i);
+      }
+      CHECK_EQ(pal[count], 0xa5a5a5a5, "%s expandPalette count %d wrote past the end", k->name, count);
+    }
+  }
+}
+
+static void testExpandPalettePairs(const Kernels *k, uint32_t *seed)
+{
+  uint16_t f18a[16];
+  for (int i = 0; i < 16; ++i) f18a[i] = checkRand(seed) & 0xffff;
+
+  uint32_t pal[256];
+  k->expandPalettePairs(f18a, pal);
+
+  for (int i = 0; i < 16; ++i)
+  {
+    const uint32_t bgr = refBgr(f18a[i]);
+    CHECK_EQ(pal[i], bgr | (bgr << 16), "%s expandPalettePairs entry %d", k->name, i);
+  }
+  for (int j = 16; j < 256; ++j)
+  {
+    // left pixel from the high nibble, right pixel from the low nibble
+    const uint32_t expected = (refBgr(f18a[j & 0x0f]) << 16) | refBgr(f18a[j >> 4]);
+    CHECK_EQ(pal[j], expected, "%s expandPalettePairs entry %02x", k->name, j);
+  }
+}
+
+int main()
+{
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+  {
+    for (uint32_t run = 0; run < 16; ++run)
+    {
+      uint32_t seed = 0x9918 + run;
+      testConvertScanline(&kernels[i], &seed);
+      testConvertScanlineDim(&kernels[i], &seed);
+      testExpandPalette(&kernels[i], &seed);
+      testExpandPalettePairs(&kernels[i], &seed);
+    }
+  }
+  return checkResult("convert");
+}
@@ -0,0 +1,177 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * scanline deadline degradation (vga.c) with main.c's scanline callbacks,
+ * on the hardware model
+ *
+ * a few display lines take longer than the dma gives them (the scanline
+ * callback runs the model on for a few line periods). each frame that
+ * misses a line counts it in missedLines and steps the level down one,
+ * to repeated lines. degraded, odd lines scan out the even line above
+ * (the same source, not rendered), and tmsRepeatScanline() still moves
+ * the vdp on a line: the scanline register counts them, and an F18A line
+ * interrupt set on one comes once a frame. VGA_DEGRADE_RECOVER_FRAMES clean
+ * frames step the level back up, not one sooner
+ */
+
+#include "check.h"
+
+#include "vga.c"
+
+#define main pico9918Main
+#include "main.c"
+#undef main
+
+#include "scan.h"
+
+#define MAX_LINES     1024
+#define SLOW_LINE     50          // display line (tms) the slow frames are slow on
+#define SLOW_LINES    3           // line periods it takes
+#define LINE_INT      101         // F18A line interrupt (R19): an odd vga line (vBorder is even)
+
+static bool slow;                 // the frame's SLOW_LINE is slow
+static uint64_t lineTicks;        // a virtual line's scan out, in system clocks
+
+// this frame
+static uintptr_t lineSource[MAX_LINES];   // where each line's first row was read from
+static int32_t lastLine;
+static uint32_t repeats;          // tmsRepeatScanline() calls
+static uint32_t badRepeatState;   // of them, leaving the vdp on the wrong line
+static uint32_t lineInts;
+
+static void slowScanline(uint16_t y, VgaParams *params, uint16_t *pixels)
+{
+  tmsScanline(y, params, pixels);
+  if (slow && (y & 0x0fff) == vBorder + SLOW_LINE)
+    simHwRun(lineTicks * SLOW_LINES);
+}
+
+static void checkedRepeatScanline(uint16_t y, VgaParams *params)
+{
+  tmsRepeatScanline(y, params);
+  ++repeats;
+
+  y &= 0x0fff;
+  if (y >= vBorder && y < vBorder + vPixels &&
+      (TMS_STATUS(tms9918, 0x03) != y - vBorder || !tms9918->vram.map.blanking))
+    ++badRepeatState;
+}
+
+/* the rgb dma starting a line */
+static void onDma(uint chan, SimDmaEvent event, uintptr_t readAddr)
+{
+  if (chan != RGB_DMA_CHAN || event != SIM_DMA_TRIGGER)
+    return;
+
+  if (outputLine >= 0 && outputLine < MAX_LINES && outputLine != lastLine)
+    lineSource[outputLine] = readAddr;
+  lastLine = outputLine;
+}
+
+static void runFrame(void)
+{
+  memset(lineSource, 0, sizeof(lineSource));
+  repeats = badRepeatState = lineInts = 0;
+
+  const uint32_t end = scanFrameNumber + 1;
+  while (scanFrameNumber != end)
+  {
+    scanStep(UINT64_MAX);
+    if (scanStats.intActive)
+    {
+      lineInts += (TMS_STATUS(tms9918, 0x01) & 0x01) != 0;
+      scanReadStatus();
+    }
+  }
+}
+
+/*
+ * the lines of the frame just run, degraded: each odd line from its even
+ * line's source, and only the even lines rendered
+ */
+static void checkRepeatedFrame(const char *name, uint32_t scanLines)
+{
+  const uint32_t lines = vgaParams.params.vVirtualPixels;
+
+  uint32_t badSources = 0;
+  for (uint32_t y = 3; y < lines - 2; y += 2)
+    badSources += !lineSource[y] || lineSource[y] != lineSource[y - 1];
+
+  CHECK_EQ(badSources, 0, "%s: odd lines not from the line above", name);
+  CHECK_EQ(repeats, lines / 2, "%s: repeated lines", name);
+  CHECK_EQ(badRepeatState, 0, "%s: repeated lines leaving the vdp on the wrong line", name);
+  CHECK_EQ(lineInts, 1, "%s: line interrupts", name);
+  CHECK_EQ(scanStats.scanLines - scanLines, vPixels / 2, "%s: lines rendered", name);
+}
+
+int main(void)
+{
+  scanBoot(0, 0);
+  scanAckInts = false;
+
+  const VgaParams *p = &vgaParams.params;
+  lineTicks = (uint64_t)(p->pioDivider * p->pioClocksPerPixel * p->hSyncParams.totalPixels) * p->vPixelScale;
+
+  vgaParams.scanlineFn = slowScanline;
+  vgaParams.repeatScanlineFn = checkedRepeatScanline;
+  simSetDmaHook(onDma);
+
+  TMS_REGISTER(tms9918, 0) |= 0x10;   // line interrupt enabled
+  TMS_REGISTER(tms9918, 0x13) = LINE_INT;
+  CHECK((vBorder + LINE_INT) & 1, "line interrupt on an even vga line");
+
+  // on time: no misses, full level
+  for (int f = 0; f < 4; ++f)
+    runFrame();
+  CHECK_EQ(deadlineStats.missedLines, 0, "lines missed on time");
+  CHECK_EQ(degradeLevel, VGA_DEGRADE_NONE, "level on time");
+
+  // each slow frame misses lines and steps down a level, to repeated lines
+  for (int level = VGA_DEGRADE_NONE; level < VGA_DEGRADE_REPEAT_LINES + 2; ++level)
+  {
+    const uint32_t missed = deadlineStats.missedLines;
+    slow = true;
+    runFrame();
+    slow = false;
+
+    CHECK(deadlineStats.missedLines > missed, "slow frame %d: no missed lines counted", level);
+    const int expect = level < VGA_DEGRADE_REPEAT_LINES ? level + 1 : VGA_DEGRADE_REPEAT_LINES;
+    CHECK_EQ(degradeLevel, expect, "level after slow frame %d", level);
+  }
+
+  // degraded and on time again: odd lines repeat, the vdp still moves on
+  for (int f = 0; f < 2; ++f)
+  {
+    const uint32_t scanLines = scanStats.scanLines;
+    runFrame();
+    checkRepeatedFrame("degraded frame", scanLines);
+  }
+
+  // 2 clean frames so far. the level holds until the recovery window ends
+  const uint32_t missed = deadlineStats.missedLines;
+  for (int f = 2; f < VGA_DEGRADE_RECOVER_FRAMES - 1; ++f)
+    runFrame();
+  CHECK_EQ(degradeLevel, VGA_DEGRADE_REPEAT_LINES, "level a frame before recovery");
+
+  runFrame();
+  CHECK_EQ(degradeLevel, VGA_DEGRADE_NO_PAL_REFRESH, "level after %d clean frames", VGA_DEGRADE_RECOVER_FRAMES);
+  CHECK_EQ(deadlineStats.missedLines, missed, "lines missed while recovering");
+
+  // every line rendered again
+  const uint32_t scanLines = scanStats.scanLines;
+  runFrame();
+  CHECK_EQ(repeats, 0, "repeated lines after recovery");
+  CHECK_EQ(scanStats.scanLines - scanLines, vPixels, "lines rendered after recovery");
+  CHECK_EQ(lineInts, 1, "line interrupts after recovery");
+
+  return checkResult("degrade");
+}
@@ -0,0 +1,179 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * display planning (display.c, vga-clock.c): every CONF_VGA_MODE and
+ * CONF_SCART_MODE at every clock preset
+ */
+
+#include "check.h"
+
+#include "display.h"
+
+static const uint16_t presetVoltageMv[DISPLAY_CLOCK_PRESETS] = { 1150, 1200, 1300 };
+
+/*
+ * pixel clock error (ppm) the vga pio programs will produce at sysClockKHz,
+ * worked out independently of the planner: an integer pio divider for at
+ * least two pio clocks per pixel (doubled below 50 MHz), then a rounded
+ * number of pio clocks per scaled pixel
+ */
+static int32_t pixelClockErrorPpm(uint32_t sysClockKHz, uint32_t pixelClockKHz, uint32_t hScale)
+{
+  double minPioKHz = pixelClockKHz * 2.0 / hScale;
+  if (minPioKHz < 50000.0) minPioKHz *= 2.0;
+
+  const double divider = (double)(uint32_t)(sysClockKHz / minPioKHz + 0.5);
+  const double pioKHz = sysClockKHz / divider;
+  const double clocksPerPixel = (double)(uint32_t)(pioKHz / (pixelClockKHz / (double)hScale) + 0.5);
+  const double achievedKHz = pioKHz / clocksPerPixel * hScale;
+  return (int32_t)((achievedKHz - pixelClockKHz) * 1e6 / pixelClockKHz);
+}
+
+static void checkClock(const DisplayClock *clock, const char *what)
+{
+  const uint32_t vcoMin = 750000, vcoMax = 1600000;
+  CHECK(clock->vcoKHz >= vcoMin && clock->vcoKHz <= vcoMax, "%s: vco %u kHz out of range", what, clock->vcoKHz);
+  CHECK(clock->vcoKHz % 12000 == 0, "%s: vco %u kHz not a crystal multiple", what, clock->vcoKHz);
+  CHECK(clock->postDiv1 >= 1 && clock->postDiv1 <= 7 && clock->postDiv2 >= 1 && clock->postDiv2 <= clock->postDiv1,
+        "%s: post dividers %u/%u", what, clock->postDiv1, clock->postDiv2);
+  CHECK_EQ(clock->sysClockKHz * clock->postDiv1 * clock->postDiv2, clock->vcoKHz, "%s: pll settings", what);
+}
+
+static void testVgaModes(void)
+{
+  const DisplayPlan ref = displayPlan(0, 0, 0, 0);   // 640x480 at the first preset
+
+  for (uint8_t preset = 0; preset < DISPLAY_CLOCK_PRESETS; ++preset)
+  {
+    const DisplayClock presetClock = displayPresetClock(false, preset);
+    CHECK_EQ(presetClock.voltageMv, presetVoltageMv[preset], "vga preset %u voltage", preset);
+
+    for (uint8_t mode = 0; mode < DISPLAY_VGA_MODES; ++mode)
+    {
+      char what[64];
+      snprintf(what, sizeof(what), "vga mode %u preset %u", mode, preset);
+
+      const DisplayPlan plan = displayPlan(0, mode, 0, preset);
+      const VgaParams *p = &plan.params;
+      checkClock(&plan.clock, what);
+
+      // only 1280x1024 at 1.15V has no clock (108 MHz needs 324 MHz at 1.2V)
+      const bool expectFallback = (mode == 3 && preset == 0);
+      CHECK_EQ(plan.fallback, expectFallback, "%s: fallback", what);
+
+      if (plan.fallback || p->pixelClockKHz == ref.params.pixelClockKHz)
+      {
+        // 25.175 MHz modes (and the fallback) run at the preset itself
+        CHECK(displayClockEqual(&plan.clock, &presetClock), "%s: not at the preset clock", what);
+        if (plan.fallback)
+          CHECK_EQ(p->vSyncParams.displayPixels, 480, "%s: fallback mode", what);
+      }
+      else
+      {
+        CHECK(plan.clock.sysClockKHz >= DISPLAY_PLAN_MIN_SYS_KHZ && plan.clock.sysClockKHz <= DISPLAY_PLAN_MAX_SYS_KHZ,
+              "%s: planned %u kHz out of range", what, plan.clock.sysClockKHz);
+        CHECK(plan.clock.voltageMv <= presetClock.voltageMv, "%s: planned %u mV over the preset's %u mV",
+              what, plan.clock.voltageMv, presetClock.voltageMv);
+      }
+
+      const int32_t ppm = pixelClockErrorPpm(plan.clock.sysClockKHz, p->pixelClockKHz, p->hPixelScale);
+      CHECK((ppm < 0 ? -ppm : ppm) <= DISPLAY_PLAN_MAX_ERROR_PPM, "%s: pixel clock error %d ppm", what, ppm);
+
+      // the tms display (192 rows, or 240 where row 30 is offered) fits and the
+      // virtual line fits the line buffers
+      CHECK(p->vVirtualPixels / plan.yScale >= (plan.rows30 ? 240u : 192u), "%s: %u virtual lines / %u", what,
+            p->vVirtualPixels, plan.yScale);
+      CHECK_EQ(plan.rows30, p->vVirtualPixels / plan.yScale >= 240, "%s: row 30", what);
+      if (mode == 2 && !plan.fallback)
+        CHECK(!plan.rows30, "%s: 1024x768 offers row 30", what);
+      CHECK(p->hVirtualPixels >= 512 && p->hVirtualPixels <= RGB_PIXELS_X - 2, "%s: %u virtual pixels", what, p->hVirtualPixels);
+    }
+  }
+}
+
+/*
+ * CONF_VGA_MODE 4 against CEA-861 VIC 17 (720x576p50): 27 MHz, 720/12/64/68
+ * pixels, 576/5/5/39 lines, negative syncs. 640 of the 720 active pixels are
+ * the picture: the other 80 are blank active video, split evenly into the
+ * porches (52 front, 108 back), so the sync and the totals are VIC 17's
+ */
+static void testVic17(void)
+{
+  const uint32_t hActive = 720, hFront = 12, hSync = 64, hBack = 68;
+  const uint32_t vActive = 576, vFront = 5, vSync = 5, vBack = 39;
+
+  for (uint8_t preset = 0; preset < DISPLAY_CLOCK_PRESETS; ++preset)
+  {
+    char what[64];
+    snprintf(what, sizeof(what), "576p50 preset %u", preset);
+
+    const DisplayPlan plan = displayPlan(0, 4, 0, preset);
+    const VgaSyncParams *h = &plan.params.hSyncParams, *v = &plan.params.vSyncParams;
+    CHECK(!plan.fallback, "%s: fallback", what);
+    CHECK_EQ(plan.params.pixelClockKHz, 27000, "%s: pixel clock", what);
+    CHECK_EQ(pixelClockErrorPpm(plan.clock.sysClockKHz, plan.params.pixelClockKHz, plan.params.hPixelScale), 0,
+             "%s: pixel clock not exact", what);
+
+    const uint32_t border = hFront < h->frontPorchPixels ? h->frontPorchPixels - hFront : 0;
+    CHECK_EQ(h->displayPixels, 640, "%s: picture width", what);
+    CHECK_EQ(h->displayPixels + 2 * border, hActive, "%s: active width", what);
+    CHECK_EQ(h->frontPorchPixels, hFront + border, "%s: front porch", what);
+    CHECK_EQ(h->syncPixels, hSync, "%s: hsync", what);
+    CHECK_EQ(h->backPorchPixels, hBack + border, "%s: back porch", what);
+    CHECK_EQ(h->totalPixels, 864, "%s: line total", what);
+
+    CHECK_EQ(v->displayPixels, vActive, "%s: active lines", what);
+    CHECK_EQ(v->frontPorchPixels, vFront, "%s: vertical front porch", what);
+    CHECK_EQ(v->syncPixels, vSync, "%s: vsync", what);
+    CHECK_EQ(v->backPorchPixels, vBack, "%s: vertical back porch", what);
+    CHECK_EQ(v->totalPixels, 625, "%s: frame total", what);
+
+    CHECK(!h->syncHigh && !v->syncHigh, "%s: syncs not negative", what);
+
+    // the tms interrupt follows the frame: 27 MHz / (864 x 625) = 50 Hz
+    CHECK_EQ(plan.params.pixelClockKHz * 1000 % (h->totalPixels * v->totalPixels), 0, "%s: frame rate not whole", what);
+    CHECK_EQ(plan.params.pixelClockKHz * 1000 / (h->totalPixels * v->totalPixels), 50, "%s: frame rate", what);
+    CHECK(plan.params.frameRateHz == 50.0f, "%s: frame rate %.3f", what, plan.params.frameRateHz);
+  }
+}
+
+static void testScartModes(void)
+{
+  for (uint8_t preset = 0; preset < DISPLAY_CLOCK_PRESETS; ++preset)
+  {
+    const DisplayClock presetClock = displayPresetClock(true, preset);
+    CHECK_EQ(presetClock.sysClockKHz % 54000, 0, "scart preset %u: %u kHz not a multiple of 54 MHz", preset, presetClock.sysClockKHz);
+
+    for (uint8_t mode = 0; mode < DISPLAY_SCART_MODES; ++mode)
+    {
+      char what[64];
+      snprintf(what, sizeof(what), "scart mode %u preset %u", mode, preset);
+
+      const DisplayPlan plan = displayPlan(1, 0, mode, preset);
+      checkClock(&plan.clock, what);
+      CHECK(displayClockEqual(&plan.clock, &presetClock), "%s: not at the preset clock", what);
+      CHECK(!plan.fallback, "%s: fallback", what);
+      CHECK_EQ(plan.yScale, 1, "%s: y scale", what);
+      CHECK_EQ(plan.rows30, plan.params.vVirtualPixels >= 240, "%s: row 30", what);
+      CHECK_EQ(pixelClockErrorPpm(plan.clock.sysClockKHz, plan.params.pixelClockKHz, plan.params.hPixelScale), 0,
+               "%s: pixel clock not exact", what);
+    }
+  }
+}
+
+int main()
+{
+  testVgaModes();
+  testVic17();
+  testScartModes();
+  return checkResult("display");
+}
@@ -0,0 +1,372 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * a pre-decoded instruction cache for the 9900 gpu, on the C model of
+ * run9900 (gpu9900.c)
+ *
+ * gpu kernels (a memcpy, a sprite attribute update, a PIX plot) run the same
+ * decoding every instruction and from the cache: the same memory after, and
+ * the results expected. code changed under the cache is run as changed: by
+ * the gpu (an instruction's immediate, its own operand word), by the host
+ * between runs, through X, and the same code with two workspaces. each
+ * kernel's instructions per second, both ways, are printed (not checked:
+ * they're the host's)
+ */
+
+#include "check.h"
+#include "gpu9900.h"
+
+#include <string.h>
+#include <time.h>
+
+#define WS      0x0300            // the workspace
+#define CODE    0x0400            // the kernels
+
+static uint8_t mem[GPU9900_MEM_BYTES];
+static uint8_t ref[GPU9900_MEM_BYTES];
+static volatile uint8_t vr56 = 1;
+static Gpu9900 gpu;
+
+static void poke(uint8_t *m, uint16_t addr, uint16_t value)
+{
+  m[addr] = value >> 8;
+  m[addr + 1] = value & 0xff;
+}
+
+static uint16_t peek(const uint8_t *m, uint16_t addr)
+{
+  return (uint16_t)(m[addr] << 8 | m[addr + 1]);
+}
+
+static void load(uint16_t addr, const uint16_t *words, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i)
+    poke(mem, addr + i * 2, words[i]);
+}
+
+#define LOAD(code) load(CODE, code, sizeof(code) / sizeof(code[0]))
+#define REG(r)     peek(mem, WS + (r) * 2)
+
+/* kernels */
+
+// 2048 words from >1000 to >2000
+static const uint16_t memcpyCode[] = {
+  0x0201, 0x1000,   // LI   R1,>1000
+  0x0202, 0x2000,   // LI   R2,>2000
+  0x0203, 0x0800,   // LI   R3,>0800
+  0xccb1,           // MOV  *R1+,*R2+
+  0x0603,           // DEC  R3
+  0x16fd,           // JNE  $-4
+  0x0340,           // IDLE
+};
+
+static void memcpySetup(void)
+{
+  for (uint32_t i = 0; i < 0x1000; ++i)
+    mem[0x1000 + i] = (uint8_t)(i * 7 + (i >> 8));
+}
+
+static bool memcpyCheck(uint32_t runs)
+{
+  (void)runs;
+  return memcmp(mem + 0x2000, mem + 0x1000, 0x1000) == 0;
+}
+
+// 32 sprites' y and x (the attribute table at >1B00) moved by their velocities at >3000
+#define SPRITES 32
+
+static const uint16_t spriteCode[] = {
+  0x0201, 0x1b00,   // LI   R1,>1B00
+  0x0202, 0x3000,   // LI   R2,>3000
+  0x0203, SPRITES,  // LI   R3,32
+  0xbc72,           // AB   *R2+,*R1+   y
+  0xbc72,           // AB   *R2+,*R1+   x
+  0x05c1,           // INCT R1          pattern, colour
+  0x0603,           // DEC  R3
+  0x16fb,           // JNE  $-8
+  0x0340,           // IDLE
+};
+
+static uint8_t spriteY(uint32_t i) { return (uint8_t)(i * 5); }
+static uint8_t spriteX(uint32_t i) { return (uint8_t)(i * 7 + 3); }
+static uint8_t spriteDy(uint32_t i) { return (uint8_t)(i - SPRITES / 2); }
+static uint8_t spriteDx(uint32_t i) { return (uint8_t)(i * 3 + 1); }
+
+static void spriteSetup(void)
+{
+  for (uint32_t i = 0; i < SPRITES; ++i)
+  {
+    mem[0x1b00 + i * 4 + 0] = spriteY(i);
+    mem[0x1b00 + i * 4 + 1] = spriteX(i);
+    mem[0x1b00 + i * 4 + 2] = (uint8_t)i;
+    mem[0x1b00 + i * 4 + 3] = 0x0f;
+    mem[0x3000 + i * 2 + 0] = spriteDy(i);
+    mem[0x3000 + i * 2 + 1] = spriteDx(i);
+  }
+}
+
+static bool spriteCheck(uint32_t runs)
+{
+  for (uint32_t i = 0; i < SPRITES; ++i)
+  {
+    const uint8_t *s = mem + 0x1b00 + i * 4;
+    if (s[0] != (uint8_t)(spriteY(i) + runs * spriteDy(i)) ||
+        s[1] != (uint8_t)(spriteX(i) + runs * spriteDx(i)) ||
+        s[2] != i || s[3] != 0x0f)
+      return false;
+  }
+  return true;
+}
+
+// a 64x64 bitmap layer (VR32: >1000, VR35: 64) plotted in colour (x + y) & 3
+#define PIX_SIZE 64
+
+static const uint16_t pixCode[] = {
+  0x0204, 0x0000,   // LI   R4,0        x << 8 | y
+  0x0206, PIX_SIZE, // LI   R6,64
+  0x0207, PIX_SIZE, // LI   R7,64       row
+  0xc144,           // MOV  R4,R5       column
+  0x06c5,           // SWPB R5
+  0xa144,           // A    R4,R5
+  0x0245, 0x0003,   // ANDI R5,3        colour, written
+  0x2d44,           // PIX  R4,R5
+  0x0224, 0x0100,   // AI   R4,>0100
+  0x0607,           // DEC  R7
+  0x16f6,           // JNE  column
+  0x0244, 0x00ff,   // ANDI R4,>00FF
+  0x0584,           // INC  R4
+  0x0606,           // DEC  R6
+  0x16ef,           // JNE  row
+  0x0340,           // IDLE
+};
+
+static void pixSetup(void)
+{
+  mem[0x6000 + 32] = 0x1000 >> 6;
+  mem[0x6000 + 35] = PIX_SIZE;
+}
+
+static bool pixCheck(uint32_t runs)
+{
+  (void)runs;
+  for (uint32_t y = 0; y < PIX_SIZE; ++y)
+  {
+    for (uint32_t x = 0; x < PIX_SIZE; ++x)
+    {
+      const uint32_t p = y * PIX_SIZE + x;
+      if (((mem[0x1000 + p / 4] >> (6 - (p & 3) * 2)) & 3) != ((x + y) & 3))
+        return false;
+    }
+  }
+  return true;
+}
+
+typedef struct
+{
+  const char *name;
+  const uint16_t *code;
+  uint32_t words;
+  void (*setup)(void);
+  bool (*check)(uint32_t runs);
+  uint32_t runs;                  // benchmark runs
+} Kernel;
+
+#define KERNEL(name, runs) { #name, name##Code, sizeof(name##Code) / sizeof(name##Code[0]), name##Setup, name##Check, runs }
+
+static const Kernel kernels[] = {
+  KERNEL(memcpy, 2000),
+  KERNEL(sprite, 50000),
+  KERNEL(pix, 300),
+};
+
+static void setupKernel(const Kernel *k)
+{
+  memset(mem, 0, sizeof(mem));
+  load(CODE, k->code, k->words);
+  k->setup();
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* the kernel run both ways: the same memory, as expected. returns instructions per second */
+static double runKernel(const Kernel *k, bool cached, uint32_t runs)
+{
+  setupKernel(k);
+  gpu9900Init(&gpu, mem, &vr56, cached);
+
+  const double start = now();
+  gpu9900Run(&gpu, CODE, WS);
+  const uint64_t decodes = gpu.stats.decodes;
+  for (uint32_t i = 1; i < runs; ++i)
+    gpu9900Run(&gpu, CODE, WS);
+  const double seconds = now() - start;
+
+  CHECK(gpu.idle, "%s (%s): not idle", k->name, cached ? "cached" : "decoded");
+  CHECK(k->check(runs), "%s (%s): wrong result after %u runs", k->name, cached ? "cached" : "decoded", runs);
+  if (cached)
+    CHECK_EQ(gpu.stats.decodes, decodes, "%s: decoded again after the first run, with the cache", k->name);
+  else
+    CHECK_EQ(gpu.stats.decodes, gpu.stats.instructions, "%s: decodes without the cache", k->name);
+
+  return gpu.stats.instructions / seconds;
+}
+
+static void testKernel(const Kernel *k)
+{
+  runKernel(k, false, 3);
+  memcpy(ref, mem, sizeof(ref));
+  const uint64_t instructions = gpu.stats.instructions;
+
+  runKernel(k, true, 3);
+  CHECK(memcmp(mem, ref, sizeof(mem)) == 0, "%s: memory differs with the cache", k->name);
+  CHECK_EQ(gpu.stats.instructions, instructions, "%s: instructions with the cache", k->name);
+  CHECK_EQ(gpu.stats.invalidations, 0, "%s: cache entries dropped", k->name);
+}
+
+static void benchmarkKernel(const Kernel *k)
+{
+  const double decoded = runKernel(k, false, k->runs);
+  const double cached = runKernel(k, true, k->runs);
+  printf("%-8s %7.1f M instructions/s decoded, %7.1f M pre-decoded (%.2fx)\n",
+         k->name, decoded / 1e6, cached / 1e6, cached / decoded);
+}
+
+/* code changed under the cache */
+
+typedef void (*Case)(bool cached);
+
+// the loop's LI immediate counts its passes
+static void selfModifyingImmediate(bool cached)
+{
+  static const uint16_t code[] = {
+    0x0200, 0x000a,   // LI   R0,10
+    0x0201, 0x0000,   // LI   R1,0        >0406: the passes so far
+    0x05a0, 0x0406,   // INC  @>0406
+    0x0600,           // DEC  R0
+    0x16fa,           // JNE  $-10
+    0x0340,           // IDLE
+  };
+  LOAD(code);
+  gpu9900Run(&gpu, CODE, WS);
+
+  const char *mode = cached ? "cached" : "decoded";
+  CHECK_EQ(REG(1), 9, "modified immediate (%s): R1", mode);
+  CHECK_EQ(peek(mem, 0x0406), 10, "modified immediate (%s): the immediate", mode);
+}
+
+// a MOV's store to its own destination word: the next pass stores to >0500
+static void selfModifyingOperand(bool cached)
+{
+  static const uint16_t code[] = {
+    0x0202, 0x0500,   // LI   R2,>0500
+    0x0200, 0x0002,   // LI   R0,2
+    0xc802, 0x040a,   // MOV  R2,@>040A   >040A: its own operand word
+    0x0600,           // DEC  R0
+    0x16fc,           // JNE  $-6
+    0x0340,           // IDLE
+  };
+  LOAD(code);
+  gpu9900Run(&gpu, CODE, WS);
+
+  const char *mode = cached ? "cached" : "decoded";
+  CHECK_EQ(peek(mem, 0x040a), 0x0500, "own operand (%s): the operand word", mode);
+  CHECK_EQ(peek(mem, 0x0500), 0x0500, "own operand (%s): the second pass's store", mode);
+}
+
+// the host changes an immediate, and a block of code, between runs
+static void hostWrites(bool cached)
+{
+  static const uint16_t code[] = {
+    0x0201, 0x1234,   // LI   R1,>1234
+    0x0340,           // IDLE
+  };
+  static const uint16_t other[] = {
+    0x0201, 0xabcd,   // LI   R1,>ABCD
+    0x0340,           // IDLE
+  };
+  const char *mode = cached ? "cached" : "decoded";
+
+  LOAD(code);
+  gpu9900Run(&gpu, CODE, WS);
+  CHECK_EQ(REG(1), 0x1234, "host write (%s): first run", mode);
+
+  gpu9900HostWrite(&gpu, CODE + 2, 0x56);
+  gpu9900Run(&gpu, CODE, WS);
+  CHECK_EQ(REG(1), 0x5634, "host write (%s): after a byte written", mode);
+
+  LOAD(other);
+  gpu9900Invalidate(&gpu, CODE, sizeof(other));
+  gpu9900Run(&gpu, CODE, WS);
+  CHECK_EQ(REG(1), 0xabcd, "host write (%s): after a block loaded", mode);
+}
+
+// X runs the instruction in R5, changed between them
+static void execute(bool cached)
+{
+  static const uint16_t code[] = {
+    0x0205, 0x0582,   // LI   R5,>0582    INC R2
+    0x0485,           // X    R5
+    0x0205, 0x05c2,   // LI   R5,>05C2    INCT R2
+    0x0485,           // X    R5
+    0x0340,           // IDLE
+  };
+  LOAD(code);
+  gpu9900Run(&gpu, CODE, WS);
+  CHECK_EQ(REG(2), 3, "X (%s): R2", cached ? "cached" : "decoded");
+}
+
+// the same code on two workspaces: its register operands are each one's
+static void workspaces(bool cached)
+{
+  static const uint16_t code[] = {
+    0x0201, 0x1111,   // LI   R1,>1111
+    0x0581,           // INC  R1
+    0x0340,           // IDLE
+  };
+  const char *mode = cached ? "cached" : "decoded";
+
+  LOAD(code);
+  gpu9900Run(&gpu, CODE, WS);
+  gpu9900Run(&gpu, CODE, WS + 0x20);
+  CHECK_EQ(REG(1), 0x1112, "workspaces (%s): the first's R1", mode);
+  CHECK_EQ(peek(mem, WS + 0x20 + 2), 0x1112, "workspaces (%s): the second's R1", mode);
+}
+
+static const Case cases[] = {
+  selfModifyingImmediate, selfModifyingOperand, hostWrites, execute, workspaces,
+};
+
+int main(void)
+{
+  for (uint32_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+    testKernel(&kernels[i]);
+
+  for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+  {
+    for (int cached = 0; cached < 2; ++cached)
+    {
+      memset(mem, 0, sizeof(mem));
+      gpu9900Init(&gpu, mem, &vr56, cached);
+      cases[i](cached);
+    }
+  }
+
+  for (uint32_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+    benchmarkKernel(&kernels[i]);
+
+  return checkResult("gpucache");
+}
@@ -0,0 +1,589 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * GPU dma jobs (gpu-dma.c) on a model of the dma hardware
+ *
+ * random copies and fills, forward and reverse, are set up in >8000-8007
+ * and run by triggerGpuDma() against the byte loop the dma replaced. the
+ * model runs a job when the GPU waits for it (tight_loop_contents()): the
+ * control channel loads each row into the row channel, whose reads either
+ * go in step with its writes or all ahead of them, so a job whose result
+ * depends on that order shows up. a job left running must have changed
+ * nothing yet, with >8008 still set and its destination guarded by the
+ * MPU. once it completes the guard is dropped and >8008 is clear
+ *
+ * the MPU regions themselves (guardRegion) are checked against random
+ * spans and VRAM placements. built for the RP2040's and the RP2350's MPU.
+ * gpu-dma.c is built into this test so its statics are reachable
+ */
+
+#include "check.h"
+
+#include "gpu-dma.c"
+
+#include <string.h>
+
+#if PICO_RP2040
+#define CHIP "rp2040"
+#else
+#define CHIP "rp2350"
+#endif
+
+#define JOBS          20000
+#define REGION_TESTS  20000
+#define MAX_SPINS     1000
+
+typedef enum { MODEL_IN_STEP, MODEL_READ_AHEAD, MODEL_ORDERS } ModelOrder;
+
+typedef struct
+{
+  int32_t min;
+  int32_t end;
+} Span;
+
+static VrEmuTms9918 __aligned(0x10000) tmsState;   // the VRAM sits 0x150 into it
+VrEmuTms9918 *tms9918 = &tmsState;
+
+static dma_hw_t dmaState;
+dma_hw_t *const dma_hw = &dmaState;
+static mpu_hw_t mpuState;
+mpu_hw_t *const mpu_hw = &mpuState;
+
+// the dma model
+static ModelOrder modelOrder;
+static uint32_t claimed;
+static uint32_t triggered;            // channels started, run by runDma()
+static irq_handler_t dmaIrqHandlers[2];
+static bool dmaIrqEnabled[2];
+static uint32_t chainsRun;
+static uint32_t wordRows, byteRows;
+static uint32_t spins;
+
+int dma_claim_unused_channel(bool required)
+{
+  for (uint chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+  {
+    if (!(claimed & (1u << chan)))
+    {
+      claimed |= 1u << chan;
+      return (int)chan;
+    }
+  }
+  CHECK(!required, "no dma channel left");
+  return -1;
+}
+
+void dma_channel_claim(uint chan)
+{
+  CHECK(!(claimed & (1u << chan)), "dma channel %u claimed twice", chan);
+  claimed |= 1u << chan;
+}
+
+void dma_channel_configure(uint chan, const dma_channel_config *config, volatile void *writeAddr,
+                           const volatile void *readAddr, uint count, bool trigger)
+{
+  dma_channel_hw_t *ch = &dma_hw->ch[chan];
+  ch->ctrl_trig = config->ctrl;
+  ch->write_addr = (uintptr_t)writeAddr;
+  ch->read_addr = (uintptr_t)readAddr;
+  ch->transfer_count = count;
+  if (trigger) triggered |= 1u << chan;
+}
+
+void dma_channel_set_read_addr(uint chan, const volatile void *readAddr, bool trigger)
+{
+  dma_hw->ch[chan].read_addr = (uintptr_t)readAddr;
+  if (trigger) triggered |= 1u << chan;
+}
+
+static void updateInts(void)
+{
+  dma_hw->ints0 = dma_hw->intr & dma_hw->inte0;
+  dma_hw->ints1 = dma_hw->intr & dma_hw->inte1;
+}
+
+void dma_channel_set_irq0_enabled(uint chan, bool enabled)
+{
+  dma_hw->inte0 = enabled ? (dma_hw->inte0 | (1u << chan)) : (dma_hw->inte0 & ~(1u << chan));
+  updateInts();
+}
+
+void dma_channel_set_irq1_enabled(uint chan, bool enabled)
+{
+  dma_hw->inte1 = enabled ? (dma_hw->inte1 | (1u << chan)) : (dma_hw->inte1 & ~(1u << chan));
+  updateInts();
+}
+
+void dma_channel_acknowledge_irq0(uint chan)
+{
+  dma_hw->intr &= ~(1u << chan);
+  updateInts();
+}
+
+void dma_channel_acknowledge_irq1(uint chan)
+{
+  dma_channel_acknowledge_irq0(chan);
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t orderPriority)
+{
+  (void)orderPriority;
+  CHECK(num == DMA_IRQ_0 || num == DMA_IRQ_1, "shared handler on irq %u", num);
+  if (num == DMA_IRQ_0 || num == DMA_IRQ_1)
+    dmaIrqHandlers[num - DMA_IRQ_0] = handler;
+}
+
+void irq_set_enabled(uint num, bool enabled)
+{
+  if (num == DMA_IRQ_0 || num == DMA_IRQ_1)
+    dmaIrqEnabled[num - DMA_IRQ_0] = enabled;
+}
+
+/*
+ * one row on the row channel, as set up by the control channel. the reads
+ * either go in step with the writes or all of the row's go first
+ */
+static void runRow(dma_channel_hw_t *row)
+{
+  const uint32_t ctrl = row->ctrl_trig;
+  const uint32_t size = 1u << ((ctrl & DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB);
+  const bool incRead = ctrl & DMA_CH0_CTRL_TRIG_INCR_READ_BITS;
+  const bool incWrite = ctrl & DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS;
+  CHECK(size == 1 || size == 4, "row transfer size %u", size);
+  CHECK(incWrite, "row writes don't increment");
+  size == 4 ? ++wordRows : ++byteRows;
+
+  static uint8_t ahead[256 * 4];
+  const uint32_t count = row->transfer_count;
+  CHECK(count * size <= sizeof(ahead), "row of %u bytes", count * size);
+  if (count * size > sizeof(ahead))
+    return;
+
+  for (uint32_t u = 0; u < count; ++u)
+  {
+    const uint8_t *read = (const uint8_t *)row->read_addr + (incRead ? u * size : 0);
+    uint8_t *write = (uint8_t *)row->write_addr + u * size;
+    if (modelOrder == MODEL_READ_AHEAD)
+    {
+      memcpy(ahead + u * size, read, size);
+    }
+    else
+    {
+      uint8_t unit[4];
+      memcpy(unit, read, size);
+      memcpy(write, unit, size);
+    }
+  }
+  if (modelOrder == MODEL_READ_AHEAD)
+    memcpy((uint8_t *)row->write_addr, ahead, count * size);
+}
+
+/*
+ * a control channel run: four 32-bit transfers per block into the row
+ * channel's registers, the last (CTRL_TRIG) starting it. the row chains
+ * back for the next block until one chains to itself
+ */
+static void runChain(uint ctrlChan)
+{
+  dma_channel_hw_t *ctrl = &dma_hw->ch[ctrlChan];
+  const uint32_t ctrlBits = ctrl->ctrl_trig;
+  const uintptr_t chBase = (uintptr_t)&dma_hw->ch[0];
+  const uint rowChan = (uint)((ctrl->write_addr - chBase) / sizeof(dma_channel_hw_t));
+  dma_channel_hw_t *row = &dma_hw->ch[rowChan];
+
+  CHECK(rowChan < NUM_DMA_CHANNELS && ctrl->write_addr == (uintptr_t)&row->read_addr, "control channel writes %#lx",
+        (unsigned long)(ctrl->write_addr - chBase));
+  CHECK_EQ(ctrl->transfer_count, 4, "control transfers per row");
+  CHECK_EQ((ctrlBits & DMA_CH0_CTRL_TRIG_DATA_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_DATA_SIZE_LSB, DMA_SIZE_32, "control transfer size");
+  CHECK_EQ((ctrlBits & DMA_CH0_CTRL_TRIG_RING_SIZE_BITS) >> DMA_CH0_CTRL_TRIG_RING_SIZE_LSB, 4, "control write ring");
+  CHECK(ctrlBits & DMA_CH0_CTRL_TRIG_RING_SEL_BITS, "control ring on reads");
+  CHECK((ctrlBits & DMA_CH0_CTRL_TRIG_INCR_READ_BITS) && (ctrlBits & DMA_CH0_CTRL_TRIG_INCR_WRITE_BITS), "control increments");
+  if (rowChan >= NUM_DMA_CHANNELS)
+    return;
+
+  for (uint32_t blocks = 0; ; ++blocks)
+  {
+    if (blocks == GPU_DMA_MAX_ROWS)
+    {
+      CHECK(false, "chain runs past %u rows", GPU_DMA_MAX_ROWS);
+      return;
+    }
+
+    const GpuDmaBlock *block = (const GpuDmaBlock *)ctrl->read_addr;
+    ctrl->read_addr += sizeof(*block);
+    row->read_addr = (uintptr_t)block->read;
+    row->write_addr = (uintptr_t)block->write;
+    row->transfer_count = block->count;
+    row->ctrl_trig = block->ctrl;
+    CHECK(row->ctrl_trig & DMA_CH0_CTRL_TRIG_EN_BITS, "row channel not enabled");
+
+    runRow(row);
+
+    if (!(row->ctrl_trig & DMA_CH0_CTRL_TRIG_IRQ_QUIET_BITS))
+    {
+      dma_hw->intr |= 1u << rowChan;
+      updateInts();
+    }
+
+    const uint chainTo = (row->ctrl_trig & DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS) >> DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB;
+    if (chainTo == rowChan)
+      return;
+    CHECK_EQ(chainTo, ctrlChan, "row chains to");
+    if (chainTo != ctrlChan)
+      return;
+  }
+}
+
+/*
+ * run the started channels to completion, then the dma irq handlers
+ */
+static void runDma(void)
+{
+  for (uint chan = 0; triggered; chan = (chan + 1) % NUM_DMA_CHANNELS)
+  {
+    if (triggered & (1u << chan))
+    {
+      triggered &= ~(1u << chan);
+      runChain(chan);
+      ++chainsRun;
+    }
+  }
+
+  for (int line = 0; line < 2; ++line)
+  {
+    for (int calls = 0; (line ? dma_hw->ints1 : dma_hw->ints0) && calls < 4; ++calls)
+    {
+      CHECK(dmaIrqHandlers[line] && dmaIrqEnabled[line], "dma irq %d raised with no handler", line);
+      if (!dmaIrqHandlers[line] || !dmaIrqEnabled[line])
+        break;
+      dmaIrqHandlers[line]();
+    }
+  }
+}
+
+void __wfe(void)
+{
+  runDma();
+  if (++spins == MAX_SPINS)
+  {
+    CHECK(false, "job never completed");
+    gpuDmaBusy = false;
+  }
+}
+
+void __sev(void)
+{
+}
+
+/*
+ * the byte loop the dma replaced (all on VRAM offsets). false if it would
+ * go outside the VRAM, in which case it changes nothing. spans of what it
+ * reads and writes come back in src and dst
+ */
+static bool referenceJob(uint8_t *vram, uint32_t src, uint32_t dst, uint32_t width, uint32_t height,
+                         uint32_t stride, uint32_t params, Span *srcSpan, Span *dstSpan)
+{
+  const int32_t dstInc = params & 0x02 ? -1 : 1;
+  const int32_t srcInc = params & 0x01 ? 0 : dstInc;
+
+  srcSpan->min = dstSpan->min = INT32_MAX;
+  srcSpan->end = dstSpan->end = INT32_MIN;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    int32_t s = (int32_t)src, d = (int32_t)dst;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+      for (uint32_t x = 0; x < width; ++x, s += srcInc, d += dstInc)
+      {
+        if (pass == 0)
+        {
+          if (s < 0 || s > 0xffff || d < 0 || d > 0xffff)
+            return false;
+          if (s < srcSpan->min) srcSpan->min = s;
+          if (s >= srcSpan->end) srcSpan->end = s + 1;
+          if (d < dstSpan->min) dstSpan->min = d;
+          if (d >= dstSpan->end) dstSpan->end = d + 1;
+        }
+        else
+        {
+          vram[d] = vram[s];
+        }
+      }
+      s += ((int32_t)stride - (int32_t)width) * srcInc;
+      d += ((int32_t)stride - (int32_t)width) * dstInc;
+    }
+  }
+  return true;
+}
+
+/*
+ * the address range [lo, end) an MPU region covers and its access bits.
+ * false if it's disabled
+ */
+static bool decodeRegion(const GuardRegion *region, uint64_t *lo, uint64_t *end, uint32_t *access)
+{
+#if PICO_RP2040
+  if (!(region->attr & M0PLUS_MPU_RASR_ENABLE_BITS))
+    return false;
+  const uint32_t sizeBits = ((region->attr >> M0PLUS_MPU_RASR_SIZE_LSB) & 0x1f) + 1;
+  const uint32_t disabled = (region->attr >> M0PLUS_MPU_RASR_SRD_LSB) & 0xff;
+  const uint64_t base = region->rbar & ~0xffu;
+  const uint64_t subSize = 1ull << (sizeBits - 3);
+  CHECK(sizeBits >= 8, "region of %u bytes has no subregions", 1u << sizeBits);
+  CHECK_EQ(base & ((1ull << sizeBits) - 1), 0, "region base not aligned to its size");
+  CHECK(disabled != 0xff, "every subregion disabled");
+
+  int first = 0, last = 7;
+  while (first < 8 && (disabled & (1u << first))) ++first;
+  while (last >= 0 && (disabled & (1u << last))) --last;
+  for (int i = first; i <= last; ++i)
+    CHECK(!(disabled & (1u << i)), "subregions not contiguous (%#x)", disabled);
+
+  *lo = base + first * subSize;
+  *end = base + (last + 1) * subSize;
+  *access = (region->attr >> 24) & 0x07;
+  CHECK(region->attr & 0x10000000, "region executable");
+#else
+  if (!(region->attr & M33_MPU_RLAR_EN_BITS))
+    return false;
+  *lo = region->rbar & ~31u;
+  *end = (uint64_t)(region->attr & ~31u) + 32;
+  *access = (region->rbar >> M33_MPU_RBAR_AP_LSB) & 0x03;
+  CHECK(region->rbar & M33_MPU_RBAR_XN_BITS, "region executable");
+#endif
+  return true;
+}
+
+/*
+ * the region last loaded into the MPU
+ */
+static GuardRegion lastRegion(uint32_t *number)
+{
+  GuardRegion region;
+#if PICO_RP2040
+  *number = mpu_hw->rbar & M0PLUS_MPU_RBAR_REGION_BITS;
+  region.rbar = mpu_hw->rbar & ~(M0PLUS_MPU_RBAR_VALID_BITS | M0PLUS_MPU_RBAR_REGION_BITS);
+  region.attr = mpu_hw->rasr;
+#else
+  *number = mpu_hw->rnr;
+  region.rbar = mpu_hw->rbar;
+  region.attr = mpu_hw->rlar;
+#endif
+  return region;
+}
+
+/*
+ * a region covers the VRAM span [lo, end) with the access asked for, and
+ * nothing outside the VRAM
+ */
+static void checkRegion(const char *what, const GuardRegion *region, uint32_t vram, Span span, uint32_t access)
+{
+  uint64_t lo = 0, end = 0;
+  uint32_t regionAccess = 0;
+  if (!decodeRegion(region, &lo, &end, &regionAccess))
+  {
+    CHECK(false, "%s: region disabled", what);
+    return;
+  }
+  CHECK(lo <= vram + (uint64_t)span.min && end >= vram + (uint64_t)span.end,
+        "%s: region %#llx-%#llx misses >%04X->%04X", what, (unsigned long long)(lo - vram),
+        (unsigned long long)(end - vram), span.min, span.end);
+  CHECK(lo >= vram && end <= vram + 0x10000ull, "%s: region %#llx-%#llx outside the VRAM", what,
+        (unsigned long long)(lo - vram), (unsigned long long)(end - vram));
+  CHECK_EQ(regionAccess, access, "%s: access", what);
+}
+
+/*
+ * guardRegion() over random spans, with the VRAM at random places
+ */
+static void testRegions(void)
+{
+  uint32_t seed = 0x9900;
+  uint32_t refused = 0;
+  for (int i = 0; i < REGION_TESTS; ++i)
+  {
+    const bool aligned = i & 1;
+    const uint32_t vram = 0x20000000u + ((checkRand(&seed) & 0x3ffff) & (aligned ? ~0xffffu : ~3u));
+    const uint32_t size = (checkRand(&seed) % 4) ? 1 + checkRand(&seed) % 512 : 1 + checkRand(&seed) % 0x10000;
+    const Span span = { (int32_t)(checkRand(&seed) % (0x10000 - size + 1)), 0 };
+    const Span whole = { span.min, span.min + (int32_t)size };
+    const uint32_t access = (i & 2) ? GUARD_READ_ONLY : GUARD_NO_ACCESS;
+
+    GuardRegion region;
+    if (!guardRegion(vram + whole.min, vram + whole.end, access, vram, vram + 0x10000, &region))
+    {
+      // a VRAM aligned to its size always has room
+      CHECK(!aligned, "vram %#x >%04X->%04X refused", vram, whole.min, whole.end);
+      ++refused;
+      continue;
+    }
+
+    char what[64];
+    snprintf(what, sizeof(what), "vram %#x >%04X->%04X", vram, whole.min, whole.end);
+    checkRegion(what, &region, vram, whole, access);
+  }
+  CHECK(refused > 0, "no span near the edge of an unaligned VRAM refused");
+}
+
+/*
+ * random jobs through triggerGpuDma(), against the byte loop
+ */
+static void testJobs(ModelOrder order)
+{
+  static uint8_t before[0x10000], expect[0x10000];
+  uint8_t *vram = tms9918->vram.bytes;
+  const uint32_t vramAddr = (uint32_t)(uintptr_t)vram;
+  const char *orderName = order == MODEL_READ_AHEAD ? "read ahead" : "in step";
+  uint32_t seed = 0x8008;
+  uint32_t outside = 0, onCpu = 0, waited = 0, running = 0, mismatches = 0;
+
+  modelOrder = order;
+  wordRows = byteRows = 0;
+
+  for (int i = 0; i < JOBS; ++i)
+  {
+    for (uint32_t a = 0; a < 0x10000; a += 4)
+    {
+      const uint32_t r = checkRand(&seed);
+      memcpy(vram + a, &r, 4);
+    }
+
+    const uint32_t src = checkRand(&seed) & 0xffff;
+    const uint32_t near = checkRand(&seed) % 3;
+    uint32_t dst = near == 0 ? src + checkRand(&seed) % 64 - 32 :
+                   near == 1 ? checkRand(&seed) : (src & ~3u) + (checkRand(&seed) % 16) * 4 - 32;
+    dst &= 0xffff;
+    uint32_t s = src;
+    if (checkRand(&seed) & 1)
+    {
+      s &= ~3u;
+      dst &= ~3u;
+    }
+    uint32_t width = (checkRand(&seed) % 3) ? checkRand(&seed) % 40 : checkRand(&seed) & 0xff;
+    uint32_t height = (checkRand(&seed) % 3) ? checkRand(&seed) % 8 : checkRand(&seed) & 0xff;
+    uint32_t stride = (checkRand(&seed) & 1) ? width + (checkRand(&seed) % 8) * ((checkRand(&seed) & 1) ? 4 : 1) : checkRand(&seed) & 0xff;
+    const uint32_t params = checkRand(&seed) & 0x03;
+    if (checkRand(&seed) & 1)
+    {
+      width &= ~3u;
+      stride &= ~3u;
+    }
+    stride &= 0xff;
+
+    vram[0x8000] = s >> 8;
+    vram[0x8001] = s & 0xff;
+    vram[0x8002] = dst >> 8;
+    vram[0x8003] = dst & 0xff;
+    vram[0x8004] = width;
+    vram[0x8005] = height;
+    vram[0x8006] = stride;
+    vram[0x8007] = params;
+    vram[0x8008] = 0x01;
+    memcpy(before, vram, sizeof(before));
+    memcpy(expect, vram, sizeof(expect));
+
+    char name[128];
+    snprintf(name, sizeof(name), "%s: src >%04X dst >%04X %ux%u stride %u params %u", orderName, s, dst, width, height, stride, params);
+
+    Span srcSpan, dstSpan;
+    if (!referenceJob(expect, s, dst, width, height, stride, params, &srcSpan, &dstSpan))
+    {
+      // the cpu loop would run outside the VRAM too: only the dma side is tried
+      ++outside;
+      CHECK(!startGpuDma(s, dst, width, height, stride, params), "%s: dma outside the VRAM", name);
+      CHECK(!gpuDmaRunning() && !triggered, "%s: dma started", name);
+      continue;
+    }
+    expect[0x8008] = expect[0x8009] = 0;
+
+    const uint32_t chains = chainsRun;
+    spins = 0;
+    triggerGpuDma();
+
+    if (gpuDmaRunning())
+    {
+      ++running;
+      CHECK(memcmp(vram, before, sizeof(before)) == 0, "%s: VRAM changed before the job ran", name);
+
+      // the destination's guard is the last region loaded
+      uint32_t number;
+      const GuardRegion region = lastRegion(&number);
+#if PICO_RP2040
+      CHECK_EQ(number, GPU_DMA_DST_REGION, "%s: last region loaded", name);
+#else
+      CHECK_EQ(number, GPU_DMA_DST_REGION + 1, "%s: last region loaded", name);
+#endif
+      checkRegion(name, &region, vramAddr, dstSpan, GUARD_NO_ACCESS);
+
+      waitGpuDma();
+    }
+    else if (chainsRun != chains)
+    {
+      ++waited;
+    }
+    else
+    {
+      ++onCpu;
+    }
+
+    CHECK(!gpuDmaRunning(), "%s: still running", name);
+    CHECK(!triggered, "%s: channels left started", name);
+
+    // the guard is dropped once the job is done
+    if (chainsRun != chains)
+    {
+      uint32_t number;
+      const GuardRegion region = lastRegion(&number);
+      uint64_t lo, end;
+      uint32_t access;
+      CHECK(!decodeRegion(&region, &lo, &end, &access), "%s: guard left in place", name);
+    }
+
+    if (memcmp(vram, expect, sizeof(expect)) != 0)
+    {
+      uint32_t a = 0;
+      while (vram[a] == expect[a]) ++a;
+      if (mismatches++ < 8)
+        CHECK(false, "%s: >%04X is %02X, expected %02X", name, a, vram[a], expect[a]);
+    }
+  }
+
+  CHECK_EQ(mismatches, 0, "%s: jobs that differ from the cpu loop", orderName);
+  CHECK(running > 0, "%s: no job left running", orderName);
+  CHECK(waited > 0, "%s: no unguardable job waited for", orderName);
+  CHECK(onCpu > 0, "%s: no job on the cpu", orderName);
+  CHECK(outside > 0, "%s: no job outside the VRAM", orderName);
+  CHECK(wordRows > 0 && byteRows > 0, "%s: %u word rows, %u byte rows", orderName, wordRows, byteRows);
+  printf("%s: %u running, %u waited for, %u on the cpu, %u outside the VRAM\n", orderName, running, waited, onCpu, outside);
+}
+
+int main(void)
+{
+  // the vga's channels (vgaInit) and main's memset channel are claimed first
+  dma_channel_claim(0);
+  dma_channel_claim(1);
+  dma_channel_claim(2);
+  dma_channel_claim(3);
+  initGpuDma();
+
+  CHECK_EQ(gpuDmaChan, 4, "row channel");
+  CHECK_EQ(gpuDmaCtrlChan, 5, "control channel");
+  CHECK(dmaIrqHandlers[1] == gpuDmaIrqHandler && dmaIrqEnabled[1], "DMA_IRQ_1 handler");
+  CHECK(!dmaIrqHandlers[0], "DMA_IRQ_0 handler");
+  CHECK_EQ(dma_hw->inte1, 1u << gpuDmaChan, "DMA_IRQ_1 channels");
+
+  testRegions();
+  for (int order = 0; order < MODEL_ORDERS; ++order)
+    testJobs((ModelOrder)order);
+
+  return checkResult("gpudma (" CHIP ")");
+}
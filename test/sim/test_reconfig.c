@@ -0,0 +1,349 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * live display mode switch (vgaStop/vgaRestart in vga.c) on the hardware
+ * model
+ *
+ * for every clock preset, the output is switched between every pair of
+ * modes that run at the same system clock (the ones a live switch accepts,
+ * see displayModeSwitchable). vgaStop() must leave the dma and state
+ * machines idle. after vgaRestart() the line and frame periods on the sync
+ * pins must be the new mode's, the same as when booted into it, and every
+ * line of each field must be requested
+ *
+ * vga.c is built into this test so its statics are reachable
+ */
+
+#include "check.h"
+#include "sim_hw.h"
+
+#include "vga.c"
+
+#include <math.h>
+#include <string.h>
+
+#define MODE_COUNT      (DISPLAY_VGA_MODES + DISPLAY_SCART_MODES)
+#define MAX_INTERVALS   4096
+#define MAX_FRAMES      8
+
+typedef struct
+{
+  const char *name;
+  uint8_t driver;
+  uint8_t vgaMode;
+  uint8_t scartMode;
+} Mode;
+
+static const Mode modes[MODE_COUNT] = {
+  { "vga 640x480",   0, 0, 0 },
+  { "vga 640x400",   0, 1, 0 },
+  { "vga 1024x768",  0, 2, 0 },
+  { "vga 1280x1024", 0, 3, 0 },
+  { "vga 720x576",   0, 4, 0 },
+  { "scart 576i",    2, 0, 0 },
+  { "scart 480i",    1, 0, 1 },
+  { "scart 288p",    4, 0, 2 },
+  { "scart 240p",    3, 0, 3 },
+};
+
+// what the model saw since the last switch
+static bool broadSync;                        // composite sync: field starts are the broad pulses
+static uint32_t broadTicks;                   // a sync pulse at least this long is broad
+static uint64_t lastFall;
+static uint32_t intervals[MAX_INTERVALS];
+static uint32_t intervalCount;
+static uint64_t frameTicks[MAX_FRAMES];
+static uint32_t frameCount;
+static bool lastBroad;
+static uint32_t eofCount;
+static uint32_t requestCount;
+static uint32_t firstRequest;
+static uint8_t linesSeen[VGA_MAX_FIELDS][1024];
+static uint64_t switchTicks;
+
+/*
+ * sync pins. the most common interval between falling edges of the first
+ * (hsync, or composite sync) is the line period. vga frames start on a
+ * vsync edge, composite fields on the first broad pulse
+ */
+static void onPins(int pio, uint64_t tick, uint32_t pins)
+{
+  static uint32_t lastPins;
+  if (pio != 0) return;
+
+  const uint32_t hsync = 1u << SYNC_PINS_START, vsync = 1u << (SYNC_PINS_START + 1);
+  const uint32_t fell = lastPins & ~pins, rose = ~lastPins & pins;
+  lastPins = pins;
+
+  if (fell & hsync)
+  {
+    if (lastFall && intervalCount < MAX_INTERVALS)
+      intervals[intervalCount++] = (uint32_t)(tick - lastFall);
+    lastFall = tick;
+  }
+
+  bool frameStart = false;
+  if (broadSync && (rose & hsync) && lastFall)
+  {
+    const bool broad = tick - lastFall >= broadTicks;
+    frameStart = broad && !lastBroad;
+    lastBroad = broad;
+  }
+  else if (!broadSync)
+  {
+    frameStart = (rose & vsync) != 0;
+  }
+
+  if (frameStart && frameCount < MAX_FRAMES)
+    frameTicks[frameCount++] = tick;
+}
+
+static void onIrq(uint irq, bool enter)
+{
+  if (enter) return;
+
+  while (requestPending())
+  {
+    const uint32_t message = popRequest();
+    if (requestCount++ == 0)
+      firstRequest = message;
+
+    if (message & END_OF_FRAME_MSG)
+    {
+      ++eofCount;
+    }
+    else if (!(message & (END_OF_SCANLINE_MSG | FRONT_PORCH_MSG)))
+    {
+      const uint32_t line = message & 0x0fff;
+      if (line < 1024)
+        linesSeen[(message >> 12) & 0x01][line] = 1;
+    }
+  }
+}
+
+/*
+ * the most common line period seen
+ */
+static uint32_t commonInterval(void)
+{
+  uint32_t best = 0, bestCount = 0;
+  for (uint32_t i = 0; i < intervalCount; ++i)
+  {
+    uint32_t count = 0;
+    for (uint32_t j = 0; j < intervalCount; ++j)
+      count += intervals[j] == intervals[i];
+    if (count > bestCount)
+    {
+      best = intervals[i];
+      bestCount = count;
+    }
+  }
+  return best;
+}
+
+static VgaInitParams modeParams(const DisplayPlan *plan)
+{
+  VgaInitParams params = { 0 };
+  params.params = plan->params;
+  if (plan->yScale > 1)
+    setVgaParamsScaleY(&params.params, plan->yScale);
+  params.triggerScanline = params.params.vVirtualPixels - 8;
+  return params;
+}
+
+static void resetCapture(void)
+{
+  lastFall = 0;
+  intervalCount = frameCount = eofCount = requestCount = 0;
+  lastBroad = false;
+  memset(linesSeen, 0, sizeof(linesSeen));
+  switchTicks = simTicks();
+}
+
+/*
+ * timing of the mode now running, from its sync pins and the requests sent
+ */
+typedef struct
+{
+  uint32_t lineTicks;
+  uint64_t frameTicks;
+} Timing;
+
+static Timing measure(const char *name)
+{
+  const VgaParams *p = &vgaParams.params;
+  const uint32_t fieldCount = p->fieldSync ? p->numFields : 1;
+
+  uint32_t frameLines = 0;
+  for (uint32_t f = 0; f < fieldCount; ++f)
+    frameLines += p->fieldSync ? p->fields[f].totalLines : p->vSyncParams.totalPixels;
+
+  const double lineTicks = (double)p->pioDivider * p->pioClocksPerPixel * p->hSyncParams.totalPixels;
+  broadSync = p->fieldSync;
+  broadTicks = (uint32_t)(lineTicks / 4);
+
+  // a partial frame, then a whole one between the next two frame starts
+  const uint32_t frameStarts = 2 + fieldCount;
+  const uint64_t maxTicks = simTicks() + (uint64_t)(lineTicks * frameLines * 4);
+  while ((frameCount < frameStarts || eofCount < fieldCount + 1) && simTicks() < maxTicks)
+    simHwAdvance(maxTicks - simTicks());
+
+  Timing t = { 0, 0 };
+  CHECK(frameCount >= frameStarts, "%s: %u frame starts, expected %u", name, frameCount, frameStarts);
+  CHECK(eofCount >= fieldCount + 1, "%s: %u ends of frame, expected %u", name, eofCount, fieldCount + 1);
+  if (frameCount < frameStarts) return t;
+
+  // within the VESA/CEA tolerance of the mode
+  t.lineTicks = commonInterval();
+  CHECK(fabs(t.lineTicks - lineTicks) <= lineTicks * 0.005, "%s: line period %u ticks, mode %.1f", name, t.lineTicks, lineTicks);
+
+  t.frameTicks = frameTicks[frameStarts - 1] - frameTicks[frameStarts - 1 - fieldCount];
+  CHECK_EQ(t.frameTicks, (uint64_t)t.lineTicks * frameLines, "%s: frame period (%u lines)", name, frameLines);
+
+  // nothing before the first active area: it starts with line 0 of field 0
+  CHECK_EQ(firstRequest, 0, "%s: first request", name);
+
+  // every tms line of every field requested
+  for (uint32_t f = 0; f < fieldCount; ++f)
+  {
+    uint32_t seen = 0;
+    for (uint32_t l = 0; l < p->vVirtualPixels; ++l)
+      seen += linesSeen[f][l];
+    CHECK_EQ(seen, p->vVirtualPixels, "%s: lines requested in field %u", name, f);
+  }
+
+  CHECK_EQ(simSmStats(VGA_PIO, SYNC_SM)->outStalls, 0, "%s: sync pio ran dry", name);
+  CHECK_EQ(deadlineStats.droppedRequests, 0, "%s: dropped requests", name);
+  return t;
+}
+
+/*
+ * vgaStop() has turned the dma irq off and left everything idle
+ */
+static void checkStopped(const char *name)
+{
+  const uint32_t mask = (1u << syncCtrlDmaChan) | syncDmaChanMask | rgbDmaChanMask;
+
+  CHECK(!stopRequest && stopAck, "%s: stop handshake", name);
+  CHECK(!(VGA_PIO->ctrl & ((1u << SYNC_SM) | (1u << RGB_SM))), "%s: vga state machines running", name);
+  for (int chan = 0; chan < NUM_DMA_CHANNELS; ++chan)
+  {
+    if (mask & (1u << chan))
+      CHECK(!dma_channel_is_busy(chan), "%s: dma channel %d busy", name, chan);
+  }
+
+  // nothing moves until the restart
+  const uint64_t stopTicks = simTicks();
+  const uint32_t syncStalls = simSmStats(VGA_PIO, SYNC_SM)->outStalls;
+  simHwRun(10000);
+  CHECK(!requestPending(), "%s: requests after the stop", name);
+  CHECK_EQ(simSmStats(VGA_PIO, SYNC_SM)->outStalls, syncStalls, "%s: sync pio ran after the stop", name);
+  CHECK_EQ(dma_hw->inte0 & mask, 0, "%s: dma irqs left enabled", name);
+  CHECK_EQ(dma_hw->intr & mask, 0, "%s: dma irqs left pending", name);
+  CHECK_EQ(simTicks() - stopTicks, 10000, "%s: model stalled", name);
+}
+
+/*
+ * a fresh model at a plan's system clock
+ */
+static void startModel(const DisplayPlan *plan)
+{
+  simHwReset();
+  set_sys_clock_pll(plan->clock.vcoKHz * 1000, plan->clock.postDiv1, plan->clock.postDiv2);
+  simSetPinHook(onPins);
+  simSetIrqHook(onIrq);
+  requestHead = requestTail = 0;
+  memset(&deadlineStats, 0, sizeof(deadlineStats));
+}
+
+/*
+ * switch between each pair of modes that share a system clock at a preset
+ */
+static void runPreset(uint8_t preset)
+{
+  DisplayPlan plans[MODE_COUNT];
+  for (int m = 0; m < MODE_COUNT; ++m)
+    plans[m] = displayPlan(modes[m].driver, modes[m].vgaMode, modes[m].scartMode, preset);
+
+  bool done[MODE_COUNT] = { false };
+  for (int first = 0; first < MODE_COUNT; ++first)
+  {
+    if (done[first]) continue;
+
+    // the modes a live switch from here accepts
+    int group[MODE_COUNT], groupSize = 0;
+    for (int m = first; m < MODE_COUNT; ++m)
+    {
+      if (displayClockEqual(&plans[m].clock, &plans[first].clock))
+      {
+        group[groupSize++] = m;
+        done[m] = true;
+      }
+    }
+    if (groupSize < 2) continue;
+
+    // each mode's timing when booted into
+    Timing booted[MODE_COUNT];
+    for (int g = 0; g < groupSize; ++g)
+    {
+      const int m = group[g];
+      startModel(&plans[m]);
+      resetCapture();
+      vgaInit(modeParams(&plans[m]));
+
+      char name[96];
+      snprintf(name, sizeof(name), "preset %u %s", preset, modes[m].name);
+      booted[m] = measure(name);
+    }
+
+    // then every ordered pair switched live: i -> j, then back
+    startModel(&plans[group[0]]);
+    resetCapture();
+    vgaInit(modeParams(&plans[group[0]]));
+    int current = group[0];
+    for (int i = 0; i < groupSize; ++i)
+    {
+      for (int j = i + 1; j < groupSize; ++j)
+      {
+        const int route[3] = { group[i], group[j], group[i] };
+        for (int r = 0; r < 3; ++r)
+        {
+          const int to = route[r];
+          if (to == current) continue;
+
+          char name[96];
+          snprintf(name, sizeof(name), "preset %u %s -> %s", preset, modes[current].name, modes[to].name);
+          vgaStop();
+          checkStopped(name);
+
+          resetCapture();
+          VgaInitParams params = modeParams(&plans[to]);
+          params.scanlines = vgaParams.scanlines;
+          vgaRestart(params);
+
+          const Timing t = measure(name);
+          CHECK_EQ(t.lineTicks, booted[to].lineTicks, "%s: line period differs from boot", name);
+          CHECK_EQ(t.frameTicks, booted[to].frameTicks, "%s: frame period differs from boot", name);
+          current = to;
+        }
+      }
+    }
+  }
+}
+
+int main(void)
+{
+  for (uint8_t preset = 0; preset < DISPLAY_CLOCK_PRESETS; ++preset)
+    runPreset(preset);
+
+  return checkResult("reconfig");
+}
@@ -0,0 +1,175 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * vga line request ring (vga.c): pushRequest() from one thread against
+ * popRequest() on another, then vgaLoop's handling of a backlog
+ *
+ * vga.c is built into this test so its statics are reachable
+ */
+
+#include "check.h"
+#include "sim_hw.h"
+
+#include "vga.c"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#define STRESS_MESSAGES 2000000
+
+static volatile bool producerDone = false;
+
+/*
+ * the dma irq's side: a sequence number per message, in bursts
+ */
+static void *producer(void *arg)
+{
+  uint32_t seed = 0x9918;
+  uint32_t message = 1;
+  while (message <= STRESS_MESSAGES)
+  {
+    const uint32_t burst = checkRand(&seed) % (VGA_REQUEST_RING_SIZE * 2);
+    for (uint32_t i = 0; i < burst && message <= STRESS_MESSAGES; ++i)
+      pushRequest(message++);
+    if (checkRand(&seed) & 1)
+      sched_yield();
+  }
+  producerDone = true;
+  return arg;
+}
+
+static void testThreadedRing(void)
+{
+  memset(&deadlineStats, 0, sizeof(deadlineStats));
+  requestHead = requestTail = 0;
+  producerDone = false;
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, producer, NULL);
+
+  uint32_t seed = 0x56;
+  uint32_t consumed = 0, last = 0, outOfOrder = 0;
+  while (!producerDone || requestPending())
+  {
+    if (!requestPending())
+    {
+      sched_yield();
+      continue;
+    }
+
+    const uint32_t message = popRequest();
+    if (message <= last) ++outOfOrder;    // repeated or reordered
+    last = message;
+    ++consumed;
+
+    // fall behind now and then, so the ring fills
+    if ((checkRand(&seed) & 0xfff) == 0)
+      nanosleep(&(struct timespec){ 0, 20000 }, NULL);
+  }
+  pthread_join(thread, NULL);
+
+  CHECK_EQ(outOfOrder, 0, "messages out of order or repeated");
+  CHECK_EQ(consumed + deadlineStats.droppedRequests, STRESS_MESSAGES, "consumed %u dropped %u",
+           consumed, deadlineStats.droppedRequests);
+  CHECK(deadlineStats.droppedRequests > 0, "the ring never filled: the test didn't stress it");
+  CHECK(deadlineStats.maxQueuedRequests <= VGA_REQUEST_RING_SIZE, "max queued %u", deadlineStats.maxQueuedRequests);
+}
+
+/*
+ * vgaLoop callbacks log what they're called with
+ */
+static char eventLog[256];
+
+static void logEvent(const char *fmt, uint32_t value)
+{
+  char event[16];
+  snprintf(event, sizeof(event), fmt, value);
+  strncat(eventLog, event, sizeof(eventLog) - strlen(eventLog) - 1);
+}
+
+static void logScanline(uint16_t y, VgaParams *params, uint16_t *pixels) { logEvent("L%x ", y); }
+static void logPorch() { logEvent("P ", 0); }
+static void logEndOfScanline(uint32_t line) { logEvent("S%u ", line); }
+static void logEndOfFrame(uint32_t frame) { logEvent("F%u ", frame); }
+
+#define SERVICE 0xffffffff   // service what's queued so far
+
+/*
+ * queue the messages, servicing the queue at each SERVICE and at the end,
+ * and compare the callbacks made
+ */
+static void checkBacklog(const uint32_t *messages, int count, const char *expectLog, uint32_t expectMissed)
+{
+  requestHead = requestTail = 0;
+  memset(&deadlineStats, 0, sizeof(deadlineStats));
+  eventLog[0] = '\0';
+
+  uint32_t frameNumber = 0;
+  for (int i = 0; i <= count; ++i)
+  {
+    if (i == count || messages[i] == SERVICE)
+    {
+      while (requestPending())
+        vgaServiceRequest(&frameNumber);
+    }
+    else
+    {
+      pushRequest(messages[i]);
+    }
+  }
+
+  CHECK(strcmp(eventLog, expectLog) == 0, "callbacks '%s', expected '%s'", eventLog, expectLog);
+  CHECK_EQ(deadlineStats.missedLines, expectMissed, "missed lines for '%s'", expectLog);
+}
+
+static void testBacklog(void)
+{
+  memset(&vgaParams, 0, sizeof(vgaParams));
+  vgaParams.params.hVirtualPixels = 256;
+  vgaParams.params.vVirtualPixels = 192;
+  vgaParams.params.vPixelScale = 2;
+  vgaParams.scanlineFn = logScanline;
+  vgaParams.porchFn = logPorch;
+  vgaParams.endOfScanlineFn = logEndOfScanline;
+  vgaParams.endOfFrameFn = logEndOfFrame;
+  degradeLevel = VGA_DEGRADE_NONE;
+  outputLine = -1;
+
+  // in time: every line and event in turn
+  // in time: every line and event in turn (lines logged in hex, field in bit 12)
+  const uint32_t inTime[] = { 0, 1, SERVICE, 2, END_OF_SCANLINE_MSG | 2, SERVICE, 3, END_OF_FRAME_MSG, SERVICE, FRONT_PORCH_MSG };
+  checkBacklog(inTime, 10, "L0 L1 L2 S2 L3 F0 P ", 0);
+
+  // line 0 of either field always has line 1 queued behind it. not a backlog
+  const uint32_t firstLines[] = { 0x0000, 0x0001, SERVICE, 0x1000, 0x1001 };
+  checkBacklog(firstLines, 5, "L0 L1 L1000 L1001 ", 0);
+
+  // late: skip to the latest line, but stop at the events
+  const uint32_t late[] = { 5, 6, 7, END_OF_SCANLINE_MSG | 7, 8, 9, END_OF_FRAME_MSG, FRONT_PORCH_MSG };
+  checkBacklog(late, 8, "L7 S7 L9 F0 P ", 3);
+
+  // an event behind a line isn't a later line
+  const uint32_t porch[] = { 0xbf, FRONT_PORCH_MSG };
+  checkBacklog(porch, 2, "Lbf P ", 0);
+
+  const uint32_t scanline[] = { 0x64, END_OF_SCANLINE_MSG | 100, 0x65 };
+  checkBacklog(scanline, 3, "L64 S100 L65 ", 0);
+}
+
+int main(void)
+{
+  testThreadedRing();
+  testBacklog();
+  return checkResult("ring");
+}
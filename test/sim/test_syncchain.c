@@ -0,0 +1,397 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * vga sync dma chain (vga.c) run on the hardware model against a reference
+ * model of the per-line sync irq it replaced
+ *
+ * for every output mode, vgaInit() starts the real chain, control channel
+ * and dmaIrqHandler() on the model, which runs the pio programs cycle by
+ * cycle. the sync buffer queued for each line, the requests the sync irq
+ * queues and where it restarts the rgb output must all match the old irq,
+ * line for line, for three frames (both fields of interlaced modes)
+ *
+ * vga.c is built into this test so its statics are reachable
+ */
+
+#include "check.h"
+#include "sim_hw.h"
+
+#include "vga.c"
+
+#include <string.h>
+
+#define SIM_FRAMES      3
+#define MAX_SYNC_LINES  (SIM_FRAMES * 2 * 1100)
+#define MAX_EVENTS      (SIM_FRAMES * 2 * 1100)
+
+typedef struct
+{
+  uint32_t position;    // sync lines queued so far (the init buffer is the first)
+  uint32_t message;     // request, or RGB_RESTART
+  bool fromSync;        // queued by the sync channel's irq (else the rgb channel's)
+} SyncEvent;
+
+#define RGB_RESTART 0xffffffff
+
+static uintptr_t syncLog[MAX_SYNC_LINES];
+static uint32_t syncCount;
+static SyncEvent events[MAX_EVENTS];
+static uint32_t eventCount;
+static bool rgbAborted;
+
+static void logEvent(uint32_t message)
+{
+  // the sync irq sends lines 0 and 1 of each field and the porch, the rgb irq the rest
+  const bool fromSync = message == RGB_RESTART || message == FRONT_PORCH_MSG ||
+                        (!(message & (END_OF_SCANLINE_MSG | END_OF_FRAME_MSG)) && (message & 0x0fff) <= 1);
+  if (eventCount < MAX_EVENTS)
+    events[eventCount++] = (SyncEvent){ syncCount, message, fromSync };
+}
+
+static void logRequests(void)
+{
+  while (requestPending())
+    logEvent(popRequest());
+}
+
+/*
+ * an rgb channel start after an abort is the field restart in the sync irq
+ */
+static void onDma(uint chan, SimDmaEvent event, uintptr_t readAddr)
+{
+  if (chan == (uint)syncDmaChan && event == SIM_DMA_TRIGGER)
+  {
+    if (syncCount < MAX_SYNC_LINES)
+      syncLog[syncCount++] = readAddr;
+  }
+  else if (chan == (uint)rgbDmaChan)
+  {
+    if (event == SIM_DMA_ABORT)
+    {
+      rgbAborted = true;
+    }
+    else if (rgbAborted)
+    {
+      logRequests();
+      logEvent(RGB_RESTART);
+      rgbAborted = false;
+    }
+  }
+}
+
+static void onIrq(uint irq, bool enter)
+{
+  if (!enter)
+    logRequests();
+}
+
+/*
+ * reference: the sync irq before the chain. it ran once per line, queued
+ * the next line's sync buffer and sent the sync requests as it went
+ */
+typedef struct
+{
+  const uint32_t *buffer;
+  uint32_t messages[3];
+  int messageCount;
+} RefLine;
+
+static void refAdd(RefLine *line, uint32_t message)
+{
+  line->messages[line->messageCount++] = message;
+}
+
+static int refBuild(RefLine *out, int count)
+{
+  const VgaParams *p = &vgaParams.params;
+  int currentLine = -1, currentField = 0;
+
+  for (int i = 0; i < count; ++i)
+  {
+    RefLine *line = &out[i];
+    memset(line, 0, sizeof(*line));
+
+    if (p->fieldSync)
+    {
+      const VgaFieldParams *field = &p->fields[currentField];
+      if (++currentLine >= (int)field->totalLines)
+      {
+        currentLine = 0;
+        if (p->numFields > 1)
+          currentField ^= 1;
+        field = &p->fields[currentField];
+      }
+
+      const int vsyncEnd = field->vsyncLines;
+      const int porchEnd = vsyncEnd + field->porchLines;
+      const int activeEnd = porchEnd + field->activeLines;
+
+      if (currentLine < vsyncEnd)
+      {
+        line->buffer = vsyncTypeBuffers[field->vsyncPattern[currentLine]];
+      }
+      else if (currentLine < porchEnd)
+      {
+        line->buffer = syncDataPorch;
+        if (currentLine + 2 == porchEnd)
+        {
+          refAdd(line, (uint32_t)(currentField << 12) | 0);
+          refAdd(line, (uint32_t)(currentField << 12) | 1);
+          refAdd(line, RGB_RESTART);
+        }
+      }
+      else if (currentLine < activeEnd)
+      {
+        line->buffer = syncDataActive;
+      }
+      else
+      {
+        line->buffer = vsyncTypeBuffers[field->trailingPattern[currentLine - activeEnd]];
+        if (currentLine == activeEnd)
+          refAdd(line, FRONT_PORCH_MSG);
+      }
+    }
+    else
+    {
+      const VgaSyncParams *v = &p->vSyncParams;
+      if (++currentLine >= v->totalPixels)
+        currentLine = 0;
+
+      const int porchEnd = v->syncPixels + v->backPorchPixels;
+      const int activeEnd = v->totalPixels - v->frontPorchPixels;
+
+      // the old irq never reached its front porch line with a 1-line front
+      // porch (1280x1024), so never sent the request. the chain sends it
+      // on the last line instead
+      int frontPorchLine = activeEnd + 2;
+      if (frontPorchLine >= v->totalPixels) frontPorchLine = v->totalPixels - 1;
+
+      if (currentLine < v->syncPixels)
+      {
+        line->buffer = syncDataSync;
+      }
+      else if (currentLine < porchEnd)
+      {
+        line->buffer = syncDataPorch;
+        if (currentLine + 2 == porchEnd)
+        {
+          refAdd(line, 0);
+          refAdd(line, 1);
+        }
+      }
+      else if (currentLine < activeEnd)
+      {
+        line->buffer = syncDataActive;
+      }
+      else
+      {
+        line->buffer = syncDataPorch;
+      }
+
+      if (currentLine == frontPorchLine)
+        refAdd(line, FRONT_PORCH_MSG);
+    }
+  }
+  return count;
+}
+
+static RefLine ref[MAX_SYNC_LINES];
+
+/*
+ * the requests from the rgb irq each field: every line in order, the
+ * trigger scanline after its line, then the end of frame
+ */
+static void checkRgbRequests(const char *name)
+{
+  const VgaParams *p = &vgaParams.params;
+  uint32_t expectLine = 0, field = 0, fields = 0;
+  bool inField = false, sawEof = false;
+
+  for (uint32_t i = 0; i < eventCount; ++i)
+  {
+    const uint32_t message = events[i].message;
+    if (events[i].fromSync)
+    {
+      if (message != RGB_RESTART && message != FRONT_PORCH_MSG && (message & 0x0fff) == 0)
+      {
+        if (inField)
+        {
+          CHECK_EQ(expectLine, p->vVirtualPixels, "%s: field %u requested lines", name, fields);
+          CHECK(sawEof, "%s: field %u had no end of frame", name, fields);
+          ++fields;
+        }
+        inField = true;
+        sawEof = false;
+        field = message >> 12;
+        expectLine = 0;
+      }
+      if (message != RGB_RESTART && message != FRONT_PORCH_MSG)
+      {
+        CHECK_EQ(message, (field << 12) | expectLine, "%s: sync irq line request", name);
+        ++expectLine;
+      }
+      continue;
+    }
+
+    if (!inField)
+      continue;
+
+    if (message == END_OF_FRAME_MSG)
+    {
+      CHECK_EQ(expectLine, p->vVirtualPixels, "%s: end of frame after line", name);
+      sawEof = true;
+    }
+    else if (message & END_OF_SCANLINE_MSG)
+    {
+      CHECK_EQ(message & 0x0fff, vgaParams.triggerScanline, "%s: trigger scanline", name);
+      CHECK_EQ(expectLine, vgaParams.triggerScanline + 2, "%s: trigger scanline sent after line", name);
+    }
+    else
+    {
+      CHECK_EQ(message, (field << 12) | expectLine, "%s: rgb irq line request", name);
+      ++expectLine;
+    }
+  }
+  CHECK(fields >= SIM_FRAMES - 1, "%s: only %u whole fields", name, fields);
+}
+
+static void runMode(const char *name, uint8_t driver, uint8_t vgaMode, uint8_t scartMode, uint8_t preset)
+{
+  const DisplayPlan plan = displayPlan(driver, vgaMode, scartMode, preset);
+
+  simHwReset();
+  set_sys_clock_pll(plan.clock.vcoKHz * 1000, plan.clock.postDiv1, plan.clock.postDiv2);
+  simSetDmaHook(onDma);
+  simSetIrqHook(onIrq);
+
+  requestHead = requestTail = 0;
+  syncCount = eventCount = 0;
+  rgbAborted = false;
+  memset(&deadlineStats, 0, sizeof(deadlineStats));
+
+  VgaInitParams params = { 0 };
+  params.params = plan.params;
+  if (plan.yScale > 1)
+    setVgaParamsScaleY(&params.params, plan.yScale);
+  params.triggerScanline = params.params.vVirtualPixels - 8;
+  vgaInit(params);
+
+  const VgaParams *p = &vgaParams.params;
+  const uint32_t fieldCount = p->fieldSync ? p->numFields : 1;
+  uint32_t frameLines = 0;
+  for (uint32_t f = 0; f < fieldCount; ++f)
+    frameLines += p->fieldSync ? p->fields[f].totalLines : p->vSyncParams.totalPixels;
+
+  const uint32_t lines = 1 + SIM_FRAMES * frameLines;
+  const uint64_t lineTicks = (uint64_t)(p->pioDivider * p->pioClocksPerPixel * p->hSyncParams.totalPixels + 0.5f);
+  const uint64_t maxTicks = (lines + 8) * lineTicks * 2;
+  while (syncCount < lines && simTicks() < maxTicks)
+    simHwAdvance(maxTicks - simTicks());
+
+  CHECK_EQ(syncCount, lines, "%s: sync lines queued in %llu ticks", name, (unsigned long long)maxTicks);
+  CHECK_EQ(simSmStats(VGA_PIO, SYNC_SM)->outStalls, 0, "%s: sync pio ran dry", name);
+  CHECK_EQ(deadlineStats.droppedRequests, 0, "%s: dropped requests", name);
+
+  // the first buffer is the one vgaInitSync() starts the channel on
+  CHECK(syncLog[0] == (uintptr_t)(p->fieldSync ? syncDataLsLs : syncDataSync), "%s: initial sync buffer", name);
+
+  refBuild(ref, syncCount - 1);
+  uint32_t lineErrors = 0;
+  for (uint32_t i = 1; i < syncCount; ++i)
+  {
+    if (syncLog[i] != (uintptr_t)ref[i - 1].buffer && lineErrors++ < 4)
+      CHECK(false, "%s: sync line %u (line %u of the frame) buffer differs", name, i, (i - 1) % frameLines);
+  }
+  CHECK_EQ(lineErrors, 0, "%s: sync line buffers differ", name);
+
+  // the sync irq's requests at the same lines as the old irq
+  uint32_t e = 0;
+  for (uint32_t i = 1; i < syncCount; ++i)
+  {
+    for (int m = 0; m < ref[i - 1].messageCount; ++m)
+    {
+      while (e < eventCount && !events[e].fromSync) ++e;
+      if (e >= eventCount)
+      {
+        // the last line's requests may not have run yet
+        CHECK(i >= syncCount - 2, "%s: missing request %08x at line %u", name, ref[i - 1].messages[m], i);
+        break;
+      }
+      CHECK_EQ(events[e].message, ref[i - 1].messages[m], "%s: sync request at line %u", name, i);
+      CHECK_EQ(events[e].position, i, "%s: position of sync request %08x", name, events[e].message);
+      ++e;
+    }
+  }
+  while (e < eventCount && !events[e].fromSync) ++e;
+  CHECK_EQ(e, eventCount, "%s: extra sync requests", name);
+
+  checkRgbRequests(name);
+}
+
+/*
+ * a mode with more lines than the sync list holds is clamped to fit, with
+ * every milestone still in the list
+ */
+static void checkListBounds(const char *name, bool fieldSync)
+{
+  memset(&vgaParams, 0, sizeof(vgaParams));
+  VgaParams *p = &vgaParams.params;
+  p->fieldSync = fieldSync;
+  p->numFields = 2;
+  p->vSyncParams = (VgaSyncParams){ .displayPixels = 1900, .frontPorchPixels = 10, .syncPixels = 4, .backPorchPixels = 86, .totalPixels = 2000 };
+  for (int f = 0; f < VGA_MAX_FIELDS; ++f)
+    p->fields[f] = (VgaFieldParams){ .vsyncLines = 3, .porchLines = 20, .activeLines = 677, .totalLines = 700 };
+
+  buildSyncList();
+
+  const int fieldCount = fieldSync ? 2 : 1;
+  CHECK_EQ(syncMilestoneCount, VGA_SYNC_MILESTONES_PER_FIELD * fieldCount, "%s: milestones", name);
+
+  // walk the chain as the control channel would, field by field
+  const uint32_t **entry = syncList;
+  int entries = 0;
+  for (uint32_t m = 0; m < syncMilestoneCount && entries <= VGA_SYNC_LIST_SIZE; ++m)
+  {
+    while (entries <= VGA_SYNC_LIST_SIZE && *entry++ != NULL) ++entries;
+    ++entries;
+    CHECK(syncMilestones[m].type != SYNC_MILESTONE_END || m == syncMilestoneCount - 1 ||
+          syncMilestones[m].resume == entry, "%s: milestone %u resumes after its NULL", name, m);
+  }
+  CHECK(entries <= VGA_SYNC_LIST_SIZE, "%s: %d sync list entries, room for %d", name, entries, VGA_SYNC_LIST_SIZE);
+  CHECK(syncMilestones[syncMilestoneCount - 1].resume == syncList, "%s: last milestone restarts the list", name);
+}
+
+int main(void)
+{
+  static const char *vgaNames[DISPLAY_VGA_MODES] = { "640x480", "640x400", "1024x768", "1280x1024", "720x576" };
+  static const char *scartNames[DISPLAY_SCART_MODES] = { "576i", "480i", "288p", "240p" };
+
+  for (uint8_t preset = 0; preset < DISPLAY_CLOCK_PRESETS; ++preset)
+  {
+    char name[40];
+    for (uint8_t mode = 0; mode < DISPLAY_VGA_MODES; ++mode)
+    {
+      snprintf(name, sizeof(name), "vga %s preset %u", vgaNames[mode], preset);
+      runMode(name, 0, mode, 0, preset);
+    }
+    for (uint8_t mode = 0; mode < DISPLAY_SCART_MODES; ++mode)
+    {
+      snprintf(name, sizeof(name), "scart %s preset %u", scartNames[mode], preset);
+      runMode(name, 1, 0, mode, preset);
+    }
+  }
+
+  checkListBounds("oversized vga", false);
+  checkListBounds("oversized fields", true);
+
+  return checkResult("syncchain");
+}
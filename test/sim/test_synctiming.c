@@ -0,0 +1,697 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * sync timing of every mode (vga.c on the dma/pio model) against the
+ * published standards
+ *
+ * each mode runs cycle by cycle at every clock preset. the hsync, vsync and
+ * pixel enable (any rgb pin set) waveforms on the pins are measured and
+ * checked against reference timings written out here from VESA DMT,
+ * CEA-861 and ITU-R BT.470 / SMPTE 170M, not taken from vga-modes.c
+ *
+ * the end of frame requests (the tms interrupt) must come at the standard's
+ * frame rate
+ *
+ * the time each dma irq leaves before the pio needs data it could not have
+ * queued yet is the irq's budget. the worst one for each kind of irq is
+ * reported, and must leave room for the handler
+ *
+ * with a directory argument, the waveforms are written there as vcd files
+ *
+ * vga.c is built into this test so its statics are reachable
+ */
+
+#include "check.h"
+#include "sim_hw.h"
+
+#include "vga.c"
+
+#include <ctype.h>
+#include <math.h>
+#include <string.h>
+
+#define MAX_EVENTS        (1 << 17)
+#define MAX_EDGES         8192
+#define CLOCK_TOLERANCE   0.005     // VESA pixel clock tolerance, also held to for the scart line rate
+#define EDGE_TOLERANCE    1.0       // pixels, for the vga hsync width
+#define PICTURE_TOLERANCE 0.01      // of the line, for the picture edges: the rgb pixel is a whole
+                                    // number of pio cycles and starts a few cycles after the sync irq
+#define ISR_BUDGET_MIN_US 2.0       // dmaIrqHandler's worst case, with room to spare
+
+/*
+ * vga reference timings (pixels and lines)
+ */
+typedef struct
+{
+  const char *name;
+  uint8_t vgaMode;
+  const char *standard;
+  double pixelClockMHz;
+  uint16_t hActive, hFront, hSync, hBack;
+  uint16_t vActive, vFront, vSync, vBack;
+  bool hSyncHigh, vSyncHigh;
+} VgaReference;
+
+static const VgaReference vgaRefs[] = {
+  { "vga 640x480",   0, "VESA DMT 640x480@60",    25.175,  640, 16,  96,  48,  480, 10, 2, 33, false, false },
+  { "vga 640x400",   1, "VESA DMT 640x400@70",    25.175,  640, 16,  96,  48,  400, 12, 2, 35, false, true  },
+  { "vga 1024x768",  2, "VESA DMT 1024x768@60",   65.0,   1024, 24, 136, 160,  768,  3, 6, 29, false, false },
+  { "vga 1280x1024", 3, "VESA DMT 1280x1024@60", 108.0,   1280, 48, 112, 248, 1024,  1, 3, 38, true,  true  },
+  { "vga 720x576",   4, "CEA-861 VIC 17 576p50",  27.0,    720, 12,  64,  68,  576,  5, 5, 39, false, false },
+};
+
+/*
+ * scart (composite sync) reference timings. csync is negative
+ */
+typedef struct
+{
+  const char *name;
+  uint8_t driver;
+  uint8_t scartMode;
+  const char *standard;
+  double lineUs;
+  double fieldLines;          // x.5 for interlaced fields
+  uint8_t fields;
+  double hSyncUs, hSyncTolUs;
+  double eqUs, eqTolUs;       // equalising pulse
+  double serrationUs, serrationTolUs;
+  uint8_t broadPulses;        // per field
+  double blankStartUs;        // sync leading edge to the picture, at least
+  double frontPorchUs;        // picture to the next sync leading edge, at least
+  double topBlankLines;       // first broad pulse to the first picture line, at least
+  double bottomBlankLines;    // last picture line to the next broad pulse, at least
+} ScartReference;
+
+static const ScartReference scartRefs[] = {
+  { "scart 576i", 2, 0, "BT.470 625/50 interlaced",  64.0,   312.5, 2, 4.7, 0.2, 2.35, 0.1, 4.7, 0.1, 5, 10.5, 1.55, 22, 2.5 },
+  { "scart 480i", 1, 1, "SMPTE 170M 525/60 interlaced", 63.556, 262.5, 2, 4.7, 0.1, 2.3,  0.1, 4.7, 0.1, 6, 9.2,  1.4,  17, 3   },
+  { "scart 288p", 4, 2, "BT.470 625/50, 312 line fields", 64.0, 312, 1, 4.7, 0.2, 2.35, 0.1, 4.7, 0.1, 5, 10.5, 1.55, 22, 2.5 },
+  { "scart 240p", 3, 3, "SMPTE 170M 525/60, 262 line fields", 63.556, 262, 1, 4.7, 0.1, 2.3, 0.1, 4.7, 0.1, 6, 9.2, 1.4, 17, 3 },
+};
+
+#define VGA_REFS    (sizeof(vgaRefs) / sizeof(vgaRefs[0]))
+#define SCART_REFS  (sizeof(scartRefs) / sizeof(scartRefs[0]))
+
+static const uint32_t HSYNC_PIN = 1u << SYNC_PINS_START;
+static const uint32_t VSYNC_PIN = 1u << (SYNC_PINS_START + 1);
+static const uint32_t RGB_MASK = ((1u << RGB_PINS_COUNT) - 1) << RGB_PINS_START;
+
+/*
+ * pin changes on the vga pio
+ */
+typedef struct
+{
+  uint64_t tick;
+  uint32_t pins;
+} PinEvent;
+
+static PinEvent events[MAX_EVENTS];
+static uint32_t eventCount;
+static uint32_t eventsScanned;          // by the run's stop condition
+
+/*
+ * irq budgets. an irq's deadline is when the pio first needs data that
+ * wasn't queued when the irq was raised: the sync state machine pulling
+ * past what its fifo held, the rgb state machine starting the next line
+ */
+typedef enum { BUDGET_ACTIVE, BUDGET_FRONT_PORCH, BUDGET_END, BUDGET_LINE, BUDGET_KINDS } BudgetKind;
+static const char *budgetNames[BUDGET_KINDS] = { "active", "front porch", "end", "line" };
+
+typedef struct
+{
+  uint64_t irqTick;
+  uint64_t pullsDue;          // the sync pio's pull count once it reaches unqueued data
+  BudgetKind kind;
+} SyncDeadline;
+
+#define MAX_SYNC_DEADLINES 4  // milestones can be a line apart (1280x1024's front porch)
+
+static double ticksPerUs;
+static uint64_t minBudget[BUDGET_KINDS];
+static SyncDeadline syncDeadlines[MAX_SYNC_DEADLINES];
+static uint32_t syncDeadlineCount;
+static bool rgbPending;
+static uint64_t rgbIrqTick;
+
+#define MAX_FRAME_ENDS 16
+static uint64_t frameEndTicks[MAX_FRAME_ENDS];   // end of frame requests
+static uint32_t frameEndCount;
+
+static void addBudget(BudgetKind kind, uint64_t ticks)
+{
+  if (ticks < minBudget[kind])
+    minBudget[kind] = ticks;
+}
+
+static void onPins(int pio, uint64_t tick, uint32_t pins)
+{
+  if (pio != 0) return;
+
+  if (rgbPending && (pins & RGB_MASK) && eventCount && !(events[eventCount - 1].pins & RGB_MASK))
+  {
+    addBudget(BUDGET_LINE, tick - rgbIrqTick);
+    rgbPending = false;
+  }
+
+  if (eventCount < MAX_EVENTS)
+    events[eventCount++] = (PinEvent){ tick, pins };
+}
+
+static void onIrq(uint irq, bool enter)
+{
+  if (!enter)
+  {
+    while (requestPending())
+    {
+      if ((popRequest() & END_OF_FRAME_MSG) && frameEndCount < MAX_FRAME_ENDS)
+        frameEndTicks[frameEndCount++] = simTicks();
+    }
+    return;
+  }
+
+  const uint32_t status = dma_hw->ints0;
+  if ((status & (1u << syncDmaChan)) && syncDeadlineCount < MAX_SYNC_DEADLINES)
+  {
+    syncDeadlines[syncDeadlineCount++] = (SyncDeadline){
+      simTicks(),
+      simSmStats(VGA_PIO, SYNC_SM)->txPulls + simSmTxLevel(VGA_PIO, SYNC_SM) + 1,
+      (BudgetKind)syncMilestones[nextSyncMilestone].type };
+  }
+  if (status & (1u << rgbDmaChan))
+  {
+    rgbPending = true;
+    rgbIrqTick = simTicks();
+  }
+}
+
+static void checkSyncDeadlines(void)
+{
+  const uint64_t pulls = simSmStats(VGA_PIO, SYNC_SM)->txPulls;
+  while (syncDeadlineCount && pulls >= syncDeadlines[0].pullsDue)
+  {
+    addBudget(syncDeadlines[0].kind, simTicks() - syncDeadlines[0].irqTick);
+    memmove(syncDeadlines, syncDeadlines + 1, --syncDeadlineCount * sizeof(syncDeadlines[0]));
+  }
+}
+
+static VgaInitParams modeParams(const DisplayPlan *plan)
+{
+  VgaInitParams params = { 0 };
+  params.params = plan->params;
+  if (plan->yScale > 1)
+    setVgaParamsScaleY(&params.params, plan->yScale);
+  params.triggerScanline = params.params.vVirtualPixels - 8;
+  return params;
+}
+
+/*
+ * boot a mode on a fresh model, every pixel of both line buffers lit
+ */
+static void startMode(const DisplayPlan *plan)
+{
+  simHwReset();
+  set_sys_clock_pll(plan->clock.vcoKHz * 1000, plan->clock.postDiv1, plan->clock.postDiv2);
+  simSetPinHook(onPins);
+  simSetIrqHook(onIrq);
+  requestHead = requestTail = 0;
+  memset(&deadlineStats, 0, sizeof(deadlineStats));
+
+  eventCount = eventsScanned = 0;
+  syncDeadlineCount = 0;
+  rgbPending = false;
+  frameEndCount = 0;
+  for (int k = 0; k < BUDGET_KINDS; ++k)
+    minBudget[k] = UINT64_MAX;
+  ticksPerUs = simSysClockHz() / 1e6;
+
+  vgaInit(modeParams(plan));
+
+  // the extra word after the line is the black guard
+  for (int b = 0; b < 2; ++b)
+  {
+    for (uint32_t x = 0; x < vgaParams.params.hVirtualPixels; ++x)
+      rgbDataBuffer[b][x] = 0xffff;
+    rgbDataBuffer[b][vgaParams.params.hVirtualPixels] = 0;
+    rgbDataBuffer[b][vgaParams.params.hVirtualPixels + 1] = 0;
+  }
+}
+
+/*
+ * run until done() or for maxTicks
+ */
+static void runFor(bool (*done)(void), uint64_t maxTicks)
+{
+  const uint64_t end = simTicks() + maxTicks;
+  while (!done() && simTicks() < end)
+  {
+    simHwAdvance(end - simTicks());
+    checkSyncDeadlines();
+  }
+}
+
+static double us(uint64_t ticks)
+{
+  return ticks / ticksPerUs;
+}
+
+/*
+ * the pins at a tick
+ */
+static uint32_t pinsAt(uint64_t tick)
+{
+  uint32_t lo = 0, hi = eventCount;
+  while (hi - lo > 1)
+  {
+    const uint32_t mid = (lo + hi) / 2;
+    if (events[mid].tick <= tick) lo = mid; else hi = mid;
+  }
+  return events[lo].pins;
+}
+
+/*
+ * a pin's active level: the one it spends less time at
+ */
+static bool activeHigh(uint32_t pin)
+{
+  uint64_t high = 0, low = 0;
+  for (uint32_t i = 0; i + 1 < eventCount; ++i)
+  {
+    const uint64_t span = events[i + 1].tick - events[i].tick;
+    if (events[i].pins & pin) high += span; else low += span;
+  }
+  return high < low;
+}
+
+/*
+ * the ticks a pin becomes active (leading) or inactive
+ */
+static uint32_t edges(uint32_t pin, bool high, bool leading, uint64_t *out)
+{
+  uint32_t count = 0;
+  for (uint32_t i = 1; i < eventCount && count < MAX_EDGES; ++i)
+  {
+    const bool was = ((events[i - 1].pins & pin) != 0) == high;
+    const bool is = ((events[i].pins & pin) != 0) == high;
+    if (is != was && is == leading)
+      out[count++] = events[i].tick;
+  }
+  return count;
+}
+
+static bool inWindow(double measured, double expected, double tolerance)
+{
+  return fabs(measured - expected) <= tolerance;
+}
+
+static void writeVcd(const char *dir, const char *name, bool composite)
+{
+  char path[512];
+  snprintf(path, sizeof(path), "%s/%s.vcd", dir, name);
+  for (char *c = path + strlen(dir) + 1; *c && strcmp(c, ".vcd"); ++c)
+    if (!isalnum((unsigned char)*c)) *c = '_';
+
+  FILE *f = fopen(path, "w");
+  if (!f)
+  {
+    CHECK(false, "%s: can't write %s", name, path);
+    return;
+  }
+
+  fprintf(f, "$timescale 1 ns $end\n$scope module %s $end\n", composite ? "scart" : "vga");
+  fprintf(f, "$var wire 1 h %s $end\n", composite ? "csync" : "hsync");
+  if (!composite)
+    fprintf(f, "$var wire 1 v vsync $end\n");
+  fprintf(f, "$var wire 1 e pixel_enable $end\n$upscope $end\n$enddefinitions $end\n");
+
+  for (uint32_t i = 0; i < eventCount; ++i)
+  {
+    const uint32_t pins = events[i].pins, last = i ? events[i - 1].pins : ~pins;
+    fprintf(f, "#%llu\n", (unsigned long long)llround(events[i].tick * 1000.0 / ticksPerUs));
+    if ((pins ^ last) & HSYNC_PIN) fprintf(f, "%dh\n", (pins & HSYNC_PIN) != 0);
+    if (!composite && ((pins ^ last) & VSYNC_PIN)) fprintf(f, "%dv\n", (pins & VSYNC_PIN) != 0);
+    if (!(pins & RGB_MASK) != !(last & RGB_MASK)) fprintf(f, "%de\n", (pins & RGB_MASK) != 0);
+  }
+  fclose(f);
+}
+
+static void reportBudgets(const char *name)
+{
+  printf("%s: irq budget", name);
+  for (int k = 0; k < BUDGET_KINDS; ++k)
+  {
+    if (minBudget[k] == UINT64_MAX) continue;
+    printf(" %s %.2fus", budgetNames[k], us(minBudget[k]));
+    CHECK(us(minBudget[k]) >= ISR_BUDGET_MIN_US, "%s: %s irq budget %.2fus, below %.1fus", name, budgetNames[k], us(minBudget[k]), ISR_BUDGET_MIN_US);
+  }
+  printf("\n");
+
+  CHECK(minBudget[BUDGET_LINE] != UINT64_MAX, "%s: no line irq", name);
+  CHECK_EQ(simSmStats(VGA_PIO, SYNC_SM)->outStalls, 0, "%s: sync pio ran dry", name);
+}
+
+/*
+ * vga: separate hsync and vsync
+ */
+static uint64_t vsyncStarts[MAX_EDGES], hsyncStarts[MAX_EDGES];
+static uint32_t vsyncChanges;
+
+static bool vgaFramesDone(void)
+{
+  // three vsync pulses, whichever the polarity: the frame between the
+  // second and third is measured
+  for (; eventsScanned < eventCount; ++eventsScanned)
+  {
+    const uint32_t e = eventsScanned;
+    if (e && ((events[e].pins ^ events[e - 1].pins) & VSYNC_PIN))
+      ++vsyncChanges;
+  }
+  return vsyncChanges >= 7 || eventCount >= MAX_EVENTS;
+}
+
+static void checkVga(const VgaReference *mode, uint8_t preset, const char *vcdDir)
+{
+  // a mode the preset can't clock falls back to 640x480
+  const DisplayPlan plan = displayPlan(0, mode->vgaMode, 0, preset);
+  const VgaReference *ref = plan.fallback ? &vgaRefs[0] : mode;
+
+  char name[96];
+  snprintf(name, sizeof(name), "preset %u %s%s", preset, mode->name, plan.fallback ? " (640x480 fallback)" : "");
+  startMode(&plan);
+
+  const double pixelUs = 1.0 / ref->pixelClockMHz;
+  const uint32_t hTotal = ref->hActive + ref->hFront + ref->hSync + ref->hBack;
+  const uint32_t vTotal = ref->vActive + ref->vFront + ref->vSync + ref->vBack;
+  const double lineUs = hTotal * pixelUs;
+
+  vsyncChanges = 0;
+  runFor(vgaFramesDone, (uint64_t)(lineUs * vTotal * 4 * ticksPerUs));
+
+  if (vcdDir) writeVcd(vcdDir, name, false);
+
+  const bool hHigh = activeHigh(HSYNC_PIN), vHigh = activeHigh(VSYNC_PIN);
+  CHECK_EQ(hHigh, ref->hSyncHigh, "%s: hsync polarity", name);
+  CHECK_EQ(vHigh, ref->vSyncHigh, "%s: vsync polarity", name);
+
+  const uint32_t vCount = edges(VSYNC_PIN, vHigh, true, vsyncStarts);
+  const uint32_t hCount = edges(HSYNC_PIN, hHigh, true, hsyncStarts);
+  CHECK(vCount >= 3, "%s: %u vsyncs", name, vCount);
+  if (vCount < 3) return;
+
+  // the frame between the second and third vsync, in lines from hsync to hsync
+  const uint64_t frameStart = vsyncStarts[1], frameEnd = vsyncStarts[2];
+  uint32_t first = 0;
+  while (first + 1 < hCount && hsyncStarts[first + 1] <= frameStart) ++first;
+  uint32_t last = first;
+  while (last + 1 < hCount && hsyncStarts[last + 1] <= frameEnd) ++last;
+
+  CHECK_EQ(last - first, vTotal, "%s: lines per frame", name);
+  CHECK(inWindow(us(frameEnd - frameStart), lineUs * vTotal, lineUs * vTotal * CLOCK_TOLERANCE),
+        "%s: frame %.1fus, %s %.1fus", name, us(frameEnd - frameStart), ref->standard, lineUs * vTotal);
+
+  // vsync, back porch, picture, front porch
+  enum { V_SYNC, V_BACK, V_ACTIVE, V_FRONT, V_REGIONS } region = V_SYNC;
+  uint32_t regionLines[V_REGIONS] = { 0 };
+  bool ordered = true;
+  double hSyncMin = 1e9, hSyncMax = 0, lineMin = 1e9, lineMax = 0, riseMin = 1e9, riseMax = 0, fallMin = 1e9, fallMax = 0;
+
+  uint32_t e = 0;
+  for (uint32_t l = first; l < last; ++l)
+  {
+    const uint64_t start = hsyncStarts[l], end = hsyncStarts[l + 1];
+    const bool vsync = ((pinsAt(start + (end - start) / 2) & VSYNC_PIN) != 0) == vHigh;
+
+    const double line = us(end - start);
+    if (line < lineMin) lineMin = line;
+    if (line > lineMax) lineMax = line;
+
+    // hsync width, pixel enable window
+    while (e + 1 < eventCount && events[e + 1].tick <= start) ++e;
+    double hSyncEnd = -1, rise = -1, fall = -1;
+    for (uint32_t i = e + 1; i < eventCount && events[i].tick < end; ++i)
+    {
+      const uint32_t was = events[i - 1].pins, is = events[i].pins;
+      const double at = us(events[i].tick - start);
+      if (hSyncEnd < 0 && ((is & HSYNC_PIN) != 0) != hHigh) hSyncEnd = at;
+      if (rise < 0 && (is & RGB_MASK) && !(was & RGB_MASK)) rise = at;
+      if (!(is & RGB_MASK) && (was & RGB_MASK)) fall = at;
+    }
+    if (hSyncEnd > 0)
+    {
+      if (hSyncEnd < hSyncMin) hSyncMin = hSyncEnd;
+      if (hSyncEnd > hSyncMax) hSyncMax = hSyncEnd;
+    }
+
+    const bool enabled = rise >= 0;
+    if (enabled)
+    {
+      if (rise < riseMin) riseMin = rise;
+      if (rise > riseMax) riseMax = rise;
+      if (fall < fallMin) fallMin = fall;
+      if (fall > fallMax) fallMax = fall;
+    }
+
+    // each region follows the last, none comes back
+    const int lineRegion = vsync ? V_SYNC : enabled ? V_ACTIVE : (region == V_SYNC || region == V_BACK) ? V_BACK : V_FRONT;
+    if (lineRegion < (int)region || (vsync && enabled)) ordered = false;
+    region = lineRegion;
+    ++regionLines[region];
+  }
+
+  CHECK(ordered, "%s: vsync, back porch, picture and front porch lines out of order", name);
+  CHECK_EQ(regionLines[V_SYNC], ref->vSync, "%s: vsync lines", name);
+  CHECK_EQ(regionLines[V_BACK], ref->vBack, "%s: vertical back porch lines", name);
+  CHECK_EQ(regionLines[V_ACTIVE], ref->vActive, "%s: picture lines", name);
+  CHECK_EQ(regionLines[V_FRONT], ref->vFront, "%s: vertical front porch lines", name);
+
+  const double lineTol = lineUs * CLOCK_TOLERANCE;
+  CHECK(inWindow(lineMin, lineUs, lineTol) && inWindow(lineMax, lineUs, lineTol),
+        "%s: line %.3f-%.3fus, %s %.3fus", name, lineMin, lineMax, ref->standard, lineUs);
+
+  const double edgeTol = EDGE_TOLERANCE * pixelUs;
+  const double hSyncUs = ref->hSync * pixelUs;
+  CHECK(inWindow(hSyncMin, hSyncUs, edgeTol + hSyncUs * CLOCK_TOLERANCE) && inWindow(hSyncMax, hSyncUs, edgeTol + hSyncUs * CLOCK_TOLERANCE),
+        "%s: hsync %.3f-%.3fus, %s %.3fus", name, hSyncMin, hSyncMax, ref->standard, hSyncUs);
+
+  // the picture sits inside the standard's active area, centred in it
+  const double activeStart = (ref->hSync + ref->hBack) * pixelUs;
+  const double activeEnd = activeStart + ref->hActive * pixelUs;
+  const double riseTol = lineUs * PICTURE_TOLERANCE, fallTol = riseTol;
+  CHECK(riseMax - riseMin <= edgeTol && fallMax - fallMin <= edgeTol, "%s: picture edges move %.3f/%.3fus", name, riseMax - riseMin, fallMax - fallMin);
+  CHECK(riseMin >= activeStart - riseTol && fallMax <= activeEnd + fallTol,
+        "%s: picture %.3f-%.3fus, %s active %.3f-%.3fus", name, riseMin, fallMax, ref->standard, activeStart, activeEnd);
+  CHECK(inWindow(riseMin - activeStart, activeEnd - fallMax, riseTol + fallTol),
+        "%s: picture off centre, margins %.3f/%.3fus", name, riseMin - activeStart, activeEnd - fallMax);
+
+  // the pixel clock, from the pixels in the picture
+  const double pixelMHz = vgaParams.params.hVirtualPixels * vgaParams.params.hPixelScale / (fallMax - riseMin);
+  CHECK(inWindow(pixelMHz, ref->pixelClockMHz, ref->pixelClockMHz * CLOCK_TOLERANCE),
+        "%s: pixel clock %.3fMHz, %s %.3fMHz", name, pixelMHz, ref->standard, ref->pixelClockMHz);
+
+  // one tms interrupt a frame, at the standard's frame rate
+  const double frameHz = ref->pixelClockMHz * 1e6 / (hTotal * vTotal);
+  CHECK(frameEndCount >= 3, "%s: %u ends of frame", name, frameEndCount);
+  for (uint32_t f = 1; f < frameEndCount; ++f)
+  {
+    const double hz = 1e6 / us(frameEndTicks[f] - frameEndTicks[f - 1]);
+    CHECK(inWindow(hz, frameHz, frameHz * CLOCK_TOLERANCE), "%s: end of frame %u at %.3fHz, %s %.3fHz", name, f, hz, ref->standard, frameHz);
+    CHECK_EQ(frameEndTicks[f] - frameEndTicks[f - 1], frameEnd - frameStart, "%s: end of frame %u not a frame after the last", name, f);
+  }
+
+  printf("%s: line %.3fus hsync %.3fus picture %.3f-%.3fus at %.3fMHz, %u/%u/%u/%u lines, %.3fHz\n", name, lineMin, hSyncMin,
+         riseMin, fallMax, pixelMHz, regionLines[V_ACTIVE], regionLines[V_FRONT], regionLines[V_SYNC], regionLines[V_BACK],
+         1e6 / us(frameEnd - frameStart));
+  reportBudgets(name);
+}
+
+/*
+ * scart: negative composite sync on the first sync pin
+ */
+typedef enum { PULSE_EQ, PULSE_HSYNC, PULSE_BROAD } PulseKind;
+
+static uint64_t pulseStarts[MAX_EDGES], pulseEnds[MAX_EDGES];
+static uint8_t pulseKinds[MAX_EDGES];
+static uint32_t pulseCount;
+static uint32_t fieldStartCount, fieldStartsNeeded;
+static uint64_t lastFall;
+static bool lastBroad;
+
+static bool scartFieldsDone(void)
+{
+  // a field starts with a broad pulse after any other
+  for (; eventsScanned < eventCount; ++eventsScanned)
+  {
+    const uint32_t e = eventsScanned;
+    if (!e || !((events[e].pins ^ events[e - 1].pins) & HSYNC_PIN)) continue;
+    if (!(events[e].pins & HSYNC_PIN))
+    {
+      lastFall = events[e].tick;
+    }
+    else if (lastFall)
+    {
+      const bool broad = us(events[e].tick - lastFall) > 10.0;
+      if (broad && !lastBroad) ++fieldStartCount;
+      lastBroad = broad;
+    }
+  }
+  return fieldStartCount >= fieldStartsNeeded || eventCount >= MAX_EVENTS;
+}
+
+static void checkScart(const ScartReference *ref, uint8_t preset, const char *vcdDir)
+{
+  char name[96];
+  snprintf(name, sizeof(name), "preset %u %s", preset, ref->name);
+
+  const DisplayPlan plan = displayPlan(ref->driver, 0, ref->scartMode, preset);
+  startMode(&plan);
+
+  // a partial frame, then two whole ones
+  fieldStartCount = 0;
+  fieldStartsNeeded = 2 + 2 * ref->fields;
+  lastFall = 0;
+  lastBroad = false;
+  runFor(scartFieldsDone, (uint64_t)(ref->lineUs * ref->fieldLines * ref->fields * 4 * ticksPerUs));
+
+  if (vcdDir) writeVcd(vcdDir, name, true);
+
+  CHECK(!activeHigh(HSYNC_PIN), "%s: csync polarity", name);
+  bool bothPins = true;
+  for (uint32_t e = 0; e < eventCount; ++e)
+    bothPins &= !(events[e].pins & HSYNC_PIN) == !(events[e].pins & VSYNC_PIN);
+  CHECK(bothPins, "%s: csync not on both sync pins", name);
+
+  // the pulses, and the fields they start
+  const uint32_t falls = edges(HSYNC_PIN, false, true, pulseStarts);
+  const uint32_t rises = edges(HSYNC_PIN, false, false, pulseEnds);
+  pulseCount = 0;
+  uint32_t r = 0;
+  uint32_t fieldStarts[16], fieldCount = 0;
+  for (uint32_t f = 0; f < falls; ++f)
+  {
+    while (r < rises && pulseEnds[r] <= pulseStarts[f]) ++r;
+    if (r >= rises) break;
+    const double width = us(pulseEnds[r] - pulseStarts[f]);
+    pulseStarts[pulseCount] = pulseStarts[f];
+    pulseEnds[pulseCount] = pulseEnds[r];
+    pulseKinds[pulseCount] = width < 3.5 ? PULSE_EQ : width < 10.0 ? PULSE_HSYNC : PULSE_BROAD;
+    if (pulseKinds[pulseCount] == PULSE_BROAD && pulseCount && pulseKinds[pulseCount - 1] != PULSE_BROAD && fieldCount < 16)
+      fieldStarts[fieldCount++] = pulseCount;
+    ++pulseCount;
+  }
+
+  CHECK(fieldCount >= 1u + 2 * ref->fields, "%s: %u fields", name, fieldCount);
+  if (fieldCount < 1u + 2 * ref->fields) return;
+
+  // the line period, from the hsync pulses a line apart
+  double lineUs = 0;
+  for (uint32_t p = 1; p < pulseCount && lineUs == 0; ++p)
+  {
+    const double gap = us(pulseStarts[p] - pulseStarts[p - 1]);
+    if (pulseKinds[p] == PULSE_HSYNC && pulseKinds[p - 1] == PULSE_HSYNC && gap > ref->lineUs * 0.75)
+      lineUs = gap;
+  }
+  CHECK(inWindow(lineUs, ref->lineUs, ref->lineUs * CLOCK_TOLERANCE), "%s: line %.3fus, %s %.3fus", name, lineUs, ref->standard, ref->lineUs);
+  if (lineUs == 0) return;
+
+  // the last whole frame
+  double hSyncMin = 1e9, hSyncMax = 0, eqMin = 1e9, eqMax = 0, serrMin = 1e9, serrMax = 0;
+  double blankMin = 1e9, porchMin = 1e9;
+  for (uint32_t f = fieldCount - 1 - ref->fields; f < fieldCount - 1; ++f)
+  {
+    const uint32_t startPulse = fieldStarts[f], endPulse = fieldStarts[f + 1];
+    const uint64_t fieldStart = pulseStarts[startPulse], fieldEnd = pulseStarts[endPulse];
+
+    const double lines = us(fieldEnd - fieldStart) / lineUs;
+    CHECK(inWindow(lines, ref->fieldLines, 0.1), "%s: field %u is %.2f lines, %s %.1f", name, f, lines, ref->standard, ref->fieldLines);
+
+    uint32_t broad = 0;
+    while (startPulse + broad < endPulse && pulseKinds[startPulse + broad] == PULSE_BROAD) ++broad;
+    CHECK_EQ(broad, ref->broadPulses, "%s: broad pulses in field %u", name, f);
+
+    for (uint32_t p = startPulse; p < endPulse; ++p)
+    {
+      const double width = us(pulseEnds[p] - pulseStarts[p]);
+      if (pulseKinds[p] == PULSE_EQ)
+      {
+        if (width < eqMin) eqMin = width;
+        if (width > eqMax) eqMax = width;
+      }
+      else if (pulseKinds[p] == PULSE_HSYNC)
+      {
+        if (width < hSyncMin) hSyncMin = width;
+        if (width > hSyncMax) hSyncMax = width;
+      }
+      else if (p + 1 < endPulse && pulseKinds[p + 1] == PULSE_BROAD)
+      {
+        const double serration = us(pulseStarts[p + 1] - pulseEnds[p]);
+        if (serration < serrMin) serrMin = serration;
+        if (serration > serrMax) serrMax = serration;
+      }
+    }
+
+    // the picture: inside each line's active part, clear of the field blanking
+    uint32_t e = 0, p = startPulse;
+    while (e < eventCount && events[e].tick < fieldStart) ++e;
+    uint64_t firstRise = 0, lastFall = 0;
+    for (; e < eventCount && events[e].tick < fieldEnd; ++e)
+    {
+      if (!e) continue;
+      const uint32_t was = events[e - 1].pins, is = events[e].pins;
+      const uint64_t at = events[e].tick;
+      while (p + 1 < endPulse && pulseStarts[p + 1] <= at) ++p;
+      if ((is & RGB_MASK) && !(was & RGB_MASK))
+      {
+        if (!firstRise) firstRise = at;
+        const double blank = us(at - pulseStarts[p]);
+        if (blank < blankMin) blankMin = blank;
+      }
+      if (!(is & RGB_MASK) && (was & RGB_MASK))
+      {
+        lastFall = at;
+        const double porch = us(pulseStarts[p + 1] - at);
+        if (porch < porchMin) porchMin = porch;
+      }
+    }
+    CHECK(firstRise && lastFall, "%s: no picture in field %u", name, f);
+    if (!firstRise || !lastFall) continue;
+    const double top = us(firstRise - fieldStart) / lineUs, bottom = us(fieldEnd - lastFall) / lineUs;
+    CHECK(top >= ref->topBlankLines, "%s: picture %.1f lines into field %u, %s blanks %.1f", name, top, f, ref->standard, ref->topBlankLines);
+    CHECK(bottom >= ref->bottomBlankLines, "%s: picture %.1f lines before the end of field %u, %s blanks %.1f", name, bottom, f, ref->standard, ref->bottomBlankLines);
+  }
+
+  CHECK(hSyncMin >= ref->hSyncUs - ref->hSyncTolUs && hSyncMax <= ref->hSyncUs + ref->hSyncTolUs,
+        "%s: hsync %.3f-%.3fus, %s %.2f+-%.2fus", name, hSyncMin, hSyncMax, ref->standard, ref->hSyncUs, ref->hSyncTolUs);
+  CHECK(eqMin >= ref->eqUs - ref->eqTolUs && eqMax <= ref->eqUs + ref->eqTolUs,
+        "%s: equalising pulse %.3f-%.3fus, %s %.2f+-%.2fus", name, eqMin, eqMax, ref->standard, ref->eqUs, ref->eqTolUs);
+  CHECK(serrMin >= ref->serrationUs - ref->serrationTolUs && serrMax <= ref->serrationUs + ref->serrationTolUs,
+        "%s: serration %.3f-%.3fus, %s %.2f+-%.2fus", name, serrMin, serrMax, ref->standard, ref->serrationUs, ref->serrationTolUs);
+  CHECK(blankMin >= ref->blankStartUs, "%s: picture %.3fus after sync, %s %.2fus", name, blankMin, ref->standard, ref->blankStartUs);
+  CHECK(porchMin >= ref->frontPorchUs, "%s: picture ends %.3fus before sync, %s %.2fus", name, porchMin, ref->standard, ref->frontPorchUs);
+
+  printf("%s: line %.3fus hsync %.3fus eq %.3fus serration %.3fus picture from %.3fus to %.3fus before sync\n",
+         name, lineUs, hSyncMin, eqMin, serrMin, blankMin, porchMin);
+  reportBudgets(name);
+}
+
+int main(int argc, char **argv)
+{
+  const char *vcdDir = argc > 1 ? argv[1] : NULL;
+
+  for (uint8_t preset = 0; preset < DISPLAY_CLOCK_PRESETS; ++preset)
+  {
+    for (uint32_t m = 0; m < VGA_REFS; ++m)
+      checkVga(&vgaRefs[m], preset, vcdDir);
+    for (uint32_t m = 0; m < SCART_REFS; ++m)
+      checkScart(&scartRefs[m], preset, vcdDir);
+  }
+
+  return checkResult("synctiming");
+}
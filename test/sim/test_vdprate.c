@@ -0,0 +1,152 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * the vdp at its own frame rate (CONF_VDP_RATE, the frame buffers in
+ * main.c) on the hardware model: a 50 Hz vdp on a 60 Hz display, and a
+ * 60 Hz vdp on a 50 Hz display
+ *
+ * the vdp fills each frame in its own colour (scan_hw.c: the frame count),
+ * so a display frame's lines tell which vdp frame it scanned out. over a
+ * second the host sees the vdp's rate of interrupts, evenly spaced. each
+ * display frame shows one whole vdp frame (none torn). a 50 Hz vdp repeats
+ * every sixth frame on a 60 Hz display, a 60 Hz vdp drops every sixth on a
+ * 50 Hz display: a repeat or drop is never followed by another
+ */
+
+#include "check.h"
+
+#include "vga.c"
+
+#define main pico9918Main
+#include "main.c"
+#undef main
+
+#include "scan.h"
+
+#define MAX_FRAMES    128
+#define COLOURS       15          // scan_hw.c's frame colours
+
+typedef struct
+{
+  const char *name;
+  uint8_t vgaMode;                // CONF_VGA_MODE
+  uint8_t vdpRate;                // CONF_VDP_RATE
+  uint32_t displayHz;
+  uint32_t vdpHz;
+} RateCase;
+
+static const RateCase cases[] = {
+  { "50 Hz vdp on 640x480@60", 0, 1, 60, 50 },
+  { "60 Hz vdp on 720x576@50", 4, 2, 50, 60 },
+};
+
+// the vdp frame (colour) each display frame scanned out
+static uint8_t frameIds[MAX_FRAMES];
+static uint32_t displayFrames;
+static uint32_t tornFrames;
+static bool torn;
+
+static void recordingScanline(uint16_t y, VgaParams *params, uint16_t *pixels)
+{
+  tmsScanline(y, params, pixels);
+
+  y &= 0x0fff;
+  if (y < vBorder || y >= vBorder + vPixels)
+    return;
+
+  const uint8_t *line = frameBufferLine(fbScanout, y - vBorder);
+  const uint8_t id = line[0];
+  if (line[TMS9918_PIXELS_X - 1] != id)
+    torn = true;
+
+  if (y == vBorder)
+  {
+    torn = false;
+    if (displayFrames < MAX_FRAMES)
+      frameIds[displayFrames] = id;
+    ++displayFrames;
+  }
+  else if (displayFrames && id != frameIds[(displayFrames - 1) % MAX_FRAMES])
+  {
+    torn = true;
+  }
+
+  if (y == vBorder + vPixels - 1 && torn)
+    ++tornFrames;
+}
+
+static void runCase(const RateCase *c)
+{
+  scanBoot(c->vgaMode, c->vdpRate);
+  vgaParams.scanlineFn = recordingScanline;
+
+  CHECK_EQ(emuFrameUs, 1000000 / c->vdpHz, "%s: emulated frame period", c->name);
+  CHECK_EQ((uint32_t)(vgaParams.params.frameRateHz + 0.5f), c->displayHz, "%s: display rate", c->name);
+
+  // a whole display frame first. the frame count stays: it's the colour
+  scanRunFrames(2);
+  displayFrames = tornFrames = 0;
+  torn = false;
+  scanStats.ints = 0;
+  const uint32_t frames = scanStats.frames;
+
+  scanRun(1000000);
+
+  // the host's interrupts: the vdp's rate, a frame period apart
+  const uint32_t ints = scanStats.ints;
+  const uint32_t vdpFrames = scanStats.frames - frames;
+  CHECK(ints >= c->vdpHz - 1 && ints <= c->vdpHz + 1, "%s: %u interrupts in a second", c->name, ints);
+  CHECK(vdpFrames >= c->vdpHz - 1 && vdpFrames <= c->vdpHz + 1, "%s: %u vdp frames in a second", c->name, vdpFrames);
+
+  const uint32_t lineUs = emuFrameUs / emuTotalLines + 1;
+  uint32_t badGaps = 0;
+  for (uint32_t i = 1; i < ints && i < SCAN_MAX_INTS; ++i)
+  {
+    const uint64_t gap = scanStats.intUs[i] - scanStats.intUs[i - 1];
+    badGaps += gap + lineUs < emuFrameUs || gap > emuFrameUs + lineUs;
+  }
+  CHECK_EQ(badGaps, 0, "%s: interrupts not a frame period apart", c->name);
+
+  // the display frames: whole vdp frames, repeated or dropped evenly
+  CHECK(displayFrames >= c->displayHz - 1 && displayFrames <= c->displayHz + 1,
+        "%s: %u display frames in a second", c->name, displayFrames);
+  CHECK_EQ(tornFrames, 0, "%s: torn frames", c->name);
+
+  // a display frame shows the next vdp frame, or the same one again (repeat) or the one after next (drop)
+  const uint32_t skipStep = c->vdpHz > c->displayHz ? 2 : 0;
+  uint32_t skips = 0, badSteps = 0, runs = 0;
+  bool lastSkip = false;
+  for (uint32_t f = 1; f < displayFrames && f < MAX_FRAMES; ++f)
+  {
+    const uint32_t step = (frameIds[f] - frameIds[f - 1] + COLOURS) % COLOURS;
+    const bool skip = step == skipStep;
+    if (step != 1 && !skip)
+      ++badSteps;
+    skips += skip;
+    runs += skip && lastSkip;
+    lastSkip = skip;
+  }
+
+  const uint32_t expectSkips = c->vdpHz > c->displayHz ? c->vdpHz - c->displayHz : c->displayHz - c->vdpHz;
+  const char *skipName = c->vdpHz > c->displayHz ? "dropped" : "repeated";
+  CHECK_EQ(badSteps, 0, "%s: display frames not a vdp frame on, or a %s one", c->name, skipName);
+  CHECK(skips + 1 >= expectSkips && skips <= expectSkips + 1, "%s: %u frames %s in a second", c->name, skips, skipName);
+  CHECK_EQ(runs, 0, "%s: frames %s twice in a row", c->name, skipName);
+}
+
+int main(void)
+{
+  for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    runCase(&cases[i]);
+
+  return checkResult("vdprate");
+}
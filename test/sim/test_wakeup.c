@@ -0,0 +1,295 @@
+/*
+ * Project: pico9918
+ *
+ * Copyright (c) 2024 Troy Schrapel
+ *
+ * This code is licensed under the MIT license
+ *
+ * https://github.com/visrealm/pico9918
+ *
+ */
+
+/*
+ * gpuLoop()'s WFE sleep against core 1's requests: no wakeup may be lost
+ *
+ * core 1 asks the gpu for something by storing a flag and signalling an
+ * event: gpuTrigger() and a register write in tmsWriteIrqHandler() (the
+ * flash and config commands). the order they store, fence and signal in is
+ * recorded by running them on the boot stubs (boot_hw.c)
+ *
+ * each order is then run against gpuLoop()'s idle pass (read each request
+ * flag in turn, then WFE) in every interleaving. core 1's stores go through
+ * a store buffer that drains at any time, or by a DMB (the M33 may let a
+ * SEV overtake a buffered store; the M0+ never does, which this covers). no
+ * interleaving may leave core 0 asleep, with no event, and a flag it hasn't
+ * seen: it could sleep until an unrelated interrupt. and once the event is
+ * signalled core 0 must see the flag within two passes. the same orders
+ * without their DMB must lose a wakeup, or the model isn't seeing anything
+ */
+
+#include "check.h"
+#include "boot_hw.h"
+
+#include "gpio.h"
+#include "gpu.h"
+
+#include "hardware/pio.h"
+
+#include <string.h>
+
+#define LOOP_FLAGS    6           // request flags gpuLoop() reads per pass
+#define MAX_OPS       8
+#define MAX_STATES    (1 << 16)
+
+typedef enum { OP_STORE, OP_DMB, OP_SEV } Op;
+
+typedef struct
+{
+  const char *name;
+  Op ops[MAX_OPS];
+  int count;
+} Core1Path;
+
+/* the model's state */
+typedef struct
+{
+  uint8_t core1;            // next core 1 op
+  uint8_t buffered;         // the flag store in core 1's store buffer
+  uint8_t flag;             // the flag as core 0 sees it
+  uint8_t event;            // core 0's event register
+  uint8_t core0;            // the load core 0 is at, LOOP_FLAGS: its WFE
+  uint8_t asleep;
+  uint8_t seen;             // core 0 has read the flag set
+  uint8_t sinceSev;         // core 0 steps since the event, with the flag not seen
+} State;
+
+typedef struct
+{
+  const Core1Path *path;
+  int flagAt;               // which of the loop's loads reads this flag
+  uint8_t visited[MAX_STATES];
+  int lost;
+  int maxSteps;
+} Search;
+
+int pico9918Main(void);
+extern const uint tmsWriteSm;
+void tmsWriteIrqHandler(void);
+
+/*
+ * core 1's ops from the events the stubs recorded. the flag store is
+ * where the register write went in, or ahead of the first barrier or
+ * event that sees the trigger flag set
+ */
+static Core1Path recordedPath(const char *name)
+{
+  Core1Path path = { name, { 0 }, 0 };
+  bool stored = false;
+  uint32_t count;
+  const BootEvent *e = bootEvents(&count);
+  for (uint32_t i = 0; i < count && path.count < MAX_OPS - 1; ++i)
+  {
+    switch (e[i].type)
+    {
+      case BOOT_EVENT_TMS_ADDR:
+        path.ops[path.count++] = OP_STORE;
+        stored = true;
+        break;
+
+      case BOOT_EVENT_DMB:
+      case BOOT_EVENT_SEV:
+        if (!stored && e[i].a)
+        {
+          path.ops[path.count++] = OP_STORE;
+          stored = true;
+        }
+        path.ops[path.count++] = e[i].type == BOOT_EVENT_DMB ? OP_DMB : OP_SEV;
+        break;
+
+      default:
+        break;
+    }
+  }
+  CHECK(stored, "%s: no flag stored", name);
+  return path;
+}
+
+static Core1Path withoutDmb(const Core1Path *path, const char *name)
+{
+  Core1Path stripped = { name, { 0 }, 0 };
+  for (int i = 0; i < path->count; ++i)
+    if (path->ops[i] != OP_DMB)
+      stripped.ops[stripped.count++] = path->ops[i];
+  return stripped;
+}
+
+static bool hasOp(const Core1Path *path, Op op, int from)
+{
+  for (int i = from; i < path->count; ++i)
+    if (path->ops[i] == op)
+      return true;
+  return false;
+}
+
+static uint32_t stateKey(const State *s)
+{
+  return (uint32_t)s->core1 | (uint32_t)s->buffered << 3 | (uint32_t)s->flag << 4 | (uint32_t)s->event << 5 |
+         (uint32_t)s->core0 << 6 | (uint32_t)s->asleep << 9 | (uint32_t)s->seen << 10 |
+         (uint32_t)(s->sinceSev > 31 ? 31 : s->sinceSev) << 11;
+}
+
+static void explore(Search *search, State s);
+
+static void core0Step(Search *search, State s)
+{
+  if (s.asleep)
+  {
+    if (!s.event)
+      return;
+    s.asleep = 0;
+    s.event = 0;
+    s.core0 = 0;
+  }
+  else if (s.core0 < LOOP_FLAGS)
+  {
+    if (s.core0 == search->flagAt && s.flag)
+    {
+      s.seen = 1;
+      s.flag = 0;           // the gpu takes the request
+    }
+    ++s.core0;
+  }
+  else if (s.event)         // WFE with the event set: straight on
+  {
+    s.event = 0;
+    s.core0 = 0;
+  }
+  else
+  {
+    s.asleep = 1;
+  }
+
+  if (!s.seen && s.sinceSev)
+    ++s.sinceSev;
+  explore(search, s);
+}
+
+static void core1Step(Search *search, State s)
+{
+  if (s.core1 >= search->path->count)
+    return;
+  switch (search->path->ops[s.core1])
+  {
+    case OP_STORE:
+      s.buffered = 1;
+      break;
+
+    case OP_DMB:            // waits for the store buffer
+      if (s.buffered)
+        return;
+      break;
+
+    case OP_SEV:
+      s.event = 1;
+      if (!s.seen && !s.sinceSev)
+        s.sinceSev = 1;
+      break;
+  }
+  ++s.core1;
+  explore(search, s);
+}
+
+static void drainStep(Search *search, State s)
+{
+  if (!s.buffered)
+    return;
+  s.buffered = 0;
+  s.flag = 1;
+  explore(search, s);
+}
+
+static void explore(Search *search, State s)
+{
+  const uint32_t key = stateKey(&s);
+  if (search->visited[key])
+    return;
+  search->visited[key] = 1;
+
+  if (s.seen && s.sinceSev > search->maxSteps)
+    search->maxSteps = s.sinceSev;
+
+  // quiescent: core 1 done and drained, core 0 asleep with no event
+  if (s.core1 == search->path->count && !s.buffered && s.asleep && !s.event && !s.seen)
+    ++search->lost;
+
+  core0Step(search, s);
+  core1Step(search, s);
+  drainStep(search, s);
+}
+
+/*
+ * every interleaving of a path with gpuLoop()'s pass, from every point in
+ * the pass (or asleep, with or without a stale event). the number of lost
+ * wakeups found
+ */
+static int checkPath(const Core1Path *path, bool expectLost)
+{
+  static Search search;
+  int lost = 0;
+  for (int flagAt = 0; flagAt < LOOP_FLAGS; ++flagAt)
+  {
+    memset(&search, 0, sizeof(search));
+    search.path = path;
+    search.flagAt = flagAt;
+    for (int core0 = 0; core0 <= LOOP_FLAGS + 1; ++core0)
+    {
+      for (int event = 0; event < 2; ++event)
+      {
+        State s = { 0 };
+        s.core0 = core0 <= LOOP_FLAGS ? core0 : LOOP_FLAGS;
+        s.asleep = core0 > LOOP_FLAGS;
+        s.event = event;
+        explore(&search, s);
+      }
+    }
+    lost += search.lost;
+
+    // after the event: the rest of this pass, the WFE, and the next pass
+    if (!expectLost)
+      CHECK(search.maxSteps <= 2 * (LOOP_FLAGS + 1), "%s: flag %d seen %d core 0 steps after the event", path->name,
+            flagAt, search.maxSteps);
+  }
+  return lost;
+}
+
+int main(void)
+{
+  // gpuTrigger()
+  bootHwReset(false);
+  gpuTrigger();
+  const Core1Path trigger = recordedPath("gpuTrigger");
+
+  // a register write through tmsWriteIrqHandler()
+  bootHwReset(false);
+  pio1_hw->rxf[tmsWriteSm] = 0x38 | (1u << ((GPIO_MODE - GPIO_CD7) + 16));
+  tmsWriteIrqHandler();
+  const Core1Path regWrite = recordedPath("tmsWriteIrqHandler");
+
+  const Core1Path *paths[] = { &trigger, &regWrite };
+  for (int i = 0; i < 2; ++i)
+  {
+    const Core1Path *path = paths[i];
+    CHECK(hasOp(path, OP_SEV, 0), "%s: no event signalled", path->name);
+    CHECK(path->ops[0] == OP_STORE && hasOp(path, OP_DMB, 1), "%s: no barrier after the flag store", path->name);
+
+    const int lost = checkPath(path, false);
+    CHECK_EQ(lost, 0, "%s: lost wakeups", path->name);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s without its dmb", path->name);
+    const Core1Path stripped = withoutDmb(path, name);
+    CHECK(checkPath(&stripped, true) > 0, "%s: no lost wakeup found", stripped.name);
+  }
+
+  return checkResult("wakeup");
+}
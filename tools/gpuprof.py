@@ -0,0 +1,159 @@
+# gpuprof.py
+#
+# Report on a PICO9918 GPU (TMS9900) profile dump
+#
+# This code is licensed under the MIT license
+#
+# https://github.com/visrealm/pico9918
+#
+#
+
+import re
+import sys
+import struct
+import argparse
+
+BUCKET_SHIFT = 3                        # must match GPU_PROFILE_BUCKET_SHIFT in gpu.c
+BUCKETS = 0x10000 >> BUCKET_SHIFT
+HIST_BYTES = BUCKETS * 2                # pages 0-15: 16-bit PC histogram
+OPCODES = 2048                          # pages 16-23: 32-bit counters, instruction >> 5
+OPCODE_BYTES = OPCODES * 4
+
+# (first opcode, mask, mnemonic) - TMS9900 plus the F18A GPU additions
+OPCODE_NAMES = [
+    (0x0200, 0xFFE0, 'LI'),   (0x0220, 0xFFE0, 'AI'),   (0x0240, 0xFFE0, 'ANDI'),
+    (0x0260, 0xFFE0, 'ORI'),  (0x0280, 0xFFE0, 'CI'),   (0x02A0, 0xFFE0, 'STWP'),
+    (0x02C0, 0xFFE0, 'STST'), (0x02E0, 0xFFE0, 'LWPI'), (0x0300, 0xFFE0, 'LIMI'),
+    (0x0340, 0xFFE0, 'IDLE'), (0x0380, 0xFFE0, 'RTWP'),
+    (0x0400, 0xFFC0, 'BLWP'), (0x0440, 0xFFC0, 'B'),    (0x0480, 0xFFC0, 'X'),
+    (0x04C0, 0xFFC0, 'CLR'),  (0x0500, 0xFFC0, 'NEG'),  (0x0540, 0xFFC0, 'INV'),
+    (0x0580, 0xFFC0, 'INC'),  (0x05C0, 0xFFC0, 'INCT'), (0x0600, 0xFFC0, 'DEC'),
+    (0x0640, 0xFFC0, 'DECT'), (0x0680, 0xFFC0, 'BL'),   (0x06C0, 0xFFC0, 'SWPB'),
+    (0x0700, 0xFFC0, 'SETO'), (0x0740, 0xFFC0, 'ABS'),
+    (0x0800, 0xFF00, 'SRA'),  (0x0900, 0xFF00, 'SRL'),  (0x0A00, 0xFF00, 'SLA'),
+    (0x0B00, 0xFF00, 'SRC'),
+    (0x0C00, 0xFFE0, 'RET'),  (0x0C80, 0xFFC0, 'CALL'), (0x0D00, 0xFFC0, 'PUSH'),
+    (0x0E00, 0xFFC0, 'SLC'),  (0x0F00, 0xFFC0, 'POP'),
+    (0x1000, 0xFF00, 'JMP'),  (0x1100, 0xFF00, 'JLT'),  (0x1200, 0xFF00, 'JLE'),
+    (0x1300, 0xFF00, 'JEQ'),  (0x1400, 0xFF00, 'JHE'),  (0x1500, 0xFF00, 'JGT'),
+    (0x1600, 0xFF00, 'JNE'),  (0x1700, 0xFF00, 'JNC'),  (0x1800, 0xFF00, 'JOC'),
+    (0x1900, 0xFF00, 'JNO'),  (0x1A00, 0xFF00, 'JL'),   (0x1B00, 0xFF00, 'JH'),
+    (0x1C00, 0xFF00, 'JOP'),  (0x1D00, 0xFF00, 'SBO'),  (0x1E00, 0xFF00, 'SBZ'),
+    (0x1F00, 0xFF00, 'TB'),
+    (0x2000, 0xFC00, 'COC'),  (0x2400, 0xFC00, 'CZC'),  (0x2800, 0xFC00, 'XOR'),
+    (0x2C00, 0xFC00, 'PIX'),  (0x3000, 0xFC00, 'LDCR'), (0x3400, 0xFC00, 'STCR'),
+    (0x3800, 0xFC00, 'MPY'),  (0x3C00, 0xFC00, 'DIV'),
+    (0x4000, 0xF000, 'SZC'),  (0x5000, 0xF000, 'SZCB'), (0x6000, 0xF000, 'S'),
+    (0x7000, 0xF000, 'SB'),   (0x8000, 0xF000, 'C'),    (0x9000, 0xF000, 'CB'),
+    (0xA000, 0xF000, 'A'),    (0xB000, 0xF000, 'AB'),   (0xC000, 0xF000, 'MOV'),
+    (0xD000, 0xF000, 'MOVB'), (0xE000, 0xF000, 'SOC'),  (0xF000, 0xF000, 'SOCB'),
+]
+
+SYMBOL_ADDR = re.compile(r'(?:>|\$|0[xX])([0-9A-Fa-f]{1,4})\b|^\s*([0-9A-Fa-f]{4})\b')
+SYMBOL_NAME = re.compile(r'[A-Za-z_][A-Za-z0-9_.]*')
+
+
+def opcodeName(instruction):
+    """
+    mnemonic for an instruction word
+    """
+    for first, mask, name in OPCODE_NAMES:
+        if instruction & mask == first:
+            return name
+    return 'DATA'
+
+
+def loadSymbols(fileName):
+    """
+    load 'NAME EQU >4000', 'NAME >4000' or '4000 NAME' style lines
+    """
+    symbols = []
+    with open(fileName, 'r') as symFile:
+        for line in symFile:
+            addrMatch = SYMBOL_ADDR.search(line)
+            if not addrMatch:
+                continue
+            rest = line[:addrMatch.start()] + ' ' + line[addrMatch.end():]
+            names = [n for n in SYMBOL_NAME.findall(rest) if n.upper() not in ('EQU', 'DEF', 'REF')]
+            if names:
+                symbols.append((int(addrMatch.group(1) or addrMatch.group(2), 16), names[0]))
+    symbols.sort()
+    return symbols
+
+
+def symbolize(symbols, addr):
+    """
+    nearest symbol at or below addr
+    """
+    best = None
+    for symAddr, name in symbols:
+        if symAddr > addr:
+            break
+        best = (symAddr, name)
+    if best is None:
+        return ''
+    return best[1] if best[0] == addr else '%s+%d' % (best[1], addr - best[0])
+
+
+def main() -> int:
+    """
+    main program entry-point
+    """
+    parser = argparse.ArgumentParser(
+        description='Report on a PICO9918 GPU profile dump (PICO9918_GPU_PROFILE builds).',
+        epilog="GitHub: https://github.com/visrealm/pico9918")
+    parser.add_argument('dump', nargs='+',
+                        help='dump page file(s) in page order, or one file of all pages')
+    parser.add_argument('-s', '--symbols', help='symbol file for the GPU program')
+    parser.add_argument('-n', '--top', type=int, default=32,
+                        help='number of address ranges to list (0 for all)')
+    args = parser.parse_args()
+
+    data = b''
+    for fileName in args.dump:
+        with open(fileName, 'rb') as dumpFile:
+            data += dumpFile.read()
+
+    if len(data) < HIST_BYTES:
+        print('dump is %d bytes, expected at least %d' % (len(data), HIST_BYTES), file=sys.stderr)
+        return 1
+
+    hist = struct.unpack('>%dH' % BUCKETS, data[:HIST_BYTES])
+    symbols = loadSymbols(args.symbols) if args.symbols else []
+
+    total = sum(hist)
+    print('%d samples' % total)
+    if total:
+        ranked = sorted(((count, i) for i, count in enumerate(hist) if count), reverse=True)
+        if args.top:
+            ranked = ranked[:args.top]
+
+        print()
+        print('ADDRESS     SAMPLES      %  SYMBOL')
+        for count, i in ranked:
+            addr = i << BUCKET_SHIFT
+            print('>%04X-%04X %9d %6.2f  %s' % (addr, addr + (1 << BUCKET_SHIFT) - 1,
+                  count, count * 100.0 / total, symbolize(symbols, addr)))
+
+    if len(data) >= HIST_BYTES + OPCODE_BYTES:
+        counts = struct.unpack('>%dI' % OPCODES, data[HIST_BYTES:HIST_BYTES + OPCODE_BYTES])
+        byName = {}
+        for i, count in enumerate(counts):
+            if count:
+                name = opcodeName(i << 5)
+                byName[name] = byName.get(name, 0) + count
+
+        executed = sum(byName.values())
+        print()
+        print('%d instructions' % executed)
+        if executed:
+            print()
+            print('OPCODE        COUNT      %')
+            for name, count in sorted(byName.items(), key=lambda item: item[1], reverse=True):
+                print('%-6s %12d %6.2f' % (name, count, count * 100.0 / executed))
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())